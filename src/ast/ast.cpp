@@ -19,6 +19,13 @@ std::string Program::tokenLiteral() {
     return "";
 }
 
+Position Program::position() {
+    if (!this->statements.empty()) {
+        return this->statements[0]->position();
+    }
+    return {};
+}
+
 std::string Program::string() {
     std::ostringstream oss;
     for (const auto &s: this->statements) {
@@ -31,6 +38,10 @@ std::string Identifier::tokenLiteral() {
     return this->token.literal;
 }
 
+Position Identifier::position() {
+    return this->token.position;
+}
+
 std::string Identifier::string() {
     return this->value;
 }
@@ -39,6 +50,10 @@ std::string LetStatement::tokenLiteral() {
     return this->token.literal;
 }
 
+Position LetStatement::position() {
+    return this->token.position;
+}
+
 std::string LetStatement::string() {
     std::stringstream oss;
     oss << this->tokenLiteral() << " ";
@@ -55,6 +70,10 @@ std::string ReturnStatement::tokenLiteral() {
     return this->token.literal;
 }
 
+Position ReturnStatement::position() {
+    return this->token.position;
+}
+
 std::string ReturnStatement::string() {
     std::ostringstream oss;
     oss << this->tokenLiteral() << " ";
@@ -69,6 +88,10 @@ std::string ExpressionStatement::tokenLiteral() {
     return this->token.literal;
 }
 
+Position ExpressionStatement::position() {
+    return this->token.position;
+}
+
 std::string ExpressionStatement::string() {
     if (this->expression) {
         return this->expression->string();
@@ -80,6 +103,10 @@ std::string BlockStatement::tokenLiteral() {
     return this->token.literal;
 }
 
+Position BlockStatement::position() {
+    return this->token.position;
+}
+
 std::string BlockStatement::string() {
     std::string out;
     for (const auto &s: this->statements) {
@@ -92,6 +119,10 @@ std::string Boolean::tokenLiteral() {
     return this->token.literal;
 }
 
+Position Boolean::position() {
+    return this->token.position;
+}
+
 std::string Boolean::string() {
     return this->token.literal;
 }
@@ -100,6 +131,10 @@ std::string IntegerLiteral::tokenLiteral() {
     return this->token.literal;
 }
 
+Position IntegerLiteral::position() {
+    return this->token.position;
+}
+
 std::string IntegerLiteral::string() {
     return this->token.literal;
 }
@@ -108,6 +143,10 @@ std::string PrefixExpression::tokenLiteral() {
     return this->token.literal;
 }
 
+Position PrefixExpression::position() {
+    return this->token.position;
+}
+
 std::string PrefixExpression::string() {
     std::ostringstream oss;
     oss << "(";
@@ -123,6 +162,10 @@ std::string InfixExpression::tokenLiteral() {
     return this->token.literal;
 }
 
+Position InfixExpression::position() {
+    return this->token.position;
+}
+
 std::string InfixExpression::string() {
     std::ostringstream oss;
     oss << "(";
@@ -141,6 +184,10 @@ std::string IfExpression::tokenLiteral() {
     return this->token.literal;
 }
 
+Position IfExpression::position() {
+    return this->token.position;
+}
+
 std::string IfExpression::string() {
     std::ostringstream oss;
     oss << "if";
@@ -162,6 +209,10 @@ std::string FunctionLiteral::tokenLiteral() {
     return this->token.literal;
 }
 
+Position FunctionLiteral::position() {
+    return this->token.position;
+}
+
 std::string FunctionLiteral::string() {
     std::ostringstream oss;
     std::vector<std::string> params;
@@ -192,6 +243,10 @@ std::string CallExpression::tokenLiteral() {
     return this->token.literal;
 }
 
+Position CallExpression::position() {
+    return this->token.position;
+}
+
 std::string CallExpression::string() {
     std::ostringstream oss;
     std::vector<std::string> args;
@@ -223,6 +278,10 @@ std::string StringLiteral::tokenLiteral() {
     return this->token.literal;
 }
 
+Position StringLiteral::position() {
+    return this->token.position;
+}
+
 std::string StringLiteral::string() {
     return this->token.literal;
 }
@@ -231,6 +290,10 @@ std::string ArrayLiteral::tokenLiteral() {
     return this->token.literal;
 }
 
+Position ArrayLiteral::position() {
+    return this->token.position;
+}
+
 std::string ArrayLiteral::string() {
     std::ostringstream oss;
     std::vector<std::string> elements;
@@ -257,6 +320,10 @@ std::string IndexExpression::tokenLiteral() {
     return this->token.literal;
 }
 
+Position IndexExpression::position() {
+    return this->token.position;
+}
+
 std::string IndexExpression::string() {
     std::ostringstream oss;
     oss << "(";
@@ -275,6 +342,10 @@ std::string HashLiteral::tokenLiteral() {
     return this->token.literal;
 }
 
+Position HashLiteral::position() {
+    return this->token.position;
+}
+
 std::string HashLiteral::string() {
     std::ostringstream oss;
     std::vector<std::string> pairs;
@@ -39,6 +39,9 @@ namespace Ast {
 
         virtual std::string tokenLiteral() = 0;
 
+        // where the node starts in the source
+        virtual Position position() = 0;
+
         virtual std::string string() =0;
 
         virtual TypeID typeID() = 0;
@@ -84,6 +87,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -103,6 +108,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -124,6 +131,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -143,6 +152,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -162,6 +173,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -188,6 +201,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -207,6 +222,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -226,6 +243,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -245,6 +264,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -266,6 +287,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -292,6 +315,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -301,7 +326,10 @@ namespace Ast {
     public:
         Token token;
         std::vector<Identifier> parameters;
-        std::unique_ptr<BlockStatement> body;
+        // shared with the functions the evaluator makes from the literal, which may outlive the AST
+        std::shared_ptr<BlockStatement> body;
+        // the name a `let` binds the literal to, if that is how it was written
+        std::string name{};
 
         FunctionLiteral(Token token, std::vector<Identifier> parameters, std::unique_ptr<BlockStatement> body)
             : token(std::move(token)),
@@ -313,6 +341,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -336,6 +366,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -354,6 +386,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -372,6 +406,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -391,6 +427,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         TypeID typeID() override;
@@ -411,6 +449,8 @@ namespace Ast {
 
         std::string tokenLiteral() override;
 
+        Position position() override;
+
         std::string string() override;
 
         Expression *get(Expression &left);
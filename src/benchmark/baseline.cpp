@@ -0,0 +1,74 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "baseline.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "fmt/format.h"
+#include "../server/json.h"
+
+namespace {
+    Object *field(Hash &hash, const std::string &name) {
+        String key(name);
+        const auto pair = hash.pairs().get(key.hash_key());
+        return pair != nullptr ? pair->value : nullptr;
+    }
+
+    template<typename T>
+    T *as(Object *value, const std::string &what) {
+        const auto typed = dynamic_cast<T *>(value);
+        if (typed == nullptr) {
+            throw std::runtime_error(fmt::format("baseline has no valid {:s}", what));
+        }
+        return typed;
+    }
+}
+
+Baseline Baseline::load(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error(fmt::format("cannot read baseline {:s}", path));
+    }
+    std::stringstream text;
+    text << in.rdbuf();
+
+    std::string error;
+    const auto parsed = Json::parse(text.str(), error);
+    if (parsed == nullptr) {
+        throw std::runtime_error(fmt::format("baseline {:s}: {:s}", path, error));
+    }
+
+    Baseline baseline;
+    const auto results = as<Array>(field(*as<Hash>(parsed, "object"), "results"), "`results`");
+    for (const auto element: results->elements) {
+        const auto result = as<Hash>(element, "result");
+        const auto workload = as<String>(field(*result, "workload"), "`workload`")->value;
+        const auto engine = as<String>(field(*result, "engine"), "`engine`")->value;
+        auto &samples = baseline.samples[{workload, engine}];
+        for (const auto sample: as<Array>(field(*result, "samples"), "`samples`")->elements) {
+            samples.push_back(static_cast<double>(as<Integer>(sample, "sample")->value) / 1e9);
+        }
+    }
+    return baseline;
+}
+
+Comparison Comparison::of(const std::vector<double> &before, const std::vector<double> &after, const double threshold,
+                          const double alpha) {
+    Comparison comparison;
+    comparison.before = Summary::of(before);
+    comparison.after = Summary::of(after);
+    if (comparison.before.median > 0) {
+        comparison.change = comparison.after.median / comparison.before.median - 1;
+    }
+    comparison.p = mannWhitney(before, after);
+    if (comparison.p < alpha && comparison.change > threshold) {
+        comparison.verdict = Slower;
+    } else if (comparison.p < alpha && comparison.change < -threshold) {
+        comparison.verdict = Faster;
+    }
+    return comparison;
+}
@@ -0,0 +1,38 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef BASELINE_H
+#define BASELINE_H
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stats.h"
+
+// The timings, in seconds, of a run saved with --json, by (workload, engine).
+struct Baseline {
+    std::map<std::pair<std::string, std::string>, std::vector<double> > samples;
+
+    // Throws std::runtime_error if the file cannot be read or is not benchmark output.
+    static Baseline load(const std::string &path);
+};
+
+// How a workload's timings moved against the baseline. A change only counts if the medians differ by more
+// than the threshold and the Mann-Whitney test says the difference is unlikely to be noise.
+struct Comparison {
+    enum Verdict { Same, Faster, Slower };
+
+    Summary before;
+    Summary after;
+    // relative change of the median, e.g. 0.1 for 10% slower
+    double change{0};
+    double p{1};
+    Verdict verdict{Same};
+
+    static Comparison of(const std::vector<double> &before, const std::vector<double> &after, double threshold,
+                         double alpha);
+};
+
+#endif //BASELINE_H
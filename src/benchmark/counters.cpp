@@ -0,0 +1,141 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "counters.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "fmt/format.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+const char *const PerfCounters::names[NumEvents] = {
+    "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses", "page-faults",
+};
+
+namespace {
+    long pageFaults() {
+#ifdef __linux__
+        rusage usage{};
+        getrusage(RUSAGE_THREAD, &usage);
+        return usage.ru_minflt + usage.ru_majflt;
+#elif !defined(_WIN32)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_minflt + usage.ru_majflt;
+#else
+        return 0;
+#endif
+    }
+
+#ifdef __linux__
+    constexpr uint64_t cacheMiss(const uint64_t cache) {
+        return cache | PERF_COUNT_HW_CACHE_OP_READ << 8 | PERF_COUNT_HW_CACHE_RESULT_MISS << 16;
+    }
+
+    int open(const uint32_t type, const uint64_t config) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        // user space only, which an unprivileged process may count under the default perf_event_paranoid
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+}
+
+PerfCounters::Reading &PerfCounters::Reading::operator+=(const Reading &other) {
+    for (auto i = 0; i < NumEvents; i++) {
+        this->values[i] += other.values[i];
+        this->valid[i] = this->valid[i] && other.valid[i];
+    }
+    return *this;
+}
+
+PerfCounters::PerfCounters() {
+    this->fds.fill(-1);
+#ifdef __linux__
+    const std::pair<uint32_t, uint64_t> events[NumEvents] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D)},
+        {PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL)},
+        {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+    };
+    for (auto i = 0; i < NumEvents; i++) {
+        this->fds[i] = open(events[i].first, events[i].second);
+        if (this->fds[i] < 0 && this->reason.empty()) {
+            this->reason = fmt::format("perf_event_open({:s}): {:s}", names[i], std::strerror(errno));
+        }
+    }
+#else
+    this->reason = "perf_event_open is only available on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (const auto fd: this->fds) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+#endif
+}
+
+const std::string &PerfCounters::unavailable() const {
+    return this->reason;
+}
+
+void PerfCounters::start() {
+    this->faultsAtStart = pageFaults();
+#ifdef __linux__
+    for (const auto fd: this->fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+PerfCounters::Reading PerfCounters::stop() {
+    Reading reading;
+#ifdef __linux__
+    for (const auto fd: this->fds) {
+        if (fd >= 0) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (auto i = 0; i < NumEvents; i++) {
+        // value, time enabled, time running; the kernel multiplexes events when there are more than counters
+        uint64_t values[3]{};
+        if (this->fds[i] < 0 || read(this->fds[i], values, sizeof(values)) != sizeof(values) || values[2] == 0) {
+            continue;
+        }
+        reading.values[i] = static_cast<double>(values[0]) * static_cast<double>(values[1]) /
+                            static_cast<double>(values[2]);
+        reading.valid[i] = true;
+    }
+#endif
+    if (!reading.valid[PageFaults]) {
+        reading.values[PageFaults] = static_cast<double>(pageFaults() - this->faultsAtStart);
+        reading.valid[PageFaults] = true;
+    }
+    return reading;
+}
@@ -0,0 +1,49 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef COUNTERS_H
+#define COUNTERS_H
+#include <array>
+#include <string>
+
+// Hardware performance counters around a stretch of code, read with perf_event_open on Linux and counting
+// this thread in user space only. Events the kernel refuses (no PMU in a VM, perf_event_paranoid, other
+// systems) are left out; page faults then come from getrusage, so a run always gets wall time and faults.
+class PerfCounters {
+public:
+    enum Event { Cycles, Instructions, BranchMisses, L1dMisses, LlcMisses, PageFaults, NumEvents };
+
+    static const char *const names[NumEvents];
+
+    struct Reading {
+        std::array<double, NumEvents> values{};
+        std::array<bool, NumEvents> valid{};
+
+        Reading &operator+=(const Reading &other);
+    };
+
+    PerfCounters();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // why some event could not be opened; empty if all were
+    const std::string &unavailable() const;
+
+    void start();
+
+    Reading stop();
+
+private:
+    // -1 for events that could not be opened
+    std::array<int, NumEvents> fds{};
+    // page faults so far when the counter is not available
+    long faultsAtStart{0};
+    std::string reason;
+};
+
+#endif //COUNTERS_H
@@ -3,85 +3,436 @@
 //
 
 #include <chrono>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <map>
 #include <string>
+#include "fmt/format.h"
+#include "baseline.h"
+#include "counters.h"
+#include "stats.h"
+#include "workloads.h"
 #include "../lexer/lexer.h"
 #include "../parser/parser.h"
 #include "../compiler/compiler.h"
 #include "../evaluator/evaluator.h"
+#include "../object/alloc_stats.h"
 #include "../object/environment.h"
+#include "../object/heap.h"
+#include "../vm/op_profile.h"
+#include "../vm/sampler.h"
 #include "../vm/vm.h"
 
 
 // TODO: much more slower than the program written in golang
 
-const std::string input = R"(
-let fibonacci = fn(x) {
-  if (x == 0) {
-    0
-  } else {
-    if (x == 1) {
-      return 1;
-    } else {
-      fibonacci(x - 1) + fibonacci(x - 2);
-    }
-  }
-};
-fibonacci(35);
-)";
+namespace {
+    struct Options {
+        // "vm", "eval" or "both"
+        std::string engine{"both"};
+        // run only the workload of this name
+        std::string only;
+        int warmup{3};
+        int runs{10};
+        // writes the results, raw timings included, to this file; it can serve as a baseline later
+        std::string json;
+        // compares the results with those saved in this file and exits with 2 if any workload got slower
+        std::string baseline;
+        // smallest relative change of the median that counts as slower or faster
+        double threshold{0.05};
+        // significance level of the Mann-Whitney test
+        double alpha{0.05};
+        // --profile-ops prints per-opcode counts and timings of the measured VM runs, --profile-ops=json as JSON
+        std::string profileOps;
+        // --sample=<file> writes the Monkey call stacks sampled during the measured VM runs to <file>, folded
+        std::string sampleFile;
+        // --counters reads hardware performance counters around each measured run
+        bool counters{false};
+        // --alloc-stats prints what the measured runs allocated by kind and site, --alloc-stats=json as JSON
+        std::string allocStats;
+    };
 
-int main(int argc, char *argv[]) {
-    std::string engine = "vm";
-    if (argc > 1) {
-        engine = argv[1];
+    struct Result {
+        std::string workload;
+        std::string engine;
+        std::vector<double> samples;
+        Summary summary;
+        // summed over the measured runs, if --counters
+        PerfCounters::Reading counters;
+        uint64_t instructions{0};
+    };
+
+    // What one run measured.
+    struct Run {
+        double seconds{0};
+        std::string value;
+        PerfCounters::Reading counters;
+        // Monkey instructions executed; 0 for the evaluator
+        uint64_t instructions{0};
+    };
+
+    bool parseOptions(const int argc, char *argv[], Options &options) {
+        const auto valueOf = [](const std::string &arg, const std::string &flag, std::string &value) {
+            if (arg.rfind(flag + "=", 0) != 0) {
+                return false;
+            }
+            value = arg.substr(flag.size() + 1);
+            return true;
+        };
+        for (auto i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            std::string value;
+            if (arg == "vm" || arg == "eval") {
+                options.engine = arg;
+            } else if (valueOf(arg, "--engine", value)) {
+                options.engine = value;
+            } else if (valueOf(arg, "--workload", value)) {
+                options.only = value;
+            } else if (valueOf(arg, "--warmup", value)) {
+                options.warmup = std::stoi(value);
+            } else if (valueOf(arg, "--runs", value)) {
+                options.runs = std::stoi(value);
+            } else if (valueOf(arg, "--json", value)) {
+                options.json = value;
+            } else if (valueOf(arg, "--baseline", value)) {
+                options.baseline = value;
+            } else if (valueOf(arg, "--threshold", value)) {
+                options.threshold = std::stod(value) / 100;
+            } else if (valueOf(arg, "--alpha", value)) {
+                options.alpha = std::stod(value);
+            } else if (arg == "--profile-ops") {
+                options.profileOps = "table";
+            } else if (valueOf(arg, "--profile-ops", value)) {
+                options.profileOps = value;
+            } else if (valueOf(arg, "--sample", value)) {
+                options.sampleFile = value;
+            } else if (arg == "--counters") {
+                options.counters = true;
+            } else if (arg == "--alloc-stats") {
+                options.allocStats = "table";
+            } else if (valueOf(arg, "--alloc-stats", value)) {
+                options.allocStats = value;
+            } else {
+                std::cerr << "unknown argument " << arg << std::endl;
+                return false;
+            }
+        }
+        if (options.engine != "vm" && options.engine != "eval" && options.engine != "both") {
+            std::cerr << "--engine takes vm, eval or both, got " << options.engine << std::endl;
+            return false;
+        }
+        if (!options.profileOps.empty() && options.profileOps != "table" && options.profileOps != "json") {
+            std::cerr << "--profile-ops takes table or json, got " << options.profileOps << std::endl;
+            return false;
+        }
+        if (!options.allocStats.empty() && options.allocStats != "table" && options.allocStats != "json") {
+            std::cerr << "--alloc-stats takes table or json, got " << options.allocStats << std::endl;
+            return false;
+        }
+        if (options.runs < 1 || options.warmup < 0) {
+            std::cerr << "--runs must be at least 1 and --warmup at least 0" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // One run of `code` on a fresh VM; what it allocated is freed afterwards.
+    Run runVm(const ByteCode &code, OpProfile *profile, Sampler *sampler, PerfCounters *counters,
+              AllocStats *allocs) {
+        Heap heap;
+        Heap::Scope scope(&heap);
+        auto machine = std::make_unique<VM>(code);
+        machine->profileOps(profile);
+        if (sampler != nullptr) {
+            sampler->start(*machine);
+        }
+        // stops sampling if the run throws, while the VM and its functions are still alive
+        struct StopSampler {
+            Sampler *sampler;
+
+            ~StopSampler() {
+                if (this->sampler != nullptr) {
+                    this->sampler->stop();
+                }
+            }
+        } stopSampler{sampler};
+
+        Run run;
+        AllocStats::Scope counting(allocs);
+        if (counters != nullptr) {
+            counters->start();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        machine->run();
+        const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+        if (counters != nullptr) {
+            run.counters = counters->stop();
+        }
+
+        if (sampler != nullptr) {
+            sampler->stop();
+        }
+        run.seconds = duration.count();
+        run.value = machine->lastPoppedStackElem()->inspect();
+        run.instructions = machine->executed();
+        return run;
     }
 
-    Lexer l(input);
-    Parser p(std::move(l));
-    auto program = p.parseProgram();
+    Run runEval(Ast::Program &program, PerfCounters *counters, AllocStats *allocs) {
+        Heap heap;
+        Heap::Scope scope(&heap);
+        const auto env = std::make_shared<Environment>();
+        const auto evaluator = std::make_unique<Evaluator>();
+
+        Run run;
+        AllocStats::Scope counting(allocs);
+        if (counters != nullptr) {
+            counters->start();
+        }
+        const auto start = std::chrono::steady_clock::now();
+        const auto result = evaluator->Eval(program, *env);
+        const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+        if (counters != nullptr) {
+            run.counters = counters->stop();
+        }
+
+        run.seconds = duration.count();
+        run.value = result->inspect();
+        return run;
+    }
 
-    if (!p.errors().empty()) {
-        for (const auto &err: p.errors()) {
-            std::cerr << "parser error: " << err << std::endl;
+    // per-run averages of the counters that could be read
+    std::string countersJson(const Result &result, const int runs) {
+        std::string fields;
+        for (auto i = 0; i < PerfCounters::NumEvents; i++) {
+            if (result.counters.valid[i]) {
+                fields += fmt::format(R"({:s}"{:s}":{:d})", fields.empty() ? "" : ",", PerfCounters::names[i],
+                                      std::llround(result.counters.values[i] / runs));
+            }
+        }
+        if (result.instructions != 0) {
+            fields += fmt::format(R"({:s}"monkey-instructions":{:d})", fields.empty() ? "" : ",",
+                                  result.instructions / runs);
         }
+        return "{" + fields + "}";
+    }
+
+    // Machine instructions per cycle, and misses per Monkey instruction where the VM counted them.
+    void printCounters(const std::vector<Result> &results, const int runs) {
+        std::cout << fmt::format("\n{:<10s}{:<6s}{:>8s}{:>14s}{:>12s}{:>12s}{:>12s}{:>12s}{:>12s}\n", "workload",
+                                 "engine", "IPC", "monkey instr", "cyc/instr", "br/instr", "L1d/instr", "LLC/instr",
+                                 "faults");
+        for (const auto &result: results) {
+            const auto &c = result.counters;
+            const auto cell = [&](const double value, const bool valid, const char *format) {
+                return valid ? fmt::format(format, value) : std::string("-");
+            };
+            const auto perInstr = [&](const PerfCounters::Event event) {
+                return cell(c.values[event] / static_cast<double>(result.instructions),
+                            c.valid[event] && result.instructions != 0, "{:.3f}");
+            };
+            std::cout << fmt::format("{:<10s}{:<6s}{:>8s}{:>14s}{:>12s}{:>12s}{:>12s}{:>12s}{:>12s}\n",
+                                     result.workload, result.engine,
+                                     cell(c.values[PerfCounters::Instructions] / c.values[PerfCounters::Cycles],
+                                          c.valid[PerfCounters::Instructions] && c.valid[PerfCounters::Cycles] &&
+                                          c.values[PerfCounters::Cycles] > 0, "{:.2f}"),
+                                     cell(static_cast<double>(result.instructions) / runs, result.instructions != 0,
+                                          "{:.0f}"),
+                                     perInstr(PerfCounters::Cycles), perInstr(PerfCounters::BranchMisses),
+                                     perInstr(PerfCounters::L1dMisses), perInstr(PerfCounters::LlcMisses),
+                                     cell(c.values[PerfCounters::PageFaults] / runs, c.valid[PerfCounters::PageFaults],
+                                          "{:.0f}"));
+        }
+    }
+
+    // timings are written as integer nanoseconds
+    std::string toJson(const Options &options, const std::vector<Result> &results) {
+        const auto ns = [](const double seconds) { return std::llround(seconds * 1e9); };
+        std::string entries;
+        for (const auto &result: results) {
+            std::string samples;
+            for (const auto sample: result.samples) {
+                samples += fmt::format("{:s}{:d}", samples.empty() ? "" : ",", ns(sample));
+            }
+            const auto counters = options.counters
+                                      ? fmt::format(R"(,"counters":{:s})", countersJson(result, options.runs))
+                                      : "";
+            const auto &s = result.summary;
+            entries += fmt::format(
+                R"({:s}{{"workload":"{:s}","engine":"{:s}","median":{:d},"p95":{:d},"mean":{:d},)"
+                R"("stddev":{:d},"min":{:d},"max":{:d},"samples":[{:s}]{:s}}})",
+                entries.empty() ? "" : ",", result.workload, result.engine, ns(s.median), ns(s.p95), ns(s.mean),
+                ns(s.stddev), ns(s.min), ns(s.max), samples, counters);
+        }
+        return fmt::format(R"({{"unit":"ns","warmup":{:d},"runs":{:d},"results":[{:s}]}})", options.warmup,
+                           options.runs, entries);
+    }
+
+    // Prints how each result moved against `baseline`; returns whether any got slower.
+    bool compare(const Options &options, const Baseline &baseline, const std::vector<Result> &results) {
+        std::cout << fmt::format("\n{:<10s}{:<6s}{:>12s}{:>12s}{:>10s}{:>10s}  {:s}\n", "workload", "engine",
+                                 "base ms", "now ms", "change", "p", "verdict");
+        auto regressed = false;
+        for (const auto &result: results) {
+            const auto it = baseline.samples.find({result.workload, result.engine});
+            if (it == baseline.samples.end()) {
+                std::cout << fmt::format("{:<10s}{:<6s}{:>12s}{:>12.3f}{:>10s}{:>10s}  new\n", result.workload,
+                                         result.engine, "-", result.summary.median * 1e3, "-", "-");
+                continue;
+            }
+            const auto c = Comparison::of(it->second, result.samples, options.threshold, options.alpha);
+            const auto verdict = c.verdict == Comparison::Slower
+                                     ? "SLOWER"
+                                     : c.verdict == Comparison::Faster
+                                           ? "faster"
+                                           : "same";
+            std::cout << fmt::format("{:<10s}{:<6s}{:>12.3f}{:>12.3f}{:>+9.1f}%{:>10.4f}  {:s}\n", result.workload,
+                                     result.engine, c.before.median * 1e3, c.after.median * 1e3, c.change * 100, c.p,
+                                     verdict);
+            regressed = regressed || c.verdict == Comparison::Slower;
+        }
+        return regressed;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
         return 1;
     }
 
-    Object *result;
-    std::chrono::duration<double> duration;
+    std::vector<std::string> engines;
+    if (options.engine != "eval") {
+        engines.emplace_back("vm");
+    }
+    if (options.engine != "vm") {
+        engines.emplace_back("eval");
+    }
 
-    if (engine == "vm") {
-        auto comp = std::make_unique<Compiler>();
+    Baseline baseline;
+    if (!options.baseline.empty()) {
         try {
-            comp->compile(program.get());
+            baseline = Baseline::load(options.baseline);
         } catch (const std::runtime_error &err) {
-            std::cerr << "compiler error: " << err.what() << std::endl;
+            std::cerr << err.what() << std::endl;
             return 1;
         }
+    }
 
-        auto machine = std::make_unique<VM>(comp->byteCode());
-        auto start = std::chrono::high_resolution_clock::now();
+    OpProfile profile;
+    Sampler sampler;
+    // by engine; the evaluator has no opcodes, its allocations are only told apart by builtin
+    std::map<std::string, AllocStats> allocs;
+    std::unique_ptr<PerfCounters> counters;
+    if (options.counters) {
+        counters = std::make_unique<PerfCounters>();
+        if (!counters->unavailable().empty()) {
+            std::cerr << "counters: " << counters->unavailable() << "; counting what is left" << std::endl;
+        }
+    }
+    std::vector<Result> results;
+
+    std::cout << fmt::format("{:<10s}{:<6s}{:>12s}{:>12s}{:>12s}{:>12s}\n", "workload", "engine", "median ms",
+                             "p95 ms", "stddev ms", "min ms");
+    for (const auto &workload: workloads) {
+        if (!options.only.empty() && workload.name != options.only) {
+            continue;
+        }
 
+        Parser p(Lexer(workload.source));
+        auto program = p.parseProgram();
+        if (!p.errors().empty()) {
+            for (const auto &err: p.errors()) {
+                std::cerr << workload.name << ": parser error: " << err << std::endl;
+            }
+            return 1;
+        }
+        auto comp = std::make_unique<Compiler>();
         try {
-            machine->run();
+            comp->compile(program.get());
         } catch (const std::runtime_error &err) {
-            std::cerr << "vm error: " << err.what() << std::endl;
+            std::cerr << workload.name << ": compiler error: " << err.what() << std::endl;
             return 1;
         }
+        const auto code = comp->byteCode();
 
-        duration = std::chrono::high_resolution_clock::now() - start;
-        result = machine->lastPoppedStackElem();
-    } else {
-        auto env = std::make_shared<Environment>();
-        auto start = std::chrono::high_resolution_clock::now();
-        auto evaluator = new Evaluator();
-        result = evaluator->Eval(*program, *env);
-        duration = std::chrono::high_resolution_clock::now() - start;
+        for (const auto &engine: engines) {
+            Result result{workload.name, engine};
+            for (auto i = 0; i < options.warmup + options.runs; i++) {
+                const auto measured = i >= options.warmup;
+                auto *runCounters = measured ? counters.get() : nullptr;
+                auto *runAllocs = measured && !options.allocStats.empty() ? &allocs[engine] : nullptr;
+                Run run;
+                try {
+                    if (engine == "vm") {
+                        run = runVm(code, measured && !options.profileOps.empty() ? &profile : nullptr,
+                                    measured && !options.sampleFile.empty() ? &sampler : nullptr, runCounters,
+                                    runAllocs);
+                    } else {
+                        run = runEval(*program, runCounters, runAllocs);
+                    }
+                } catch (const std::runtime_error &err) {
+                    std::cerr << workload.name << ": " << engine << " error: " << err.what() << std::endl;
+                    return 1;
+                }
+                if (run.value != workload.expected) {
+                    std::cerr << workload.name << ": " << engine << " returned " << run.value << ", want "
+                            << workload.expected << std::endl;
+                    return 1;
+                }
+                if (!measured) {
+                    continue;
+                }
+                if (result.samples.empty()) {
+                    result.counters = run.counters;
+                } else {
+                    result.counters += run.counters;
+                }
+                result.samples.push_back(run.seconds);
+                result.instructions += run.instructions;
+            }
+
+            result.summary = Summary::of(result.samples);
+            const auto &s = result.summary;
+            std::cout << fmt::format("{:<10s}{:<6s}{:>12.3f}{:>12.3f}{:>12.3f}{:>12.3f}\n", workload.name, engine,
+                                     s.median * 1e3, s.p95 * 1e3, s.stddev * 1e3, s.min * 1e3);
+            results.push_back(std::move(result));
+        }
     }
 
-    std::cout << "engine=" << engine
-            << ", result=" << result->inspect()
-            << ", duration=" << duration.count() << "s\n";
+    if (options.counters) {
+        printCounters(results, options.runs);
+    }
+    if (!options.json.empty()) {
+        std::ofstream out(options.json);
+        out << toJson(options, results) << "\n";
+    }
+    if (options.profileOps == "json") {
+        std::cout << profile.toJson() << "\n";
+    } else if (options.profileOps == "table") {
+        profile.report(std::cout);
+    }
+    if (options.allocStats == "json") {
+        std::string engines;
+        for (const auto &[engine, stats]: allocs) {
+            engines += fmt::format(R"({:s}"{:s}":{:s})", engines.empty() ? "" : ",", engine, stats.toJson());
+        }
+        std::cout << "{" << engines << "}\n";
+    } else if (options.allocStats == "table") {
+        for (const auto &[engine, stats]: allocs) {
+            std::cout << fmt::format("\nallocations of the {:s} runs\n", engine);
+            stats.report(std::cout);
+        }
+    }
+    if (!options.sampleFile.empty()) {
+        std::ofstream out(options.sampleFile);
+        sampler.writeFolded(out);
+        std::cerr << "sampler: " << sampler.samples() << " samples, " << sampler.dropped() << " dropped\n";
+    }
+    if (!options.baseline.empty() && compare(options, baseline, results)) {
+        return 2;
+    }
 
     return 0;
 }
@@ -0,0 +1,86 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace {
+    // nearest-rank percentile of sorted samples
+    double percentile(const std::vector<double> &sorted, const double p) {
+        const auto rank = static_cast<size_t>(std::ceil(p / 100 * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+}
+
+double mannWhitney(const std::vector<double> &a, const std::vector<double> &b) {
+    if (a.empty() || b.empty()) {
+        return 1;
+    }
+    // rank the pooled samples, giving tied values the mean of their ranks
+    std::vector<std::pair<double, bool> > pooled;
+    for (const auto x: a) {
+        pooled.emplace_back(x, true);
+    }
+    for (const auto x: b) {
+        pooled.emplace_back(x, false);
+    }
+    std::sort(pooled.begin(), pooled.end());
+
+    const auto n = static_cast<double>(pooled.size());
+    auto rankSumA = 0.0;
+    auto ties = 0.0;
+    for (size_t i = 0; i < pooled.size();) {
+        auto j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) {
+            j++;
+        }
+        const auto rank = static_cast<double>(i + j + 1) / 2;
+        for (auto k = i; k < j; k++) {
+            if (pooled[k].second) {
+                rankSumA += rank;
+            }
+        }
+        const auto t = static_cast<double>(j - i);
+        ties += t * t * t - t;
+        i = j;
+    }
+
+    const auto na = static_cast<double>(a.size());
+    const auto nb = static_cast<double>(b.size());
+    const auto u = rankSumA - na * (na + 1) / 2;
+    const auto mean = na * nb / 2;
+    const auto variance = na * nb / 12 * (n + 1 - ties / (n * (n - 1)));
+    if (variance <= 0) {
+        return 1;
+    }
+    // continuity correction
+    const auto z = std::max(0.0, std::abs(u - mean) - 0.5) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+Summary Summary::of(std::vector<double> samples) {
+    Summary summary;
+    if (samples.empty()) {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+    const auto n = samples.size();
+
+    summary.median = n % 2 == 1 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    summary.p95 = percentile(samples, 95);
+    summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / static_cast<double>(n);
+    if (n > 1) {
+        auto squares = 0.0;
+        for (const auto sample: samples) {
+            squares += (sample - summary.mean) * (sample - summary.mean);
+        }
+        summary.stddev = std::sqrt(squares / static_cast<double>(n - 1));
+    }
+    summary.min = samples.front();
+    summary.max = samples.back();
+    return summary;
+}
@@ -0,0 +1,27 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef STATS_H
+#define STATS_H
+#include <vector>
+
+// Summary of repeated timings, in seconds.
+struct Summary {
+    double median{0};
+    double p95{0};
+    double mean{0};
+    // sample standard deviation
+    double stddev{0};
+    double min{0};
+    double max{0};
+
+    static Summary of(std::vector<double> samples);
+};
+
+// Two-sided p-value of the Mann-Whitney U test that `a` and `b` come from the same distribution, using the
+// normal approximation with a correction for ties. Makes no assumption about the shape of the timings,
+// which are skewed by outliers. 1 if either sample is empty.
+double mannWhitney(const std::vector<double> &a, const std::vector<double> &b);
+
+#endif //STATS_H
@@ -0,0 +1,73 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef WORKLOADS_H
+#define WORKLOADS_H
+#include <string>
+#include <vector>
+
+// A benchmark program and the value it must evaluate to on either engine.
+struct Workload {
+    std::string name;
+    std::string source;
+    std::string expected;
+};
+
+// Each one stresses a different part of the runtime; sizes keep a run in the tens of milliseconds for the VM.
+inline const std::vector<Workload> workloads = {
+    {
+        "fib", R"(
+let fib = fn(n) { if (n < 2) { n } else { fib(n - 1) + fib(n - 2) } };
+fib(22)
+)",
+        "17711"
+    },
+    {
+        "closures", R"(
+let adder = fn(k) { fn(x) { x + k } };
+let step = fn(acc, x) { acc + x };
+let round = fn(k) { reduce(map(range(1000), adder(k)), 0, step) };
+reduce(map(range(50), round), 0, step)
+)",
+        "26200000"
+    },
+    {
+        "strings", R"(
+let build = fn(n, s) { if (n == 0) { s } else { build(n - 1, s + "ab") } };
+let round = fn(i) { len(build(400, "")) };
+reduce(map(range(50), round), 0, fn(acc, x) { acc + x })
+)",
+        "40000"
+    },
+    {
+        "records", R"(
+let people = map(range(500), fn(i) { {"id": i, "age": i * 2, "score": i * 3} });
+let total = fn(acc, p) { acc + p["age"] + p["score"] };
+let round = fn(i) { reduce(people, 0, total) };
+reduce(map(range(50), round), 0, fn(acc, x) { acc + x })
+)",
+        "31187500"
+    },
+    {
+        "arrays", R"(
+let fill = fn(n, arr) { if (n == 0) { arr } else { fill(n - 1, push(arr, n)) } };
+let drain = fn(arr, acc) { if (len(arr) == 0) { acc } else { drain(rest(arr), acc + first(arr)) } };
+let round = fn(i) { drain(fill(300, []), 0) };
+reduce(map(range(20), round), 0, fn(acc, x) { acc + x })
+)",
+        "903000"
+    },
+    {
+        "nesting", R"(
+let depth = fn(n) {
+  if (n == 0) { 0 } else { if (n > 0) { if (true) { 1 + depth(n - 1) } else { 0 } } else { 0 } }
+};
+let round = fn(i) { depth(500) };
+reduce(map(range(100), round), 0, fn(acc, x) { acc + x })
+)",
+        "50000"
+    },
+};
+
+#endif //WORKLOADS_H
@@ -11,7 +11,7 @@
 
 #include "fmt/printf.h"
 
-Definition *lookup(uint8_t op) {
+const Definition *lookup(uint8_t op) {
     if (const auto count = definitions.count(static_cast<OpCode>(op)); count > 0) {
         return &definitions.at(static_cast<OpCode>(op));
     }
@@ -95,7 +95,7 @@ std::string string(Instructions &ins) {
     return oss.str();
 }
 
-std::string fmtInstructions(Definition &def, std::vector<int> operands) {
+std::string fmtInstructions(const Definition &def, std::vector<int> operands) {
     auto operandCount = def.operandWidths.size();
 
     if (operandCount != operands.size()) {
@@ -56,6 +56,9 @@ enum class OpCode:unsigned char {
     OpClosure,
 
     OpGetFree,
+
+    OpRecord,
+    OpIndexConstKey,
 };
 
 struct Definition {
@@ -64,7 +67,7 @@ struct Definition {
 };
 
 
-inline std::map<OpCode, Definition> definitions{
+inline const std::map<OpCode, Definition> definitions{
     {OpCode::OpConstant, {"OpConstant", std::vector{2}}},
 
     {OpCode::OpAdd, {"OpAdd", {}}},
@@ -110,11 +113,14 @@ inline std::map<OpCode, Definition> definitions{
     {OpCode::OpClosure, {"OpClosure", {2, 1}}},
 
     {OpCode::OpGetFree, {"OpGetFree", {1}}},
+
+    {OpCode::OpRecord, {"OpRecord", {2}}},
+    {OpCode::OpIndexConstKey, {"OpIndexConstKey", {2}}},
 };
 
 std::string string(Instructions &ins);
 
-std::string fmtInstructions(Definition &def, std::vector<int> operands);
+std::string fmtInstructions(const Definition &def, std::vector<int> operands);
 
 namespace Code {
     Instructions make(OpCode op, const std::vector<int> &operands);
@@ -128,6 +134,6 @@ uint8_t readUnit8(const Instructions &ins);
 
 uint16_t readUnit16(const Instructions &ins);
 
-Definition *lookup(uint8_t op);
+const Definition *lookup(uint8_t op);
 
 #endif //CODE_H
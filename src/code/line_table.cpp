@@ -0,0 +1,89 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "line_table.h"
+
+namespace {
+    void putVarint(std::vector<uint8_t> &out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    uint64_t getVarint(const std::vector<uint8_t> &in, size_t &at) {
+        uint64_t value = 0;
+        for (auto shift = 0; at < in.size(); shift += 7) {
+            const auto byte = in[at++];
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+        }
+        return value;
+    }
+
+    int64_t unzigzag(const uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+}
+
+LineTable::LineTable(const std::vector<std::pair<int, int> > &entries) {
+    std::vector<uint8_t> encoded;
+    auto offset = 0;
+    auto line = 0;
+    for (const auto &[nextOffset, nextLine]: entries) {
+        const int64_t delta = nextLine - line;
+        putVarint(encoded, nextOffset - offset);
+        putVarint(encoded, static_cast<uint64_t>(delta << 1) ^ static_cast<uint64_t>(delta >> 63));
+        offset = nextOffset;
+        line = nextLine;
+    }
+    this->bytes = std::make_shared<const std::vector<uint8_t> >(std::move(encoded));
+}
+
+LineTable::LineTable(std::vector<uint8_t> encoded)
+    : bytes(std::make_shared<const std::vector<uint8_t> >(std::move(encoded))) {
+}
+
+std::vector<std::pair<int, int> > LineTable::entries() const {
+    std::vector<std::pair<int, int> > entries;
+    if (this->bytes == nullptr) {
+        return entries;
+    }
+    auto offset = 0;
+    auto line = 0;
+    for (size_t at = 0; at < this->bytes->size();) {
+        offset += static_cast<int>(getVarint(*this->bytes, at));
+        line += static_cast<int>(unzigzag(getVarint(*this->bytes, at)));
+        entries.emplace_back(offset, line);
+    }
+    return entries;
+}
+
+int LineTable::lineAt(const int offset) const {
+    if (this->bytes == nullptr) {
+        return 0;
+    }
+    auto start = 0;
+    auto line = 0;
+    for (size_t at = 0; at < this->bytes->size();) {
+        start += static_cast<int>(getVarint(*this->bytes, at));
+        if (start > offset) {
+            break;
+        }
+        line += static_cast<int>(unzigzag(getVarint(*this->bytes, at)));
+    }
+    return line;
+}
+
+const std::vector<uint8_t> &LineTable::encoded() const {
+    static const std::vector<uint8_t> none;
+    return this->bytes == nullptr ? none : *this->bytes;
+}
+
+bool LineTable::empty() const {
+    return this->bytes == nullptr || this->bytes->empty();
+}
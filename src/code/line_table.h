@@ -0,0 +1,39 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef LINE_TABLE_H
+#define LINE_TABLE_H
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Maps the instruction offsets of one function to the source lines they were compiled from. It is kept
+// apart from the instructions, so it costs neither bytecode size nor dispatch time. An entry is only stored
+// where the line changes, as an unsigned varint offset delta and a zigzag varint line delta, so a typical
+// entry takes two bytes. Copies share the encoding.
+class LineTable {
+public:
+    LineTable() = default;
+
+    // `entries` are (offset, line) pairs by increasing offset
+    explicit LineTable(const std::vector<std::pair<int, int> > &entries);
+
+    // from `encoded()`, e.g. read back from a snapshot
+    explicit LineTable(std::vector<uint8_t> encoded);
+
+    // line of the instruction at `offset`, or 0 if unknown
+    int lineAt(int offset) const;
+
+    std::vector<std::pair<int, int> > entries() const;
+
+    const std::vector<uint8_t> &encoded() const;
+
+    bool empty() const;
+
+private:
+    std::shared_ptr<const std::vector<uint8_t> > bytes;
+};
+
+#endif //LINE_TABLE_H
@@ -22,10 +22,27 @@ int Compiler::addConstant(Object &obj) {
     return this->constants.size() - 1;
 }
 
+int Compiler::addShape(const std::vector<std::string> &keys) {
+    if (const auto it = this->shapeConstants.find(keys); it != this->shapeConstants.end()) {
+        return it->second;
+    }
+
+    std::vector<String *> keyObjects{};
+    keyObjects.reserve(keys.size());
+    for (const auto &key: keys) {
+        keyObjects.push_back(new String(key));
+    }
+
+    const auto index = this->addConstant(*new Shape(keyObjects));
+    this->shapeConstants[keys] = index;
+    return index;
+}
+
 int Compiler::emit(const OpCode op, const std::vector<int> &operands) {
     const auto ins = Code::make(op, operands);
     const auto pos = this->addInstructions(ins);
     this->setLastInstruction(op, pos);
+    this->markLine(pos);
     return pos;
 }
 
@@ -37,6 +54,21 @@ int Compiler::addInstructions(std::vector<std::byte> ins) {
     return posNewInstruction;
 }
 
+void Compiler::markLine(const int pos) const {
+    if (this->line == 0) {
+        return;
+    }
+    auto &lines = this->currentScope().lines;
+    if (!lines.empty() && lines.back().second == this->line) {
+        return;
+    }
+    if (!lines.empty() && lines.back().first == pos) {
+        lines.back().second = this->line;
+        return;
+    }
+    lines.emplace_back(pos, this->line);
+}
+
 void Compiler::setLastInstruction(const OpCode op, const int pos) const {
     this->currentScope().previousInstruction = this->currentScope().lastInstruction;
     this->currentScope().lastInstruction = {op, pos};
@@ -58,6 +90,11 @@ void Compiler::removeLastPop() {
 
     this->currentScope().instructions = newInstructions;
     this->currentScope().lastInstruction = previous;
+
+    auto &lines = this->currentScope().lines;
+    while (!lines.empty() && lines.back().first >= position) {
+        lines.pop_back();
+    }
 }
 
 void Compiler::replaceInstruction(const int pos, const std::vector<std::byte> &newInstruction) {
@@ -123,6 +160,11 @@ void Compiler::loadSymbol(Symbol s) {
 }
 
 void Compiler::compile(Ast::Node *_node) {
+    // instructions get the line of the innermost node they were compiled for
+    const auto outerLine = this->line;
+    if (const auto line = _node->position().line; line > 0) {
+        this->line = line;
+    }
 #ifdef USE_TYPE_ID
     switch (_node->typeID()) {
         case Ast::TypeID::Program_: {
@@ -264,6 +306,20 @@ void Compiler::compile(Ast::Node *_node) {
         }
         case Ast::TypeID::ArrayLiteral_: {
             auto node = dynamic_cast<Ast::ArrayLiteral *>(_node);
+            // integer-only literals are folded into a single unboxed constant
+            std::vector<int64_t> values{};
+            for (auto &element: node->elements) {
+                auto integer = dynamic_cast<Ast::IntegerLiteral *>(element.get());
+                if (integer == nullptr) {
+                    break;
+                }
+                values.push_back(integer->value);
+            }
+            if (!values.empty() && values.size() == node->elements.size()) {
+                auto ints = new IntArray(values);
+                this->emit(OpCode::OpConstant, {this->addConstant(*ints)});
+                break;
+            }
             for (auto &element: node->elements) {
                 this->compile(element.get());
             }
@@ -281,6 +337,22 @@ void Compiler::compile(Ast::Node *_node) {
                 return a->string() < b->string();
             });
 
+            // a literal whose keys are all string literals is a record: only the values go on the stack,
+            // the keys live in a shared Shape constant
+            auto isRecord = !keys.empty();
+            for (const auto k: keys) {
+                isRecord = isRecord && k->typeID() == Ast::TypeID::StringLiteral_;
+            }
+            if (isRecord) {
+                std::vector<std::string> shapeKeys{};
+                for (const auto k: keys) {
+                    shapeKeys.push_back(dynamic_cast<Ast::StringLiteral *>(k)->value);
+                    this->compile(node->get(*k));
+                }
+                this->emit(OpCode::OpRecord, {this->addShape(shapeKeys)});
+                break;
+            }
+
             for (const auto k: keys) {
                 this->compile(k);
                 this->compile(node->get(*k));
@@ -293,6 +365,11 @@ void Compiler::compile(Ast::Node *_node) {
             auto node = dynamic_cast<Ast::IndexExpression *>(_node);
 
             this->compile(node->left.get());
+            if (node->index->typeID() == Ast::TypeID::StringLiteral_) {
+                const auto key = dynamic_cast<Ast::StringLiteral *>(node->index.get());
+                this->emit(OpCode::OpIndexConstKey, {this->addConstant(*new String(key->value))});
+                break;
+            }
             this->compile(node->index.get());
 
             this->emit(OpCode::OpIndex, {});
@@ -318,6 +395,7 @@ void Compiler::compile(Ast::Node *_node) {
 
             auto free_symbols = this->symbolTable->free_symbols;
             int num_locals = this->symbolTable->num_definitions;
+            auto lines = LineTable(this->currentScope().lines);
             auto instructions = this->leaveScope();
 
             for (auto s: free_symbols) {
@@ -327,8 +405,11 @@ void Compiler::compile(Ast::Node *_node) {
             auto compiled_fn = new CompiledFunction(instructions,
                                                     num_locals,
                                                     static_cast<int>(node->parameters.size()));
+            compiled_fn->name = node->name;
+            compiled_fn->lines = std::move(lines);
 
             auto fn_index = this->addConstant(*compiled_fn);
+            compiled_fn->constant = fn_index;
             this->emit(OpCode::OpClosure, {fn_index, static_cast<int>(free_symbols.size())});
 
             break;
@@ -356,6 +437,7 @@ void Compiler::compile(Ast::Node *_node) {
         default:
             throw std::runtime_error("unknown node type");
     }
+    this->line = outerLine;
 #endif
 #ifdef   USE_INSTANCE_OF
     if (instance_of<Ast::Node, Ast::Program>(*_node)) {
@@ -562,6 +644,7 @@ void Compiler::compile(Ast::Node *_node) {
             static_cast<int>(node->parameters.size()));
 
         auto fn_index = this->addConstant(*compiled_fn);
+        compiled_fn->constant = fn_index;
         this->emit(OpCode::OpClosure, {fn_index, static_cast<int>(free_symbols.size())});
 
         return;
@@ -591,5 +674,17 @@ void Compiler::compile(Ast::Node *_node) {
 }
 
 ByteCode Compiler::byteCode() const {
-    return {this->currentInstructions(), this->constants};
+    return {this->currentInstructions(), this->constants, LineTable(this->currentScope().lines)};
+}
+
+MainCode Compiler::takeInstructions() {
+    // a failed compile may have left function scopes open
+    while (this->scopeIndex > 0) {
+        this->leaveScope();
+    }
+    auto &main = *this->scopes[0];
+    MainCode code{std::move(main.instructions), LineTable(main.lines)};
+    main = CompilationScope{};
+    this->line = 0;
+    return code;
 }
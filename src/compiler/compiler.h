@@ -15,6 +15,14 @@
 struct ByteCode {
     Instructions instructions{};
     std::vector<Object *> constants{};
+    // lines of the top-level instructions; functions carry their own
+    LineTable lines{};
+};
+
+// The top-level instructions of one REPL line, with their lines.
+struct MainCode {
+    Instructions instructions{};
+    LineTable lines{};
 };
 
 struct EmittedInstructions {
@@ -26,6 +34,8 @@ struct CompilationScope {
     Instructions instructions{};
     EmittedInstructions lastInstruction{};
     EmittedInstructions previousInstruction{};
+    // (offset, line) wherever the source line of the emitted instructions changes
+    std::vector<std::pair<int, int> > lines{};
 };
 
 class Compiler {
@@ -35,6 +45,10 @@ public:
     std::shared_ptr<SymbolTable> symbolTable;
     std::vector<CompilationScope *> scopes{};
     int scopeIndex{0};
+    // source line of the node being compiled, 0 if unknown
+    int line{0};
+    // record literals with the same keys share one Shape constant
+    std::map<std::vector<std::string>, int> shapeConstants{};
 
     void defineBuiltins() const {
         auto i = 0;
@@ -48,12 +62,16 @@ public:
 
     int addConstant(Object &obj);
 
+    int addShape(const std::vector<std::string> &keys);
+
     int emit(OpCode op, const std::vector<int> &operands);
 
     int addInstructions(std::vector<std::byte> ins);
 
     void setLastInstruction(OpCode op, int pos) const;
 
+    void markLine(int pos) const;
+
     bool lastInstructionIs(OpCode op);
 
     void removeLastPop();
@@ -90,6 +108,10 @@ public:
     void compile(Ast::Node *_node);
 
     ByteCode byteCode() const;
+
+    // Hands over the main program compiled so far and starts an empty one, keeping constants and symbols,
+    // so the REPL can compile line after line without copying either.
+    MainCode takeInstructions();
 };
 
 #endif //COMPILER_H
@@ -11,10 +11,10 @@
 
 using SymbolScope = std::string;
 
-inline SymbolScope LocalScope = "LOCAL";
-inline SymbolScope GlobalScope = "GLOBAL";
-inline SymbolScope BuiltinScope = "BUILTIN";
-inline SymbolScope FreeScope = "FREE";
+inline const SymbolScope LocalScope = "LOCAL";
+inline const SymbolScope GlobalScope = "GLOBAL";
+inline const SymbolScope BuiltinScope = "BUILTIN";
+inline const SymbolScope FreeScope = "FREE";
 
 struct Symbol {
     std::string name;
@@ -0,0 +1,133 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "engine.h"
+
+#include <stdexcept>
+
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+#include "../vm/snapshot.h"
+#include "../vm/vm.h"
+#include "fmt/format.h"
+
+namespace monkey {
+    Script::Script(std::shared_ptr<const ByteCode> bytecode) : bytecode(std::move(bytecode)) {
+    }
+
+    const ByteCode &Script::code() const {
+        return *this->bytecode;
+    }
+
+    Engine::Engine() : symbolTable(std::make_shared<SymbolTable>()) {
+        for (size_t i = 0; i < builtins.size(); i++) {
+            this->symbolTable->defineBuiltin(static_cast<int>(i), builtins[i].first);
+        }
+        this->latest = std::make_shared<const ByteCode>();
+    }
+
+    Engine::~Engine() = default;
+
+    Script Engine::compile(const std::string &source) {
+        auto parser = Parser(Lexer(source));
+        auto program = parser.parseProgram();
+        if (const auto errors = parser.errors(); !errors.empty()) {
+            std::string message = "parser errors:";
+            for (const auto &error: errors) {
+                message += "\n\t" + error;
+            }
+            throw std::runtime_error(message);
+        }
+
+        auto compiler = Compiler(this->constants, this->symbolTable);
+        compiler.compile(program.get());
+
+        auto bytecode = std::make_shared<const ByteCode>(compiler.byteCode());
+        this->constants = bytecode->constants;
+        this->latest = bytecode;
+        return Script(bytecode);
+    }
+
+    Object *Engine::run(const Script &script, const Budget &budget) {
+        return this->run(script, this->isolate, budget);
+    }
+
+    Object *Engine::run(const Script &script, Isolate &isolate, const Budget &budget) {
+        return isolate.run(script.bytecode, budget, this->flightPath);
+    }
+
+    void Engine::bind(const std::string &name, Builtin *fn) {
+        auto [symbol, ok] = this->symbolTable->resolve(name);
+        if (!ok || symbol.scope != GlobalScope) {
+            symbol = this->symbolTable->define(name);
+        }
+        (*this->isolate.globals)[symbol.index] = fn;
+    }
+
+    void Engine::save(const std::string &path) {
+        Snapshot::save(path, this->constants, *this->isolate.globals, this->symbolTable.get());
+    }
+
+    void Engine::restore(const std::string &path) {
+        Heap::Scope scope(&this->isolate.heap);
+        auto image = Snapshot::load(path, this->symbolTable.get());
+        this->constants = image.code->constants;
+        this->latest = image.code;
+        // VMs made for `call` hold on to the globals vector itself
+        *this->isolate.globals = std::move(*image.globals);
+    }
+
+    Object *Engine::global(const std::string &name) {
+        const auto [symbol, ok] = this->symbolTable->resolve(name);
+        if (!ok || symbol.scope != GlobalScope) {
+            return nullptr;
+        }
+        return (*this->isolate.globals)[symbol.index];
+    }
+
+    VM &Engine::callerVM() {
+        if (this->caller == nullptr || this->callerCode != this->latest) {
+            const auto code = std::make_shared<const ByteCode>(ByteCode{{}, this->latest->constants});
+            this->caller = std::make_unique<VM>(code, this->isolate.globals);
+            this->caller->writeFlightOnError(this->flightPath);
+            this->callerCode = this->latest;
+        }
+        return *this->caller;
+    }
+
+    void Engine::writeFlightOnError(const std::string &path) {
+        this->flightPath = path;
+        if (this->caller != nullptr) {
+            this->caller->writeFlightOnError(path);
+        }
+    }
+
+    Object *Engine::call(Object &fn, const std::vector<Object *> &args) {
+        auto &vm = this->callerVM();
+        Heap::Scope scope(&this->isolate.heap);
+        return vm.callFunction(fn, args);
+    }
+
+    static Closure *batchClosure(Object &fn) {
+        if (fn.type() != CLOSURE_OBJ) {
+            throw std::runtime_error(fmt::format("batch calls need a closure, got {:s}", fn.type()));
+        }
+        return dynamic_cast<Closure *>(&fn);
+    }
+
+    void Engine::callRows(Object &fn, const ArgSpan rows, Object **out, const size_t nullaryRows) {
+        const auto closure = batchClosure(fn);
+        auto &vm = this->callerVM();
+        Heap::Scope scope(&this->isolate.heap);
+        vm.invokeRows(closure, rows, out, nullaryRows);
+    }
+
+    void Engine::callColumns(Object &fn, const std::vector<ArgSpan> &columns, Object **out,
+                             const size_t nullaryRows) {
+        const auto closure = batchClosure(fn);
+        auto &vm = this->callerVM();
+        Heap::Scope scope(&this->isolate.heap);
+        vm.invokeColumns(closure, columns, out, nullaryRows);
+    }
+}
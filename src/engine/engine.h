@@ -0,0 +1,97 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef ENGINE_H
+#define ENGINE_H
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../compiler/compiler.h"
+#include "../runtime/isolate.h"
+
+class VM;
+
+namespace monkey {
+    // A compiled program. Immutable, so one script can be run any number of times,
+    // from any thread, without touching the source text again.
+    class Script {
+        friend class Engine;
+
+        std::shared_ptr<const ByteCode> bytecode;
+
+        explicit Script(std::shared_ptr<const ByteCode> bytecode);
+
+    public:
+        const ByteCode &code() const;
+    };
+
+    // Embedding entry point: compile once, then run scripts and call the functions they export.
+    // Scripts compiled by the same engine see each other's global bindings, like lines typed into the REPL.
+    // An engine is not thread-safe; use one per thread, or share scripts and run them in separate isolates.
+    class Engine {
+    public:
+        Engine();
+
+        ~Engine();
+
+        // Throws std::runtime_error listing the parser errors, or the compiler's error.
+        Script compile(const std::string &source);
+
+        // Runs `script` against the engine's persistent globals and returns the last popped value.
+        // Returned objects stay valid for the lifetime of the engine.
+        // Throws BudgetExceeded if the run exceeds `budget`; globals it set before that stay set.
+        Object *run(const Script &script, const Budget &budget = {});
+
+        // Runs `script` against the fresh globals of `isolate`, which owns everything the run allocates.
+        // Bindings the script takes from other scripts of this engine are unset there.
+        Object *run(const Script &script, Isolate &isolate, const Budget &budget = {});
+
+        // Makes `fn` (usually from `bindNative`) a global that scripts compiled from now on can call.
+        // Binding a name again replaces the function, also for scripts already compiled.
+        void bind(const std::string &name, Builtin *fn);
+
+        // The value bound to a global name by a script run on the persistent globals, or nullptr.
+        Object *global(const std::string &name);
+
+        // Saves the persistent globals, and everything compiled so far, to a snapshot file.
+        void save(const std::string &path);
+
+        // Starts a fresh engine from a snapshot written by `save` instead of running the scripts again.
+        // Host functions are not saved: bind them again after restoring.
+        void restore(const std::string &path);
+
+        // Calls a closure or builtin, typically one looked up with `global`.
+        Object *call(Object &fn, const std::vector<Object *> &args);
+
+        // Calls the closure `fn` once per row and writes the i-th result to out[i], which must have room for
+        // one result per row. `rows` holds the arguments of each row in turn; `columns` holds one equally long
+        // span per parameter. Much cheaper than calling `call` in a loop: the call is set up only once.
+        // A function without parameters is called `nullaryRows` times.
+        void callRows(Object &fn, ArgSpan rows, Object **out, size_t nullaryRows = 0);
+
+        void callColumns(Object &fn, const std::vector<ArgSpan> &columns, Object **out, size_t nullaryRows = 0);
+
+        // Makes runs and calls that fail write the flight recorder of their VM to `path`, replacing what an
+        // earlier failure wrote there, or stops that if `path` is empty. FlightLog reads it back.
+        void writeFlightOnError(const std::string &path);
+
+    private:
+        Isolate isolate;
+        std::shared_ptr<SymbolTable> symbolTable;
+        // every script's constants start with those of the scripts compiled before it, so closures made by
+        // an earlier script still find their constants when they run under a later one
+        std::vector<Object *> constants;
+        std::shared_ptr<const ByteCode> latest;
+
+        // reused by `call` until another script is compiled
+        std::unique_ptr<VM> caller;
+        std::shared_ptr<const ByteCode> callerCode;
+        std::string flightPath;
+
+        VM &callerVM();
+    };
+}
+
+#endif //ENGINE_H
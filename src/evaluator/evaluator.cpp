@@ -8,19 +8,39 @@
 
 #include "../common/common.h"
 #include "../object/builtins.h"
+#include "../object/heap.h"
 #include "fmt/format.h"
 
-Boolean *Evaluator::True = new Boolean(true);
-Boolean *Evaluator::False = new Boolean(false);
-OBJ::Null *Evaluator::Null = new OBJ::Null();
+Boolean *const Evaluator::True = new Boolean(true);
+Boolean *const Evaluator::False = new Boolean(false);
+OBJ::Null *const Evaluator::Null = new OBJ::Null();
 
-std::map<std::string, Builtin *> Evaluator::builtins{
+const std::map<std::string, Builtin *> Evaluator::builtins{
     {"len", getBuiltinByName("len")},
     {"puts", getBuiltinByName("puts")},
     {"first", getBuiltinByName("first")},
     {"last", getBuiltinByName("last")},
     {"rest", getBuiltinByName("rest")},
     {"push", getBuiltinByName("push")},
+    {"set", getBuiltinByName("set")},
+    {"delete", getBuiltinByName("delete")},
+    {"range", getBuiltinByName("range")},
+    {"sum", getBuiltinByName("sum")},
+    {"min", getBuiltinByName("min")},
+    {"max", getBuiltinByName("max")},
+    {"dot", getBuiltinByName("dot")},
+    {"add", getBuiltinByName("add")},
+    {"mul", getBuiltinByName("mul")},
+    {"map", getBuiltinByName("map")},
+    {"filter", getBuiltinByName("filter")},
+    {"reduce", getBuiltinByName("reduce")},
+    {"each", getBuiltinByName("each")},
+    {"find", getBuiltinByName("find")},
+    {"pmap", getBuiltinByName("pmap")},
+    {"spawn", getBuiltinByName("spawn")},
+    {"chan", getBuiltinByName("chan")},
+    {"send", getBuiltinByName("send")},
+    {"recv", getBuiltinByName("recv")},
 };
 
 Object *Evaluator::Eval(Ast::Node &_node, Environment &env) {
@@ -42,7 +62,7 @@ Object *Evaluator::Eval(Ast::Node &_node, Environment &env) {
         if (isError(val)) {
             return val;
         }
-        return new ReturnValue(*val);
+        return make<ReturnValue>(*val);
     }
     if (instance_of<Ast::Node, Ast::LetStatement>(_node)) {
         const auto node = dynamic_cast<Ast::LetStatement *>(&_node);
@@ -54,11 +74,11 @@ Object *Evaluator::Eval(Ast::Node &_node, Environment &env) {
     }
     if (instance_of<Ast::Node, Ast::IntegerLiteral>(_node)) {
         const auto node = dynamic_cast<Ast::IntegerLiteral *>(&_node);
-        return new Integer(node->value);
+        return make<Integer>(node->value);
     }
     if (instance_of<Ast::Node, Ast::StringLiteral>(_node)) {
         const auto node = dynamic_cast<Ast::StringLiteral *>(&_node);
-        return new String(node->value);
+        return make<String>(node->value);
     }
     if (instance_of<Ast::Node, Ast::Boolean>(_node)) {
         const auto node = dynamic_cast<Ast::Boolean *>(&_node);
@@ -99,8 +119,9 @@ Object *Evaluator::Eval(Ast::Node &_node, Environment &env) {
         for (const auto &param: node->parameters) {
             params.push_back(std::make_shared<Ast::Identifier>(std::move(param)));
         }
-        return new Function(params, std::make_shared<Ast::BlockStatement>(std::move(*node->body)),
-                            std::shared_ptr<Environment>(&env));
+        // share the body rather than take it, since the literal may be evaluated again; the environment is only
+        // borrowed, it belongs to whoever made it
+        return make<Function>(params, node->body, std::shared_ptr<Environment>(std::shared_ptr<void>(), &env));
     }
     if (instance_of<Ast::Node, Ast::CallExpression>(_node)) {
         const auto node = dynamic_cast<Ast::CallExpression *>(&_node);
@@ -129,7 +150,7 @@ Object *Evaluator::Eval(Ast::Node &_node, Environment &env) {
             _elements.push_back(std::move(element.get()));
         }
         auto elements = this->evalExpressions(_elements, env);
-        return new Array(elements);
+        return make<Array>(elements);
     }
     if (instance_of<Ast::Node, Ast::IndexExpression>(_node)) {
         const auto node = dynamic_cast<Ast::IndexExpression *>(&_node);
@@ -240,7 +261,7 @@ Object *Evaluator::evalMinusPrefixOperatorExpression(Object &right) {
     }
 
     auto value = dynamic_cast<Integer *>(&right);
-    return new Integer(-value->value);
+    return make<Integer>(-value->value);
 }
 
 Object *Evaluator::evalIntegerInfixExpression(std::string &operator_, Object &left, Object &right) {
@@ -248,16 +269,16 @@ Object *Evaluator::evalIntegerInfixExpression(std::string &operator_, Object &le
     auto rightVal = dynamic_cast<Integer *>(&right)->value;
 
     if (operator_ == "+") {
-        return new Integer(leftVal + rightVal);
+        return make<Integer>(leftVal + rightVal);
     }
     if (operator_ == "-") {
-        return new Integer(leftVal - rightVal);
+        return make<Integer>(leftVal - rightVal);
     }
     if (operator_ == "*") {
-        return new Integer(leftVal * rightVal);
+        return make<Integer>(leftVal * rightVal);
     }
     if (operator_ == "/") {
-        return new Integer(leftVal / rightVal);
+        return make<Integer>(leftVal / rightVal);
     }
     if (operator_ == "<") {
         return nativeBoolToBooleanObject(leftVal < rightVal);
@@ -281,7 +302,7 @@ Object *Evaluator::evalStringInfixExpression(std::string &operator_, Object &lef
 
     const auto leftVal = dynamic_cast<String *>(&left)->value;
     const auto rightVal = dynamic_cast<String *>(&right)->value;
-    return new String(leftVal + rightVal);
+    return make<String>(leftVal + rightVal);
 }
 
 Object *Evaluator::evalIfExpression(Ast::IfExpression &ie, Environment &env) {
@@ -304,8 +325,8 @@ Object *Evaluator::evalIdentifier(Ast::Identifier &node, Environment &env) {
         return val;
     }
 
-    if (builtins.find(node.value) != builtins.end()) {
-        return builtins[node.value];
+    if (const auto builtin = builtins.find(node.value); builtin != builtins.end()) {
+        return builtin->second;
     }
 
     return newError("identifier not found: " + node.value);
@@ -326,7 +347,7 @@ bool Evaluator::isTruthy(Object &obj) {
 
 template<typename... Args>
 Error *Evaluator::newError(const std::string &format, Args... args) {
-    return new Error(fmt::format(format, args...));
+    return make<Error>(fmt::format(format, args...));
 }
 
 bool Evaluator::isError(Object *obj) {
@@ -349,7 +370,14 @@ std::vector<Object *> Evaluator::evalExpressions(std::vector<Ast::Expression *>
     return result;
 }
 
-Object *Evaluator::applyFunction(Object &_fn, std::vector<Object *> &args) {
+Object *Evaluator::callFunction(Object &fn, ArgSpan args) {
+    if (const auto result = this->applyFunction(fn, args); result != nullptr) {
+        return result;
+    }
+    return newError("not a function: {}", fn.type());
+}
+
+Object *Evaluator::applyFunction(Object &_fn, ArgSpan args) {
     if (instance_of<Object, Function>(_fn)) {
         const auto fn = dynamic_cast<Function *>(&_fn);
         const auto extendedEnv = this->extendFunctionEnv(*fn, args);
@@ -358,7 +386,7 @@ Object *Evaluator::applyFunction(Object &_fn, std::vector<Object *> &args) {
     }
     if (instance_of<Object, Builtin>(_fn)) {
         const auto fn = dynamic_cast<Builtin *>(&_fn);
-        if (const auto result = fn->fn(args); result != nullptr) {
+        if (const auto result = fn->call(args, *this); result != nullptr) {
             return result;
         }
         return Null;
@@ -366,8 +394,9 @@ Object *Evaluator::applyFunction(Object &_fn, std::vector<Object *> &args) {
     return nullptr;
 }
 
-Environment *Evaluator::extendFunctionEnv(const Function &fn, const std::vector<Object *> &args) {
+Environment *Evaluator::extendFunctionEnv(const Function &fn, ArgSpan args) {
     const auto env = new Environment(fn.env);
+    AllocStats::record("ENVIRONMENT", sizeof(Environment));
     for (auto i = 0; i < fn.parameters.size(); ++i) {
         env->set(fn.parameters[i].get()->value, *args[i]);
     }
@@ -392,8 +421,15 @@ Object *Evaluator::evalIndexExpression(Object &left, Object &index) {
 }
 
 Object *Evaluator::evalArrayIndexExpression(Object &array, Object &index) {
-    auto arrayObject = dynamic_cast<Array *>(&array);
     auto idx = dynamic_cast<Integer *>(&index)->value;
+    if (auto ints = dynamic_cast<IntArray *>(&array)) {
+        if (idx < 0 || idx >= static_cast<int64_t>(ints->values.size())) {
+            return Null;
+        }
+        return make<Integer>(ints->values[idx]);
+    }
+
+    auto arrayObject = dynamic_cast<Array *>(&array);
 
     if (idx < 0 || idx > static_cast<int64_t>(arrayObject->elements.size()) - 1) {
         return Null;
@@ -421,9 +457,9 @@ Object *Evaluator::evalHashLiteral(Ast::HashLiteral &node, Environment &env) {
         }
 
         auto hashed = hashKey->hash_key();
-        pairs.emplace(hashed, *new HashPair(*key, *value));
+        pairs.emplace(hashed, HashPair(*key, *value));
     }
-    return new Hash(pairs);
+    return make<Hash>(pairs);
 }
 
 Object *Evaluator::evalHashIndexExpression(Object &hash, Object &index) {
@@ -433,10 +469,10 @@ Object *Evaluator::evalHashIndexExpression(Object &hash, Object &index) {
         return newError("unusable as hash key: {}", index.type());
     }
 
-    auto hash_key = key->hash_key();
-    if (hashObject->pairs.find(key->hash_key()) == hashObject->pairs.end()) {
+    const auto hash_pair = hashObject->pairs().get(key->hash_key());
+    if (hash_pair == nullptr) {
         return Null;
     }
 
-    return hashObject->pairs[key->hash_key()].value;
+    return hash_pair->value;
 }
@@ -10,15 +10,18 @@
 #include "../object/environment.h"
 #include "../object/object.h"
 
-class Evaluator {
+class Evaluator final : public Caller {
 public:
-    static std::map<std::string, Builtin *> builtins;
-    static Boolean *True;
-    static Boolean *False;
-    static OBJ::Null *Null;
+    static const std::map<std::string, Builtin *> builtins;
+    // immutable singletons shared by every thread
+    static Boolean *const True;
+    static Boolean *const False;
+    static OBJ::Null *const Null;
 
     Object *Eval(Ast::Node &_node, Environment &env);
 
+    Object *callFunction(Object &fn, ArgSpan args) override;
+
 private:
     Object *evalProgram(Ast::Program &program, Environment &env);
 
@@ -51,9 +54,9 @@ private:
 
     std::vector<Object *> evalExpressions(std::vector<Ast::Expression *> &expressions, Environment &env);
 
-    Object *applyFunction(Object &_fn, std::vector<Object *> &args);
+    Object *applyFunction(Object &_fn, ArgSpan args);
 
-    Environment *extendFunctionEnv(const Function &fn, const std::vector<Object *> &args);
+    Environment *extendFunctionEnv(const Function &fn, ArgSpan args);
 
     Object *unwrapReturnValue(Object &obj);
 
@@ -16,6 +16,10 @@ void Lexer::skipWhitespace() {
 }
 
 void Lexer::readChar() {
+    if (this->ch == '\n') {
+        this->line++;
+        this->lineStart = this->readPosition;
+    }
     if (this->readPosition >= this->input.length()) {
         this->ch = 0;
     } else {
@@ -73,6 +77,7 @@ Token Lexer::nextToken() {
     Token token{};
 
     this->skipWhitespace();
+    const Position position{this->position, this->line, this->position - this->lineStart + 1};
 
     switch (this->ch) {
         case '=':
@@ -147,15 +152,20 @@ Token Lexer::nextToken() {
         default: {
             if (isLetter()) {
                 auto ident = this->readIdentifier();
-                return {lookupIdent(ident), ident};
+                token = {lookupIdent(ident), ident};
+                token.position = position;
+                return token;
             }
             if (isDigit()) {
-                return {INT, this->readNumber()};
+                token = {INT, this->readNumber()};
+                token.position = position;
+                return token;
             }
             token = {ILLEGAL, this->ch};
         }
     }
 
+    token.position = position;
     this->readChar();
     return token;
 }
@@ -14,6 +14,9 @@ class Lexer {
     int position;
     int readPosition;
     char ch{};
+    // line of `ch`, and the offset that line starts at
+    int line{1};
+    int lineStart{0};
 
     void skipWhitespace();
 
@@ -42,14 +45,18 @@ public:
         : input(other.input),
           position(other.position),
           readPosition(other.readPosition),
-          ch(other.ch) {
+          ch(other.ch),
+          line(other.line),
+          lineStart(other.lineStart) {
     }
 
     Lexer(Lexer &&other) noexcept
         : input(std::move(other.input)),
           position(other.position),
           readPosition(other.readPosition),
-          ch(other.ch) {
+          ch(other.ch),
+          line(other.line),
+          lineStart(other.lineStart) {
     }
 
     Lexer & operator=(const Lexer &other) {
@@ -59,6 +66,8 @@ public:
         position = other.position;
         readPosition = other.readPosition;
         ch = other.ch;
+        line = other.line;
+        lineStart = other.lineStart;
         return *this;
     }
 
@@ -69,6 +78,8 @@ public:
         position = other.position;
         readPosition = other.readPosition;
         ch = other.ch;
+        line = other.line;
+        lineStart = other.lineStart;
         return *this;
     }
 
@@ -0,0 +1,439 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "fmt/format.h"
+#include "../code/code.h"
+#include "../compiler/compiler.h"
+#include "../lexer/lexer.h"
+#include "../object/heap.h"
+#include "../parser/parser.h"
+#include "../vm/vm.h"
+
+// Measures the pipeline stage by stage: lexer and parser throughput, compiler speed and the cost of single
+// VM opcodes. Unlike src/benchmark, which times whole programs, a change here points at the stage it hits.
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        // run only the part of this name: lexer, parser, compiler or vm
+        std::string only;
+        // least time spent on each measurement
+        double seconds{0.2};
+    };
+
+    struct Input {
+        std::string name;
+        std::string source;
+    };
+
+    // Repeats `body` until `seconds` have passed and returns the seconds one call took.
+    // The first call is not timed, to warm up caches and the allocator.
+    double timePerCall(const double seconds, const std::function<void()> &body) {
+        body();
+        long calls = 0;
+        const auto start = Clock::now();
+        std::chrono::duration<double> elapsed{};
+        do {
+            body();
+            calls++;
+            elapsed = Clock::now() - start;
+        } while (elapsed.count() < seconds);
+        return elapsed.count() / static_cast<double>(calls);
+    }
+
+    std::string repeat(const std::string &s, const int times) {
+        std::string out;
+        out.reserve(s.size() * times);
+        for (auto i = 0; i < times; i++) {
+            out += s;
+        }
+        return out;
+    }
+
+    // Sources the front end struggles with, each in one piece: identifiers can't hold digits, and neither
+    // the constant pool nor the globals take more than 65535 entries, so the programs reuse one global.
+    std::vector<Input> inputs() {
+        std::vector<Input> inputs;
+        inputs.push_back({"statements", "let x = 1;\n" + repeat("x + x * x;\n", 100000)});
+        inputs.push_back({"parens", "let x = 1;\n" + repeat("(", 1000) + "x" + repeat(" + x)", 1000) + ";\n"});
+        inputs.push_back({"ifs", "let x = 1;\n" + repeat("if (x > 0) { ", 500) + "x" + repeat(" }", 500) + ";\n"});
+        inputs.push_back({"strings", repeat("\"" + std::string(1 << 20, 'a') + "\";\n", 4)});
+
+        std::string hash = "let h = {";
+        for (auto i = 0; i < 10000; i++) {
+            hash += fmt::format("{:s}\"k{:d}\": {:d}", i == 0 ? "" : ", ", i, i);
+        }
+        inputs.push_back({"hash", hash + "};\n"});
+
+        std::string functions;
+        for (auto i = 0; i < 2000; i++) {
+            functions += "let f = fn(a, b) { let c = a + b; if (c > 10) { return c; } c * 2 };\nf(1, 2);\n";
+        }
+        inputs.push_back({"functions", functions});
+        return inputs;
+    }
+
+    size_t countNodes(Ast::Node *node) {
+        if (node == nullptr) {
+            return 0;
+        }
+        size_t n = 1;
+        switch (node->typeID()) {
+            case Ast::Program_:
+                for (const auto &s: dynamic_cast<Ast::Program *>(node)->statements) {
+                    n += countNodes(s.get());
+                }
+                break;
+            case Ast::LetStatement_: {
+                const auto *let = dynamic_cast<Ast::LetStatement *>(node);
+                n += countNodes(let->name.get()) + countNodes(let->value.get());
+                break;
+            }
+            case Ast::ReturnStatement_:
+                n += countNodes(dynamic_cast<Ast::ReturnStatement *>(node)->returnValue.get());
+                break;
+            case Ast::ExpressionStatement_:
+                n += countNodes(dynamic_cast<Ast::ExpressionStatement *>(node)->expression.get());
+                break;
+            case Ast::BlockStatement_:
+                for (const auto &s: dynamic_cast<Ast::BlockStatement *>(node)->statements) {
+                    n += countNodes(s.get());
+                }
+                break;
+            case Ast::PrefixExpression_:
+                n += countNodes(dynamic_cast<Ast::PrefixExpression *>(node)->right.get());
+                break;
+            case Ast::InfixExpression_: {
+                const auto *infix = dynamic_cast<Ast::InfixExpression *>(node);
+                n += countNodes(infix->left.get()) + countNodes(infix->right.get());
+                break;
+            }
+            case Ast::IfExpression_: {
+                const auto *expr = dynamic_cast<Ast::IfExpression *>(node);
+                n += countNodes(expr->condition.get()) + countNodes(expr->consequence.get()) +
+                        countNodes(expr->alternative.get());
+                break;
+            }
+            case Ast::FunctionLiteral_: {
+                const auto *fn = dynamic_cast<Ast::FunctionLiteral *>(node);
+                n += fn->parameters.size() + countNodes(fn->body.get());
+                break;
+            }
+            case Ast::CallExpression_: {
+                const auto *call = dynamic_cast<Ast::CallExpression *>(node);
+                n += countNodes(call->function.get());
+                for (const auto &arg: call->arguments) {
+                    n += countNodes(arg.get());
+                }
+                break;
+            }
+            case Ast::ArrayLiteral_:
+                for (const auto &e: dynamic_cast<Ast::ArrayLiteral *>(node)->elements) {
+                    n += countNodes(e.get());
+                }
+                break;
+            case Ast::IndexExpression_: {
+                const auto *index = dynamic_cast<Ast::IndexExpression *>(node);
+                n += countNodes(index->left.get()) + countNodes(index->index.get());
+                break;
+            }
+            case Ast::HashLiteral_:
+                for (const auto &[_, pair]: dynamic_cast<Ast::HashLiteral *>(node)->pairs) {
+                    n += countNodes(pair.first.get()) + countNodes(pair.second.get());
+                }
+                break;
+            default:
+                break;
+        }
+        return n;
+    }
+
+    size_t countInstructions(const Instructions &ins) {
+        size_t n = 0;
+        for (size_t i = 0; i < ins.size(); n++) {
+            auto width = 1;
+            for (const auto w: lookup(static_cast<uint8_t>(ins[i]))->operandWidths) {
+                width += w;
+            }
+            i += width;
+        }
+        return n;
+    }
+
+    // instructions of the top level and of every function it compiled
+    size_t countInstructions(const ByteCode &code) {
+        auto n = countInstructions(code.instructions);
+        for (auto *constant: code.constants) {
+            if (const auto *fn = dynamic_cast<CompiledFunction *>(constant); fn != nullptr) {
+                n += countInstructions(fn->instructions);
+            }
+        }
+        return n;
+    }
+
+    std::unique_ptr<Ast::Program> parse(const std::string &source) {
+        Parser p{Lexer(source)};
+        auto program = p.parseProgram();
+        if (!p.errors().empty()) {
+            throw std::runtime_error("parser error: " + p.errors().front());
+        }
+        return program;
+    }
+
+    void benchLexer(const Options &options, const std::vector<Input> &inputs) {
+        std::cout << fmt::format("\n{:<12s}{:>12s}{:>12s}{:>12s}{:>14s}\n", "lexer", "bytes", "tokens", "MB/s",
+                                 "Mtokens/s");
+        for (const auto &input: inputs) {
+            size_t tokens = 0;
+            const auto seconds = timePerCall(options.seconds, [&] {
+                Lexer l(input.source);
+                tokens = 0;
+                while (l.nextToken().type != TokenType_t::EOF_) {
+                    tokens++;
+                }
+            });
+            std::cout << fmt::format("{:<12s}{:>12d}{:>12d}{:>12.1f}{:>14.2f}\n", input.name, input.source.size(),
+                                     tokens, input.source.size() / seconds / 1e6, tokens / seconds / 1e6);
+        }
+    }
+
+    // parse times include lexing, which the parser drives token by token
+    void benchParser(const Options &options, const std::vector<Input> &inputs) {
+        std::cout << fmt::format("\n{:<12s}{:>12s}{:>12s}{:>14s}\n", "parser", "nodes", "ms", "Mnodes/s");
+        for (const auto &input: inputs) {
+            const auto nodes = countNodes(parse(input.source).get());
+            const auto seconds = timePerCall(options.seconds, [&] { parse(input.source); });
+            std::cout << fmt::format("{:<12s}{:>12d}{:>12.3f}{:>14.2f}\n", input.name, nodes, seconds * 1e3,
+                                     nodes / seconds / 1e6);
+        }
+    }
+
+    void benchCompiler(const Options &options, const std::vector<Input> &inputs) {
+        std::cout << fmt::format("\n{:<12s}{:>12s}{:>12s}{:>14s}\n", "compiler", "instrs", "ms", "Minstrs/s");
+        for (const auto &input: inputs) {
+            const auto program = parse(input.source);
+            size_t instructions = 0;
+            const auto seconds = timePerCall(options.seconds, [&] {
+                Heap heap;
+                Heap::Scope scope(&heap);
+                Compiler comp;
+                comp.compile(program.get());
+                instructions = countInstructions(comp.byteCode());
+            });
+            std::cout << fmt::format("{:<12s}{:>12d}{:>12.3f}{:>14.2f}\n", input.name, instructions, seconds * 1e3,
+                                     instructions / seconds / 1e6);
+        }
+    }
+
+    // One instruction; a jump operand of `next` targets the instruction right after it.
+    struct Op {
+        OpCode code;
+        std::vector<int> operands{};
+    };
+
+    constexpr auto next = -1;
+
+    // Hand-assembled bytecode; jump targets are absolute offsets.
+    class Assembler {
+    public:
+        Instructions ins;
+
+        size_t here() const {
+            return this->ins.size();
+        }
+
+        size_t emit(const Op &op) {
+            const auto pos = this->here();
+            const auto bytes = Code::make(op.code, op.operands);
+            this->ins.insert(this->ins.end(), bytes.begin(), bytes.end());
+            if (!op.operands.empty() && op.operands.front() == next) {
+                this->patch(pos, this->here());
+            }
+            return pos;
+        }
+
+        void emit(const std::vector<Op> &ops) {
+            for (const auto &op: ops) {
+                this->emit(op);
+            }
+        }
+
+        void patch(const size_t pos, const size_t target) {
+            putUint16BE(this->ins, pos + 1, static_cast<uint16_t>(target));
+        }
+    };
+
+    // constants and globals the patterns use
+    enum Constant { Zero, One, Key, Fn, Count, NumConstants };
+
+    enum Global { Counter, Int, Arr, Closure_ };
+
+    // A few instructions around the one measured, leaving the stack as they found it.
+    struct Pattern {
+        std::string name;
+        std::vector<Op> ops;
+        // instructions run by the function it calls
+        int callee{0};
+
+        int length() const {
+            return static_cast<int>(this->ops.size()) + this->callee;
+        }
+    };
+
+    const std::vector<Pattern> &patterns() {
+        static const std::vector<Pattern> patterns{
+            {"OpNull", {{OpCode::OpNull}, {OpCode::OpPop}}},
+            {"OpTrue", {{OpCode::OpTrue}, {OpCode::OpPop}}},
+            {"OpConstant", {{OpCode::OpConstant, {One}}, {OpCode::OpPop}}},
+            {"OpGetGlobal", {{OpCode::OpGetGlobal, {Int}}, {OpCode::OpPop}}},
+            {"OpSetGlobal", {{OpCode::OpConstant, {One}}, {OpCode::OpSetGlobal, {Int}}}},
+            {"OpGetBuiltin", {{OpCode::OpGetBuiltin, {0}}, {OpCode::OpPop}}},
+            {"OpJump", {{OpCode::OpJump, {next}}}},
+            {"OpJumpNotTruthy", {{OpCode::OpTrue}, {OpCode::OpJumpNotTruthy, {next}}}},
+            {"OpAdd", {{OpCode::OpConstant, {One}}, {OpCode::OpConstant, {One}}, {OpCode::OpAdd}, {OpCode::OpPop}}},
+            {"OpEqual", {{OpCode::OpConstant, {One}}, {OpCode::OpConstant, {One}}, {OpCode::OpEqual}, {OpCode::OpPop}}},
+            {
+                "OpGreaterThan", {
+                    {OpCode::OpConstant, {One}}, {OpCode::OpConstant, {Zero}}, {OpCode::OpGreaterThan}, {OpCode::OpPop}
+                }
+            },
+            {"OpMinus", {{OpCode::OpConstant, {One}}, {OpCode::OpMinus}, {OpCode::OpPop}}},
+            {"OpBang", {{OpCode::OpTrue}, {OpCode::OpBang}, {OpCode::OpPop}}},
+            {
+                "OpArray", {
+                    {OpCode::OpConstant, {One}}, {OpCode::OpConstant, {One}}, {OpCode::OpArray, {2}}, {OpCode::OpPop}
+                }
+            },
+            {
+                "OpHash", {
+                    {OpCode::OpConstant, {Key}}, {OpCode::OpConstant, {One}}, {OpCode::OpHash, {2}}, {OpCode::OpPop}
+                }
+            },
+            {
+                "OpIndex", {
+                    {OpCode::OpGetGlobal, {Arr}}, {OpCode::OpConstant, {Zero}}, {OpCode::OpIndex}, {OpCode::OpPop}
+                }
+            },
+            // the callee runs OpConstant and OpReturnValue
+            {"OpCall", {{OpCode::OpGetGlobal, {Closure_}}, {OpCode::OpCall, {0}}, {OpCode::OpPop}}, 2},
+            {
+                "OpCall len", {
+                    {OpCode::OpGetBuiltin, {0}}, {OpCode::OpGetGlobal, {Arr}}, {OpCode::OpCall, {1}}, {OpCode::OpPop}
+                }
+            },
+        };
+        return patterns;
+    }
+
+    // A loop running `pattern`, if any, `unroll` times per iteration until the counter global drops to zero.
+    ByteCode loopOf(const Pattern *pattern, const int unroll, const int iterations) {
+        Assembler a;
+        a.emit({{OpCode::OpConstant, {Count}}, {OpCode::OpSetGlobal, {Counter}}});
+        a.emit({{OpCode::OpConstant, {One}}, {OpCode::OpSetGlobal, {Int}}});
+        a.emit({{OpCode::OpConstant, {Zero}}, {OpCode::OpConstant, {One}}});
+        a.emit({{OpCode::OpArray, {2}}, {OpCode::OpSetGlobal, {Arr}}});
+        a.emit({{OpCode::OpClosure, {Fn, 0}}, {OpCode::OpSetGlobal, {Closure_}}});
+
+        const auto loop = a.here();
+        a.emit({{OpCode::OpGetGlobal, {Counter}}, {OpCode::OpConstant, {Zero}}, {OpCode::OpGreaterThan}});
+        const auto exit = a.emit({OpCode::OpJumpNotTruthy, {0}});
+        for (auto i = 0; pattern != nullptr && i < unroll; i++) {
+            a.emit(pattern->ops);
+        }
+        a.emit({{OpCode::OpGetGlobal, {Counter}}, {OpCode::OpConstant, {One}}});
+        a.emit({{OpCode::OpSub}, {OpCode::OpSetGlobal, {Counter}}});
+        a.emit({OpCode::OpJump, {static_cast<int>(loop)}});
+        a.patch(exit, a.here());
+        a.emit({{OpCode::OpNull}, {OpCode::OpPop}});
+
+        Assembler fn;
+        fn.emit({{OpCode::OpConstant, {One}}, {OpCode::OpReturnValue}});
+
+        std::vector<Object *> constants(NumConstants);
+        constants[Zero] = new Integer(0);
+        constants[One] = new Integer(1);
+        constants[Key] = new String("k");
+        constants[Fn] = new CompiledFunction(fn.ins);
+        constants[Count] = new Integer(iterations);
+        return {a.ins, constants};
+    }
+
+    double timeLoop(const Options &options, const ByteCode &code) {
+        return timePerCall(options.seconds, [&] {
+            Heap heap;
+            Heap::Scope scope(&heap);
+            VM machine(code);
+            machine.run();
+        });
+    }
+
+    // The cost of a pattern is that of a loop running it, less that of the same loop left empty.
+    // Operands are decoded from a copy of the rest of the function, so the unrolled loop is kept short
+    // and run again at a larger unroll: ns/instr growing with it shows that cost.
+    void benchVm(const Options &options) {
+        constexpr auto iterations = 10000;
+        constexpr int unrolls[] = {8, 64};
+        std::cout << fmt::format("\n{:<16s}{:>8s}{:>12s}{:>12s}{:>14s}\n", "vm", "unroll", "ns/pattern",
+                                 "ns/instr", "Minstrs/s");
+        for (const auto unroll: unrolls) {
+            const auto empty = timeLoop(options, loopOf(nullptr, unroll, iterations));
+            for (const auto &pattern: patterns()) {
+                const auto seconds = timeLoop(options, loopOf(&pattern, unroll, iterations)) - empty;
+                const auto perPattern = seconds / (static_cast<double>(iterations) * unroll);
+                std::cout << fmt::format("{:<16s}{:>8d}{:>12.2f}{:>12.2f}{:>14.1f}\n", pattern.name, unroll,
+                                         perPattern * 1e9, perPattern / pattern.length() * 1e9,
+                                         pattern.length() / perPattern / 1e6);
+            }
+        }
+    }
+
+    bool parseOptions(const int argc, char *argv[], Options &options) {
+        for (auto i = 1; i < argc; i++) {
+            const std::string arg = argv[i];
+            if (arg == "lexer" || arg == "parser" || arg == "compiler" || arg == "vm") {
+                options.only = arg;
+            } else if (arg.rfind("--seconds=", 0) == 0) {
+                options.seconds = std::stod(arg.substr(10));
+            } else {
+                std::cerr << "usage: microbench [lexer|parser|compiler|vm] [--seconds=<per measurement>]"
+                        << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    const auto sources = inputs();
+    try {
+        if (options.only.empty() || options.only == "lexer") {
+            benchLexer(options, sources);
+        }
+        if (options.only.empty() || options.only == "parser") {
+            benchParser(options, sources);
+        }
+        if (options.only.empty() || options.only == "compiler") {
+            benchCompiler(options, sources);
+        }
+        if (options.only.empty() || options.only == "vm") {
+            benchVm(options);
+        }
+    } catch (const std::runtime_error &err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
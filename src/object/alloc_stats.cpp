@@ -0,0 +1,121 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "alloc_stats.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "fmt/format.h"
+
+const char *const AllocStats::noSite = "(other)";
+
+namespace {
+    template<typename K>
+    std::vector<std::pair<K, AllocStats::Count> > byBytes(const std::map<K, AllocStats::Count> &counts) {
+        std::vector<std::pair<K, AllocStats::Count> > sorted(counts.begin(), counts.end());
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+            return a.second.bytes > b.second.bytes;
+        });
+        return sorted;
+    }
+
+    template<typename K>
+    std::string countsJson(const std::map<K, AllocStats::Count> &counts) {
+        std::string entries;
+        for (const auto &[key, count]: counts) {
+            entries += fmt::format(R"({:s}"{:s}":{{"objects":{:d},"bytes":{:d}}})", entries.empty() ? "" : ",",
+                                   key, count.objects, count.bytes);
+        }
+        return "{" + entries + "}";
+    }
+}
+
+AllocStats::Scope::Scope(AllocStats *stats) : previous(installed) {
+    installed = stats;
+}
+
+AllocStats::Scope::~Scope() {
+    installed = this->previous;
+}
+
+AllocStats::Site::Site(const char *name) : previous(site) {
+    site = name;
+}
+
+AllocStats::Site::~Site() {
+    site = this->previous;
+}
+
+void AllocStats::add(const std::string &kind, const size_t bytes) {
+    auto &count = this->counts[{site != nullptr ? site : noSite, kind}];
+    count.objects++;
+    count.bytes += bytes;
+}
+
+std::map<std::string, AllocStats::Count> AllocStats::byKind() const {
+    std::map<std::string, Count> kinds;
+    for (const auto &[key, count]: this->counts) {
+        kinds[key.second] += count;
+    }
+    return kinds;
+}
+
+std::map<std::string, AllocStats::Count> AllocStats::bySite() const {
+    std::map<std::string, Count> sites;
+    for (const auto &[key, count]: this->counts) {
+        sites[key.first] += count;
+    }
+    return sites;
+}
+
+std::map<std::pair<std::string, std::string>, AllocStats::Count> AllocStats::bySiteAndKind() const {
+    std::map<std::pair<std::string, std::string>, Count> pairs;
+    for (const auto &[key, count]: this->counts) {
+        pairs[{key.first, key.second}] += count;
+    }
+    return pairs;
+}
+
+AllocStats::Count AllocStats::total() const {
+    Count total;
+    for (const auto &[_, count]: this->counts) {
+        total += count;
+    }
+    return total;
+}
+
+void AllocStats::report(std::ostream &out, const size_t top) const {
+    const auto total = this->total();
+    const auto table = [&](const std::string &title, const auto &rows) {
+        out << fmt::format("{:<22s}{:>14s}{:>16s}{:>8s}\n", title, "objects", "bytes", "share");
+        for (const auto &[name, count]: rows) {
+            out << fmt::format("{:<22s}{:>14d}{:>16d}{:>7.2f}%\n", name, count.objects, count.bytes,
+                               total.bytes == 0 ? 0.0 : 100.0 * count.bytes / total.bytes);
+        }
+        out << "\n";
+    };
+    table("kind", byBytes(this->byKind()));
+    table("site", byBytes(this->bySite()));
+
+    auto pairs = byBytes(this->bySiteAndKind());
+    if (pairs.size() > top) {
+        pairs.resize(top);
+    }
+    std::vector<std::pair<std::string, Count> > rows;
+    for (const auto &[key, count]: pairs) {
+        rows.emplace_back(key.first + " " + key.second, count);
+    }
+    table("site kind", rows);
+}
+
+std::string AllocStats::toJson() const {
+    std::string pairs;
+    for (const auto &[key, count]: this->bySiteAndKind()) {
+        pairs += fmt::format(R"({:s}["{:s}","{:s}",{:d},{:d}])", pairs.empty() ? "" : ",", key.first, key.second,
+                             count.objects, count.bytes);
+    }
+    return fmt::format(R"({{"kinds":{:s},"sites":{:s},"pairs":[{:s}]}})", countsJson(this->byKind()),
+                       countsJson(this->bySite()), pairs);
+}
@@ -0,0 +1,105 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef ALLOC_STATS_H
+#define ALLOC_STATS_H
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+
+// Counts the runtime allocations of the calling thread while installed: objects from `make`, evaluator
+// environments and hash trie nodes, by kind (the object's type) and by site, the opcode or builtin that
+// was running. Compiled constants and allocations on other threads, e.g. `pmap` workers, are not counted.
+class AllocStats {
+public:
+    struct Count {
+        uint64_t objects{0};
+        uint64_t bytes{0};
+
+        Count &operator+=(const Count &other) {
+            this->objects += other.objects;
+            this->bytes += other.bytes;
+            return *this;
+        }
+    };
+
+    // allocations outside any opcode or builtin, e.g. by the host or the tree-walking evaluator
+    static const char *const noSite;
+
+    // Installs `stats` on the calling thread until the scope ends.
+    class Scope {
+        AllocStats *previous;
+
+    public:
+        explicit Scope(AllocStats *stats);
+
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    // Attributes the calling thread's allocations to `name`, which must outlive the stats, until the scope ends.
+    class Site {
+        const char *previous;
+
+    public:
+        explicit Site(const char *name);
+
+        ~Site();
+
+        Site(const Site &) = delete;
+
+        Site &operator=(const Site &) = delete;
+    };
+
+    static bool active() {
+        return installed != nullptr;
+    }
+
+    // Sets the site without restoring it: the VM calls this for each instruction while stats are active.
+    static void at(const char *name) {
+        site = name;
+    }
+
+    static void record(const std::string &kind, const size_t bytes) {
+        if (installed != nullptr) {
+            installed->add(kind, bytes);
+        }
+    }
+
+    // for the kinds that are no Object, without building the name unless stats are active
+    static void record(const char *kind, const size_t bytes) {
+        if (installed != nullptr) {
+            installed->add(kind, bytes);
+        }
+    }
+
+    std::map<std::string, Count> byKind() const;
+
+    std::map<std::string, Count> bySite() const;
+
+    std::map<std::pair<std::string, std::string>, Count> bySiteAndKind() const;
+
+    Count total() const;
+
+    // Tables by kind and by site, most bytes first, then the `top` largest site and kind pairs.
+    void report(std::ostream &out, size_t top = 20) const;
+
+    std::string toJson() const;
+
+private:
+    // by (site, kind); sites are told apart by address, they are all static names
+    std::map<std::pair<const char *, std::string>, Count> counts;
+
+    static inline thread_local AllocStats *installed{nullptr};
+    static inline thread_local const char *site{nullptr};
+
+    void add(const std::string &kind, size_t bytes);
+};
+
+#endif //ALLOC_STATS_H
@@ -0,0 +1,34 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef BUDGET_H
+#define BUDGET_H
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Limits for a single execution. A zero field means no limit.
+struct Budget {
+    // instructions executed; checked at calls and backward jumps, so straight-line code may run slightly past it
+    uint64_t instructions{0};
+    // bytes allocated through `make` on the executing thread
+    size_t heapBytes{0};
+    // wall-clock time from the start of the execution
+    std::chrono::steady_clock::duration time{};
+};
+
+// Raised when an execution runs out of its `Budget`.
+class BudgetExceeded final : public std::runtime_error {
+public:
+    enum class Limit { Instructions, Heap, Time };
+
+    const Limit limit;
+
+    BudgetExceeded(const Limit limit, const std::string &message) : std::runtime_error(message), limit(limit) {
+    }
+};
+
+#endif //BUDGET_H
@@ -4,37 +4,166 @@
 
 #include "builtins.h"
 
+#include <algorithm>
 #include <array>
 #include <complex>
 
+#include "heap.h"
+#include "simd.h"
+#include "../runtime/scheduler.h"
+#include "../runtime/thread_pool.h"
 #include "../common/common.h"
 #include "fmt/format.h"
 
-Object *monkey_len(const std::vector<Object *> &args) {
+namespace {
+    // Views an ARRAY argument as contiguous int64s: IntArrays are used in place,
+    // boxed arrays are unboxed into `scratch`. Returns false if any element is not an INTEGER.
+    bool intValues(Object *arg, std::vector<int64_t> &scratch, const int64_t *&data, size_t &size) {
+        if (auto *ints = dynamic_cast<IntArray *>(arg)) {
+            data = ints->values.data();
+            size = ints->values.size();
+            return true;
+        }
+        auto *array = dynamic_cast<Array *>(arg);
+        if (array == nullptr) {
+            return false;
+        }
+        scratch.clear();
+        scratch.reserve(array->elements.size());
+        for (auto *element: array->elements) {
+            auto *integer = dynamic_cast<Integer *>(element);
+            if (integer == nullptr) {
+                return false;
+            }
+            scratch.push_back(integer->value);
+        }
+        data = scratch.data();
+        size = scratch.size();
+        return true;
+    }
+
+    using ReduceKernel = int64_t(*)(const int64_t *, size_t);
+    using ZipKernel = void(*)(const int64_t *, const int64_t *, int64_t *, size_t);
+
+    Object *reduceInts(ArgSpan args, const std::string &name,
+                       const ReduceKernel kernel, const bool emptyIsNull) {
+        if (args.size() != 1) {
+            return newError("wrong number of arguments. got={:d}, want=1",
+                            args.size());
+        }
+        std::vector<int64_t> scratch;
+        const int64_t *data{nullptr};
+        size_t size{0};
+        if (!intValues(args[0], scratch, data, size)) {
+            return newError("argument to `{:s}` must be ARRAY of INTEGER, got {:s}",
+                            name, args[0]->type());
+        }
+        if (size == 0 && emptyIsNull) {
+            return nullptr;
+        }
+        return make<Integer>(kernel(data, size));
+    }
+
+    Object *zipInts(ArgSpan args, const std::string &name, const ZipKernel kernel) {
+        if (args.size() != 2) {
+            return newError("wrong number of arguments. got={:d}, want=2",
+                            args.size());
+        }
+        std::vector<int64_t> scratchA, scratchB;
+        const int64_t *a{nullptr}, *b{nullptr};
+        size_t sizeA{0}, sizeB{0};
+        if (!intValues(args[0], scratchA, a, sizeA) || !intValues(args[1], scratchB, b, sizeB)) {
+            return newError("arguments to `{:s}` must be ARRAY of INTEGER, got {:s} and {:s}",
+                            name, args[0]->type(), args[1]->type());
+        }
+        if (sizeA != sizeB) {
+            return newError("arguments to `{:s}` must have the same length, got {:d} and {:d}",
+                            name, sizeA, sizeB);
+        }
+        std::vector<int64_t> out(sizeA);
+        kernel(a, b, out.data(), sizeA);
+        return make<IntArray>(std::move(out));
+    }
+
+    size_t arrayLength(Object *array) {
+        if (auto *ints = dynamic_cast<IntArray *>(array)) {
+            return ints->values.size();
+        }
+        return dynamic_cast<Array *>(array)->elements.size();
+    }
+
+    Object *arrayElement(Object *array, const size_t i) {
+        if (auto *ints = dynamic_cast<IntArray *>(array)) {
+            return make<Integer>(ints->values[i]);
+        }
+        return dynamic_cast<Array *>(array)->elements[i];
+    }
+
+    bool isCallable(Object *obj) {
+        const auto type = obj->type();
+        return type == CLOSURE_OBJ || type == FUNCTION_OBJ || type == BUILTIN_OBJ;
+    }
+
+    bool isTruthy(Object *obj) {
+        if (obj == nullptr || obj->type() == NULL_OBJ) {
+            return false;
+        }
+        if (auto *boolean = dynamic_cast<Boolean *>(obj)) {
+            return boolean->value;
+        }
+        return true;
+    }
+
+    bool isError(Object *obj) {
+        return obj != nullptr && obj->type() == ERROR_OBJ;
+    }
+
+    // shared argument check for the (array, fn) higher-order builtins
+    Error *checkArrayAndFunction(ArgSpan args, const std::string &name) {
+        if (args.size() != 2) {
+            return newError("wrong number of arguments. got={:d}, want=2",
+                            args.size());
+        }
+        if (args[0]->type() != ARRAY_OBJ) {
+            return newError("argument to `{:s}` must be ARRAY, got {:s}",
+                            name, args[0]->type());
+        }
+        if (!isCallable(args[1])) {
+            return newError("argument to `{:s}` must be FUNCTION, got {:s}",
+                            name, args[1]->type());
+        }
+        return nullptr;
+    }
+}
+
+Object *monkey_len(ArgSpan args) {
     if (args.size() != 1) {
         return newError("wrong number of arguments. got={:d}, want=1",
                         args.size());
     }
     if (auto* str = dynamic_cast<String*>(args[0])) {
-        return new Integer(static_cast<int64_t>(str->value.size()));
+        return make<Integer>(static_cast<int64_t>(str->value.size()));
     }
     if (auto* array = dynamic_cast<Array*>(args[0])) {
-        return new Integer(static_cast<int64_t>(array->elements.size()));
+        return make<Integer>(static_cast<int64_t>(array->elements.size()));
+    }
+    if (auto* ints = dynamic_cast<IntArray*>(args[0])) {
+        return make<Integer>(static_cast<int64_t>(ints->values.size()));
     }
     return newError("argument to `len` not supported, got {:s}",
                     args[0]->type());
 }
 
-Object *monkey_puts(const std::vector<Object *> &args) {
+Object *monkey_puts(ArgSpan args) {
     for (const auto &arg: args) {
         fmt::println(arg->inspect());
     }
     return nullptr;
 }
 
-Object *monkey_first(const std::vector<Object *> &args) {
+Object *monkey_first(ArgSpan args) {
     if (args.size() != 1) {
-        return new Error("wrong number of arguments. got=" + std::to_string(args.size()) + ", want=1");
+        return make<Error>("wrong number of arguments. got=" + std::to_string(args.size()) + ", want=1");
     }
 
     if (auto *array = dynamic_cast<Array *>(args[0])) {
@@ -43,11 +172,17 @@ Object *monkey_first(const std::vector<Object *> &args) {
         }
         return array->elements[0];
     }
+    if (auto *ints = dynamic_cast<IntArray *>(args[0])) {
+        if (ints->values.empty()) {
+            return nullptr;
+        }
+        return make<Integer>(ints->values[0]);
+    }
     return newError("argument to `first` must be ARRAY, got {:s}",
                     args[0]->type());
 }
 
-Object *monkey_last(const std::vector<Object *> &args) {
+Object *monkey_last(ArgSpan args) {
     if (args.size() != 1) {
         return newError("wrong number of arguments. got={:d}, want=1",
                         args.size());
@@ -56,6 +191,12 @@ Object *monkey_last(const std::vector<Object *> &args) {
         return newError("argument to `last` must be ARRAY, got {:s}",
                         args[0]->type());
     }
+    if (auto *ints = dynamic_cast<IntArray *>(args[0])) {
+        if (!ints->values.empty()) {
+            return make<Integer>(ints->values.back());
+        }
+        return nullptr;
+    }
     auto *array = dynamic_cast<Array *>(args[0]);
     if (!array->elements.empty()) {
         return array->elements.back();
@@ -63,7 +204,7 @@ Object *monkey_last(const std::vector<Object *> &args) {
     return nullptr;
 }
 
-Object *monkey_rest(const std::vector<Object *> &args) {
+Object *monkey_rest(ArgSpan args) {
     if (args.size() != 1) {
         return newError("wrong number of arguments. got={:d}, want=1",
                         args.size());
@@ -72,15 +213,21 @@ Object *monkey_rest(const std::vector<Object *> &args) {
         return newError("argument to `rest` must be ARRAY, got {:s}",
                         args[0]->type());
     }
+    if (auto *ints = dynamic_cast<IntArray *>(args[0])) {
+        if (!ints->values.empty()) {
+            return make<IntArray>(std::vector<int64_t>(ints->values.begin() + 1, ints->values.end()));
+        }
+        return nullptr;
+    }
     auto *array = dynamic_cast<Array *>(args[0]);
     if (!array->elements.empty()) {
         const std::vector elements(array->elements.begin() + 1, array->elements.end());
-        return new Array(elements);
+        return make<Array>(elements);
     }
     return nullptr;
 }
 
-Object *monkey_push(const std::vector<Object *> &args) {
+Object *monkey_push(ArgSpan args) {
     if (args.size() != 2) {
         return newError("wrong number of arguments. got={:d}, want=2",
                         args.size());
@@ -89,15 +236,342 @@ Object *monkey_push(const std::vector<Object *> &args) {
         return newError("argument to `push` must be ARRAY, got {:s}",
                         args[0]->type());
     }
+    if (auto *ints = dynamic_cast<IntArray *>(args[0])) {
+        if (auto *integer = dynamic_cast<Integer *>(args[1])) {
+            auto values = ints->values;
+            values.push_back(integer->value);
+            return make<IntArray>(values);
+        }
+        // a non-integer element turns the result back into a boxed array
+        std::vector<Object *> elements;
+        elements.reserve(ints->values.size() + 1);
+        for (const auto value: ints->values) {
+            elements.push_back(make<Integer>(value));
+        }
+        elements.push_back(args[1]);
+        return make<Array>(elements);
+    }
     auto *array = dynamic_cast<Array *>(args[0]);
     auto elements = array->elements;
     elements.push_back(args[1]);
-    return new Array(elements);
+    return make<Array>(elements);
+}
+
+Object *monkey_set(ArgSpan args) {
+    if (args.size() != 3) {
+        return newError("wrong number of arguments. got={:d}, want=3",
+                        args.size());
+    }
+    if (args[0]->type() != HASH_OBJ) {
+        return newError("argument to `set` must be HASH, got {:s}",
+                        args[0]->type());
+    }
+    auto *key = dynamic_cast<Hashable *>(args[1]);
+    if (key == nullptr) {
+        return newError("unusable as hash key: {:s}", args[1]->type());
+    }
+    auto *hash = dynamic_cast<Hash *>(args[0]);
+
+    // overwriting an existing field keeps the record's shape so cached field loads stay valid
+    if (auto *str = dynamic_cast<String *>(args[1]); str != nullptr && hash->shape != nullptr) {
+        if (const auto slot = hash->shape->slotOf(str->value); slot >= 0) {
+            auto slots = hash->slots;
+            slots[slot] = args[2];
+            return make<Hash>(*hash->shape, slots);
+        }
+    }
+    return make<Hash>(hash->pairs().set(key->hash_key(), HashPair(*args[1], *args[2])));
+}
+
+Object *monkey_delete(ArgSpan args) {
+    if (args.size() != 2) {
+        return newError("wrong number of arguments. got={:d}, want=2",
+                        args.size());
+    }
+    if (args[0]->type() != HASH_OBJ) {
+        return newError("argument to `delete` must be HASH, got {:s}",
+                        args[0]->type());
+    }
+    auto *key = dynamic_cast<Hashable *>(args[1]);
+    if (key == nullptr) {
+        return newError("unusable as hash key: {:s}", args[1]->type());
+    }
+    auto *hash = dynamic_cast<Hash *>(args[0]);
+    return make<Hash>(hash->pairs().remove(key->hash_key()));
+}
+
+Object *monkey_range(ArgSpan args) {
+    if (args.empty() || args.size() > 2) {
+        return newError("wrong number of arguments. got={:d}, want=1 or 2",
+                        args.size());
+    }
+    for (auto *arg: args) {
+        if (arg->type() != INTEGER_OBJ) {
+            return newError("argument to `range` must be INTEGER, got {:s}",
+                            arg->type());
+        }
+    }
+    const auto start = args.size() == 1 ? 0 : dynamic_cast<Integer *>(args[0])->value;
+    const auto end = dynamic_cast<Integer *>(args.back())->value;
+    std::vector<int64_t> values;
+    if (end > start) {
+        values.reserve(static_cast<size_t>(end - start));
+        for (auto i = start; i < end; i++) {
+            values.push_back(i);
+        }
+    }
+    return make<IntArray>(std::move(values));
+}
+
+Object *monkey_sum(ArgSpan args) {
+    return reduceInts(args, "sum", &Simd::sum, false);
+}
+
+Object *monkey_min(ArgSpan args) {
+    return reduceInts(args, "min", &Simd::min, true);
+}
+
+Object *monkey_max(ArgSpan args) {
+    return reduceInts(args, "max", &Simd::max, true);
+}
+
+Object *monkey_dot(ArgSpan args) {
+    if (args.size() != 2) {
+        return newError("wrong number of arguments. got={:d}, want=2",
+                        args.size());
+    }
+    std::vector<int64_t> scratchA, scratchB;
+    const int64_t *a{nullptr}, *b{nullptr};
+    size_t sizeA{0}, sizeB{0};
+    if (!intValues(args[0], scratchA, a, sizeA) || !intValues(args[1], scratchB, b, sizeB)) {
+        return newError("arguments to `dot` must be ARRAY of INTEGER, got {:s} and {:s}",
+                        args[0]->type(), args[1]->type());
+    }
+    if (sizeA != sizeB) {
+        return newError("arguments to `dot` must have the same length, got {:d} and {:d}",
+                        sizeA, sizeB);
+    }
+    return make<Integer>(Simd::dot(a, b, sizeA));
+}
+
+Object *monkey_add(ArgSpan args) {
+    return zipInts(args, "add", &Simd::add);
+}
+
+Object *monkey_mul(ArgSpan args) {
+    return zipInts(args, "mul", &Simd::mul);
+}
+
+// The higher-order builtins call `caller.callFunction` once per element with a single reused
+// argument vector and reserve the result up front, so no intermediate arrays are built.
+
+Object *monkey_map(ArgSpan args, Caller &caller) {
+    if (auto *err = checkArrayAndFunction(args, "map")) {
+        return err;
+    }
+    const auto size = arrayLength(args[0]);
+    std::vector<Object *> elements;
+    elements.reserve(size);
+    std::vector<Object *> callArgs(1);
+    for (size_t i = 0; i < size; i++) {
+        callArgs[0] = arrayElement(args[0], i);
+        auto *result = caller.callFunction(*args[1], callArgs);
+        if (isError(result)) {
+            return result;
+        }
+        elements.push_back(result);
+    }
+    return make<Array>(std::move(elements));
+}
+
+Object *monkey_filter(ArgSpan args, Caller &caller) {
+    if (auto *err = checkArrayAndFunction(args, "filter")) {
+        return err;
+    }
+    const auto size = arrayLength(args[0]);
+    std::vector<Object *> elements;
+    elements.reserve(size);
+    std::vector<Object *> callArgs(1);
+    for (size_t i = 0; i < size; i++) {
+        callArgs[0] = arrayElement(args[0], i);
+        auto *result = caller.callFunction(*args[1], callArgs);
+        if (isError(result)) {
+            return result;
+        }
+        if (isTruthy(result)) {
+            elements.push_back(callArgs[0]);
+        }
+    }
+    return make<Array>(std::move(elements));
+}
+
+Object *monkey_reduce(ArgSpan args, Caller &caller) {
+    if (args.size() != 3) {
+        return newError("wrong number of arguments. got={:d}, want=3",
+                        args.size());
+    }
+    if (args[0]->type() != ARRAY_OBJ) {
+        return newError("argument to `reduce` must be ARRAY, got {:s}",
+                        args[0]->type());
+    }
+    if (!isCallable(args[2])) {
+        return newError("argument to `reduce` must be FUNCTION, got {:s}",
+                        args[2]->type());
+    }
+    const auto size = arrayLength(args[0]);
+    std::vector<Object *> callArgs{args[1], nullptr};
+    for (size_t i = 0; i < size; i++) {
+        callArgs[1] = arrayElement(args[0], i);
+        auto *result = caller.callFunction(*args[2], callArgs);
+        if (isError(result)) {
+            return result;
+        }
+        callArgs[0] = result;
+    }
+    return callArgs[0];
+}
+
+Object *monkey_each(ArgSpan args, Caller &caller) {
+    if (auto *err = checkArrayAndFunction(args, "each")) {
+        return err;
+    }
+    const auto size = arrayLength(args[0]);
+    std::vector<Object *> callArgs(1);
+    for (size_t i = 0; i < size; i++) {
+        callArgs[0] = arrayElement(args[0], i);
+        if (auto *result = caller.callFunction(*args[1], callArgs); isError(result)) {
+            return result;
+        }
+    }
+    return nullptr;
+}
+
+Object *monkey_find(ArgSpan args, Caller &caller) {
+    if (auto *err = checkArrayAndFunction(args, "find")) {
+        return err;
+    }
+    const auto size = arrayLength(args[0]);
+    std::vector<Object *> callArgs(1);
+    for (size_t i = 0; i < size; i++) {
+        callArgs[0] = arrayElement(args[0], i);
+        auto *result = caller.callFunction(*args[1], callArgs);
+        if (isError(result)) {
+            return result;
+        }
+        if (isTruthy(result)) {
+            return callArgs[0];
+        }
+    }
+    return nullptr;
+}
+
+Object *monkey_pmap(ArgSpan args, Caller &caller) {
+    if (auto *err = checkArrayAndFunction(args, "pmap")) {
+        return err;
+    }
+    auto &pool = ThreadPool::shared();
+    const auto size = arrayLength(args[0]);
+    // a few chunks per worker so stealing can even out elements of uneven cost
+    const auto numChunks = std::min(size, pool.size() * 4);
+
+    // purity is checked once, and even for an empty array, so it never depends on the input
+    std::string error;
+    const auto isolates = caller.isolates(*args[1], numChunks, error);
+    if (!error.empty()) {
+        return newError("argument to `pmap` must be a pure function: {:s}", error);
+    }
+    if (isolates.size() < numChunks) {
+        return monkey_map(args, caller);
+    }
+
+    std::vector<Object *> elements(size);
+    std::vector<Object *> errors(numChunks);
+    // workers allocate into private heaps that the caller's heap takes over afterwards
+    auto *heap = Heap::current();
+    std::vector<Heap> chunkHeaps(heap != nullptr ? numChunks : 0);
+    pool.parallelFor(numChunks, [&](const size_t chunk) {
+        Heap::Scope scope(heap != nullptr ? &chunkHeaps[chunk] : nullptr);
+        const auto begin = size * chunk / numChunks;
+        const auto end = size * (chunk + 1) / numChunks;
+        std::vector<Object *> callArgs(1);
+        for (auto i = begin; i < end; i++) {
+            callArgs[0] = arrayElement(args[0], i);
+            auto *result = isolates[chunk]->callFunction(*args[1], callArgs);
+            if (isError(result)) {
+                errors[chunk] = result;
+                return;
+            }
+            elements[i] = result;
+        }
+    });
+    for (auto &chunkHeap: chunkHeaps) {
+        heap->adopt(chunkHeap);
+    }
+
+    for (auto *error: errors) {
+        if (error != nullptr) {
+            return error;
+        }
+    }
+    return make<Array>(std::move(elements));
+}
+
+Object *monkey_spawn(ArgSpan args, Caller &caller) {
+    if (args.empty()) {
+        return newError("wrong number of arguments. got={:d}, want=at least 1", args.size());
+    }
+    if (!isCallable(args[0])) {
+        return newError("argument to `spawn` must be FUNCTION, got {:s}", args[0]->type());
+    }
+    std::string error;
+    caller.spawn(*args[0], ArgSpan(args.begin() + 1, args.size() - 1), error);
+    if (!error.empty()) {
+        return newError("{:s}", error);
+    }
+    return nullptr;
+}
+
+Object *monkey_chan(ArgSpan args) {
+    if (!args.empty()) {
+        return newError("wrong number of arguments. got={:d}, want=0", args.size());
+    }
+    return make<Channel>();
+}
+
+Object *monkey_send(ArgSpan args) {
+    if (args.size() != 2) {
+        return newError("wrong number of arguments. got={:d}, want=2", args.size());
+    }
+    auto *channel = dynamic_cast<Channel *>(args[0]);
+    if (channel == nullptr) {
+        return newError("argument to `send` must be CHANNEL, got {:s}", args[0]->type());
+    }
+    channel->send(*args[1]);
+    return nullptr;
+}
+
+Object *monkey_recv(ArgSpan args, Caller &caller) {
+    if (args.size() != 1) {
+        return newError("wrong number of arguments. got={:d}, want=1", args.size());
+    }
+    auto *channel = dynamic_cast<Channel *>(args[0]);
+    if (channel == nullptr) {
+        return newError("argument to `recv` must be CHANNEL, got {:s}", args[0]->type());
+    }
+    if (auto *value = channel->tryReceive()) {
+        return value;
+    }
+    std::string error;
+    auto *value = caller.receive(*channel, error);
+    if (!error.empty()) {
+        return newError("{:s}", error);
+    }
+    return value;
 }
 
 template<typename... Args>
 Error *newError(const std::string &format, Args &&... args) {
-    return new Error{fmt::format(format, std::forward<Args>(args)...)};
+    return make<Error>(fmt::format(format, std::forward<Args>(args)...));
 }
 
 Builtin *getBuiltinByName(const std::string &name) {
@@ -108,3 +582,12 @@ Builtin *getBuiltinByName(const std::string &name) {
     }
     return nullptr;
 }
+
+const char *getBuiltinName(const Builtin &builtin) {
+    for (const auto &[name, fn]: builtins) {
+        if (fn == &builtin) {
+            return name.c_str();
+        }
+    }
+    return "native";
+}
@@ -11,25 +11,84 @@
 
 #include "object.h"
 
-Object *monkey_len(const std::vector<Object*>& args);
+Object *monkey_len(ArgSpan args);
 
-Object *monkey_puts(const std::vector<Object* > &args);
+Object *monkey_puts(ArgSpan args);
 
-Object *monkey_first(const std::vector<Object*>& args);
+Object *monkey_first(ArgSpan args);
 
-Object *monkey_last(const std::vector<Object*>& args);
+Object *monkey_last(ArgSpan args);
 
-Object *monkey_rest(const std::vector<Object*>& args);
+Object *monkey_rest(ArgSpan args);
 
-Object *monkey_push(const std::vector<Object*>& args);
+Object *monkey_push(ArgSpan args);
 
-inline std::vector<std::pair<std::string, Builtin *> > builtins = {
+Object *monkey_set(ArgSpan args);
+
+Object *monkey_delete(ArgSpan args);
+
+Object *monkey_range(ArgSpan args);
+
+Object *monkey_sum(ArgSpan args);
+
+Object *monkey_min(ArgSpan args);
+
+Object *monkey_max(ArgSpan args);
+
+Object *monkey_dot(ArgSpan args);
+
+Object *monkey_add(ArgSpan args);
+
+Object *monkey_mul(ArgSpan args);
+
+Object *monkey_map(ArgSpan args, Caller &caller);
+
+Object *monkey_filter(ArgSpan args, Caller &caller);
+
+Object *monkey_reduce(ArgSpan args, Caller &caller);
+
+Object *monkey_each(ArgSpan args, Caller &caller);
+
+Object *monkey_find(ArgSpan args, Caller &caller);
+
+Object *monkey_pmap(ArgSpan args, Caller &caller);
+
+Object *monkey_spawn(ArgSpan args, Caller &caller);
+
+Object *monkey_chan(ArgSpan args);
+
+Object *monkey_send(ArgSpan args);
+
+Object *monkey_recv(ArgSpan args, Caller &caller);
+
+// Shared by every VM and thread; never modified after static initialization.
+inline const std::vector<std::pair<std::string, Builtin *> > builtins = {
     {"len", new Builtin(&monkey_len)},
-    {"puts", new Builtin(&monkey_puts)},
+    {"puts", new Builtin(&monkey_puts, false)},
     {"first", new Builtin(&monkey_first)},
     {"last", new Builtin(&monkey_last)},
     {"rest", new Builtin(&monkey_rest)},
     {"push", new Builtin(&monkey_push)},
+    {"set", new Builtin(&monkey_set)},
+    {"delete", new Builtin(&monkey_delete)},
+    {"range", new Builtin(&monkey_range)},
+    {"sum", new Builtin(&monkey_sum)},
+    {"min", new Builtin(&monkey_min)},
+    {"max", new Builtin(&monkey_max)},
+    {"dot", new Builtin(&monkey_dot)},
+    {"add", new Builtin(&monkey_add)},
+    {"mul", new Builtin(&monkey_mul)},
+    {"map", new Builtin(&monkey_map)},
+    {"filter", new Builtin(&monkey_filter)},
+    {"reduce", new Builtin(&monkey_reduce)},
+    {"each", new Builtin(&monkey_each)},
+    {"find", new Builtin(&monkey_find)},
+    {"pmap", new Builtin(&monkey_pmap)},
+    // channels are thread-safe, so tasks and `pmap` may use them
+    {"spawn", new Builtin(&monkey_spawn)},
+    {"chan", new Builtin(&monkey_chan)},
+    {"send", new Builtin(&monkey_send)},
+    {"recv", new Builtin(&monkey_recv)},
 };
 
 template<typename... Args>
@@ -37,4 +96,7 @@ Error *newError(const std::string &format, Args &&... args);
 
 Builtin *getBuiltinByName(const std::string &name);
 
+// name the builtin is bound to, or "native" for bindings made outside `builtins`
+const char *getBuiltinName(const Builtin &builtin);
+
 #endif //BUILTINS_H
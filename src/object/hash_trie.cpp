@@ -0,0 +1,329 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "hash_trie.h"
+
+#include "alloc_stats.h"
+#include "object.h"
+
+namespace {
+    constexpr int BITS_PER_LEVEL = 5;
+    constexpr uint64_t LEVEL_MASK = (1u << BITS_PER_LEVEL) - 1;
+    constexpr int HASH_BITS = 64;
+
+    uint64_t hashOf(const HashKey &key) {
+        return std::hash<HashKey>{}(key);
+    }
+
+    uint32_t fragment(const uint64_t hash, const int shift) {
+        return static_cast<uint32_t>(hash >> shift & LEVEL_MASK);
+    }
+
+    int popcount(uint32_t bits) {
+        auto count = 0;
+        while (bits != 0) {
+            bits &= bits - 1;
+            count++;
+        }
+        return count;
+    }
+}
+
+struct HashTrie::Node {
+    struct Entry {
+        uint64_t hash{};
+        // exactly one of `child` and `leaf` is set
+        std::shared_ptr<const Node> child;
+        std::shared_ptr<const value_type> leaf;
+    };
+
+    // bitmap-indexed node: bit i set <=> entries holds the slot for hash fragment i, in fragment order.
+    // collision nodes hold leaves whose full 64-bit hashes are identical and ignore the bitmap.
+    uint32_t bitmap{0};
+    bool collision{false};
+    std::vector<Entry> entries;
+
+    size_t indexOf(const uint32_t bit) const {
+        return popcount(this->bitmap & (bit - 1));
+    }
+};
+
+using Node = HashTrie::Node;
+using NodePtr = std::shared_ptr<const Node>;
+
+namespace {
+    template<typename... Args>
+    std::shared_ptr<Node> newNode(Args &&... args) {
+        auto node = std::make_shared<Node>(std::forward<Args>(args)...);
+        AllocStats::record("HASH_NODE", sizeof(Node) + node->entries.capacity() * sizeof(Node::Entry));
+        return node;
+    }
+
+    NodePtr merge(const Node::Entry &a, const Node::Entry &b, const int shift) {
+        auto node = newNode();
+        if (shift >= HASH_BITS) {
+            node->collision = true;
+            node->entries = {a, b};
+            return node;
+        }
+
+        const auto fa = fragment(a.hash, shift);
+        const auto fb = fragment(b.hash, shift);
+        if (fa == fb) {
+            node->bitmap = 1u << fa;
+            node->entries.push_back({a.hash, merge(a, b, shift + BITS_PER_LEVEL), nullptr});
+            return node;
+        }
+
+        node->bitmap = 1u << fa | 1u << fb;
+        if (fa < fb) {
+            node->entries = {a, b};
+        } else {
+            node->entries = {b, a};
+        }
+        return node;
+    }
+
+    NodePtr insertLeaf(const NodePtr &node, const Node::Entry &leaf, const int shift, bool &added) {
+        if (node == nullptr) {
+            auto fresh = newNode();
+            fresh->bitmap = 1u << fragment(leaf.hash, shift);
+            fresh->entries.push_back(leaf);
+            added = true;
+            return fresh;
+        }
+
+        auto copy = newNode(*node);
+        if (node->collision) {
+            for (auto &entry: copy->entries) {
+                if (entry.leaf->first == leaf.leaf->first) {
+                    entry = leaf;
+                    return copy;
+                }
+            }
+            copy->entries.push_back(leaf);
+            added = true;
+            return copy;
+        }
+
+        const auto bit = 1u << fragment(leaf.hash, shift);
+        const auto index = node->indexOf(bit);
+        if ((node->bitmap & bit) == 0) {
+            copy->bitmap |= bit;
+            copy->entries.insert(copy->entries.begin() + index, leaf);
+            added = true;
+            return copy;
+        }
+
+        auto &entry = copy->entries[index];
+        if (entry.child != nullptr) {
+            entry.child = insertLeaf(entry.child, leaf, shift + BITS_PER_LEVEL, added);
+        } else if (entry.leaf->first == leaf.leaf->first) {
+            entry = leaf;
+        } else {
+            entry = {leaf.hash, merge(entry, leaf, shift + BITS_PER_LEVEL), nullptr};
+            added = true;
+        }
+        return copy;
+    }
+
+    NodePtr removeKey(const NodePtr &node, const HashKey &key, const uint64_t hash, const int shift, bool &removed) {
+        size_t index{0};
+        if (node->collision) {
+            while (index < node->entries.size() && !(node->entries[index].leaf->first == key)) {
+                index++;
+            }
+            if (index == node->entries.size()) {
+                return node;
+            }
+        } else {
+            const auto bit = 1u << fragment(hash, shift);
+            if ((node->bitmap & bit) == 0) {
+                return node;
+            }
+            index = node->indexOf(bit);
+        }
+
+        auto copy = newNode(*node);
+        auto &entry = copy->entries[index];
+        if (entry.child != nullptr) {
+            auto child = removeKey(entry.child, key, hash, shift + BITS_PER_LEVEL, removed);
+            if (!removed) {
+                return node;
+            }
+            if (child != nullptr) {
+                // a sub-trie shrunk to a single leaf is pulled up into this node
+                if (child->entries.size() == 1 && child->entries[0].leaf != nullptr) {
+                    entry = child->entries[0];
+                } else {
+                    entry.child = child;
+                }
+                return copy;
+            }
+        } else if (!(entry.leaf->first == key)) {
+            return node;
+        }
+
+        removed = true;
+        copy->entries.erase(copy->entries.begin() + index);
+        if (!copy->collision) {
+            copy->bitmap &= ~(1u << fragment(hash, shift));
+        }
+        if (copy->entries.empty()) {
+            return nullptr;
+        }
+        return copy;
+    }
+}
+
+HashTrie::HashTrie(std::shared_ptr<const Node> root, const size_t count)
+    : root(std::move(root)), count(count) {
+}
+
+size_t HashTrie::size() const {
+    return this->count;
+}
+
+bool HashTrie::empty() const {
+    return this->count == 0;
+}
+
+HashTrie::const_iterator HashTrie::begin() const {
+    const_iterator it{};
+    if (this->root != nullptr) {
+        it.path.emplace_back(this->root.get(), 0);
+        it.settle();
+    }
+    return it;
+}
+
+HashTrie::const_iterator HashTrie::end() const {
+    return {};
+}
+
+HashTrie::const_iterator HashTrie::find(const HashKey &key) const {
+    const auto hash = hashOf(key);
+    const_iterator it{};
+    auto node = this->root.get();
+    auto shift = 0;
+    while (node != nullptr) {
+        if (node->collision) {
+            for (size_t i = 0; i < node->entries.size(); i++) {
+                if (node->entries[i].leaf->first == key) {
+                    it.path.emplace_back(node, i);
+                    return it;
+                }
+            }
+            return {};
+        }
+
+        const auto bit = 1u << fragment(hash, shift);
+        if ((node->bitmap & bit) == 0) {
+            return {};
+        }
+        const auto index = node->indexOf(bit);
+        it.path.emplace_back(node, index);
+
+        const auto &entry = node->entries[index];
+        if (entry.child == nullptr) {
+            if (entry.leaf->first == key) {
+                return it;
+            }
+            return {};
+        }
+        node = entry.child.get();
+        shift += BITS_PER_LEVEL;
+    }
+    return {};
+}
+
+const HashPair *HashTrie::get(const HashKey &key) const {
+    const auto hash = hashOf(key);
+    auto node = this->root.get();
+    auto shift = 0;
+    while (node != nullptr) {
+        if (node->collision) {
+            for (const auto &entry: node->entries) {
+                if (entry.leaf->first == key) {
+                    return &entry.leaf->second;
+                }
+            }
+            return nullptr;
+        }
+
+        const auto bit = 1u << fragment(hash, shift);
+        if ((node->bitmap & bit) == 0) {
+            return nullptr;
+        }
+
+        const auto &entry = node->entries[node->indexOf(bit)];
+        if (entry.child == nullptr) {
+            return entry.leaf->first == key ? &entry.leaf->second : nullptr;
+        }
+        node = entry.child.get();
+        shift += BITS_PER_LEVEL;
+    }
+    return nullptr;
+}
+
+HashTrie HashTrie::set(const HashKey &key, const HashPair &pair) const {
+    const Node::Entry leaf{hashOf(key), nullptr, std::make_shared<const value_type>(key, pair)};
+    AllocStats::record("HASH_PAIR", sizeof(value_type));
+    auto added = false;
+    auto root = insertLeaf(this->root, leaf, 0, added);
+    return {std::move(root), added ? this->count + 1 : this->count};
+}
+
+HashTrie HashTrie::remove(const HashKey &key) const {
+    if (this->root == nullptr) {
+        return *this;
+    }
+    auto removed = false;
+    auto root = removeKey(this->root, key, hashOf(key), 0, removed);
+    if (!removed) {
+        return *this;
+    }
+    return {std::move(root), this->count - 1};
+}
+
+void HashTrie::const_iterator::settle() {
+    while (!this->path.empty()) {
+        auto &[node, index] = this->path.back();
+        if (index >= node->entries.size()) {
+            this->path.pop_back();
+            if (!this->path.empty()) {
+                this->path.back().second++;
+            }
+            continue;
+        }
+        if (const auto &child = node->entries[index].child; child != nullptr) {
+            this->path.emplace_back(child.get(), 0);
+            continue;
+        }
+        return;
+    }
+}
+
+const HashTrie::value_type &HashTrie::const_iterator::operator*() const {
+    const auto &[node, index] = this->path.back();
+    return *node->entries[index].leaf;
+}
+
+const HashTrie::value_type *HashTrie::const_iterator::operator->() const {
+    return &**this;
+}
+
+HashTrie::const_iterator &HashTrie::const_iterator::operator++() {
+    this->path.back().second++;
+    this->settle();
+    return *this;
+}
+
+bool HashTrie::const_iterator::operator==(const const_iterator &other) const {
+    return this->path == other.path;
+}
+
+bool HashTrie::const_iterator::operator!=(const const_iterator &other) const {
+    return !(*this == other);
+}
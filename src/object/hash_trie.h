@@ -0,0 +1,72 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef HASH_TRIE_H
+#define HASH_TRIE_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+struct HashKey;
+struct HashPair;
+
+// Persistent hash array mapped trie backing `Hash`.
+// Every update returns a new trie that shares all untouched nodes with the old one,
+// so `set`/`delete` cost O(log32 n) node copies instead of a full map copy.
+class HashTrie {
+public:
+    using value_type = std::pair<const HashKey, HashPair>;
+
+    struct Node;
+
+    class const_iterator {
+        friend class HashTrie;
+
+        // depth-first cursor: (node, entry index) for every level we descended into
+        std::vector<std::pair<const Node *, size_t> > path;
+
+        void settle();
+
+    public:
+        const_iterator() = default;
+
+        const value_type &operator*() const;
+
+        const value_type *operator->() const;
+
+        const_iterator &operator++();
+
+        bool operator==(const const_iterator &other) const;
+
+        bool operator!=(const const_iterator &other) const;
+    };
+
+    HashTrie() = default;
+
+    size_t size() const;
+
+    bool empty() const;
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+    const_iterator find(const HashKey &key) const;
+
+    const HashPair *get(const HashKey &key) const;
+
+    HashTrie set(const HashKey &key, const HashPair &pair) const;
+
+    HashTrie remove(const HashKey &key) const;
+
+private:
+    std::shared_ptr<const Node> root;
+    size_t count{0};
+
+    HashTrie(std::shared_ptr<const Node> root, size_t count);
+};
+
+#endif //HASH_TRIE_H
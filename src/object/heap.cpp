@@ -0,0 +1,51 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "heap.h"
+
+#include <algorithm>
+
+namespace {
+    thread_local Heap *currentHeap{nullptr};
+}
+
+size_t Heap::size() const {
+    return this->objects.size();
+}
+
+void Heap::track(Object *object) {
+    this->objects.emplace_back(object);
+}
+
+void Heap::adopt(Heap &other) {
+    this->objects.reserve(this->objects.size() + other.objects.size());
+    for (auto &object: other.objects) {
+        this->objects.push_back(std::move(object));
+    }
+    other.objects.clear();
+}
+
+Heap *Heap::current() {
+    return currentHeap;
+}
+
+void Heap::overQuota() {
+    throw BudgetExceeded(BudgetExceeded::Limit::Heap, "heap quota exceeded");
+}
+
+Heap::Quota::Quota(const size_t bytes) : previous(byteLimit) {
+    byteLimit = std::min(this->previous, allocatedBytes + bytes);
+}
+
+Heap::Quota::~Quota() {
+    byteLimit = this->previous;
+}
+
+Heap::Scope::Scope(Heap *heap) : previous(currentHeap) {
+    currentHeap = heap;
+}
+
+Heap::Scope::~Scope() {
+    currentHeap = this->previous;
+}
@@ -0,0 +1,116 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef HEAP_H
+#define HEAP_H
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "alloc_stats.h"
+#include "budget.h"
+#include "object.h"
+
+// Owns the objects allocated through `make` while it is the calling thread's current heap.
+// Dropping the heap frees all of them at once. Objects made with no current heap
+// (compiled constants, singletons, anything outside an isolate) live for the whole process.
+// A heap is only ever used by one thread at a time.
+class Heap {
+public:
+    Heap() = default;
+
+    Heap(const Heap &) = delete;
+
+    Heap &operator=(const Heap &) = delete;
+
+    size_t size() const;
+
+    void track(Object *object);
+
+    // takes ownership of everything `other` holds, e.g. the results produced by `pmap` workers
+    void adopt(Heap &other);
+
+    static Heap *current();
+
+    // Counts `bytes` against the calling thread's quota, throwing BudgetExceeded once it is used up.
+    static void charge(const size_t bytes) {
+        if ((allocatedBytes += bytes) > byteLimit) {
+            overQuota();
+        }
+    }
+
+    // Bytes charged on the calling thread so far.
+    static size_t allocated() {
+        return allocatedBytes;
+    }
+
+    // Allows the calling thread `bytes` more bytes of allocation until the scope ends.
+    // Allocations made by other threads, e.g. `pmap` workers, are not counted.
+    class Quota {
+        size_t previous;
+
+    public:
+        explicit Quota(size_t bytes);
+
+        ~Quota();
+
+        Quota(const Quota &) = delete;
+
+        Quota &operator=(const Quota &) = delete;
+    };
+
+    // Makes `heap` the current heap of the calling thread until the scope ends.
+    class Scope {
+        Heap *previous;
+
+    public:
+        explicit Scope(Heap *heap);
+
+        ~Scope();
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+    };
+
+private:
+    std::vector<std::unique_ptr<Object> > objects;
+
+    static inline thread_local size_t allocatedBytes{0};
+    static inline thread_local size_t byteLimit{SIZE_MAX};
+
+    [[noreturn]] static void overQuota();
+};
+
+// approximate bytes held by `object`, counting the buffers of the variable-sized kinds
+template<typename T>
+size_t footprint(const T &object) {
+    if constexpr (std::is_same_v<T, String>) {
+        return sizeof(T) + object.value.capacity();
+    } else if constexpr (std::is_same_v<T, Array>) {
+        return sizeof(T) + object.elements.capacity() * sizeof(Object *);
+    } else if constexpr (std::is_same_v<T, IntArray>) {
+        return sizeof(T) + object.values.capacity() * sizeof(int64_t);
+    } else {
+        return sizeof(T);
+    }
+}
+
+template<typename T, typename... Args>
+T *make(Args &&... args) {
+    auto *object = new T(std::forward<Args>(args)...);
+    if (auto *heap = Heap::current(); heap != nullptr) {
+        heap->track(object);
+    }
+    const auto bytes = footprint(*object);
+    Heap::charge(bytes);
+    if (AllocStats::active()) {
+        AllocStats::record(object->type(), bytes);
+    }
+    return object;
+}
+
+#endif //HEAP_H
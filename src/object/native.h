@@ -0,0 +1,169 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef NATIVE_H
+#define NATIVE_H
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "heap.h"
+#include "object.h"
+#include "fmt/format.h"
+
+// Typed bindings for host functions.
+//
+//     int64_t score(int64_t base, std::string_view tier);
+//     engine.bind("score", bindNative<&score>());
+//
+// bindNative<Fn> instantiates a builtin that checks the argument count and types and unboxes the arguments
+// straight from the caller's ArgSpan, then boxes the return value; there is no per-call dispatch on types.
+// Supported parameter types: int64_t, bool, std::string_view, std::string and Object *.
+// Supported return types: the same, plus void (returns null).
+// the VM's singletons, which it compares booleans against by pointer; defined in vm.cpp
+Boolean *nativeBoolToBooleanObject(bool input);
+
+namespace Native {
+    template<typename T>
+    struct Arg;
+
+    template<>
+    struct Arg<int64_t> {
+        static constexpr const char *type = "INTEGER";
+
+        static bool from(Object *obj, int64_t &out) {
+            const auto integer = dynamic_cast<Integer *>(obj);
+            if (integer == nullptr) {
+                return false;
+            }
+            out = integer->value;
+            return true;
+        }
+
+        static Object *to(const int64_t value) {
+            return make<Integer>(value);
+        }
+    };
+
+    template<>
+    struct Arg<bool> {
+        static constexpr const char *type = "BOOLEAN";
+
+        static bool from(Object *obj, bool &out) {
+            const auto boolean = dynamic_cast<Boolean *>(obj);
+            if (boolean == nullptr) {
+                return false;
+            }
+            out = boolean->value;
+            return true;
+        }
+
+        static Object *to(const bool value) {
+            return nativeBoolToBooleanObject(value);
+        }
+    };
+
+    template<>
+    struct Arg<std::string_view> {
+        static constexpr const char *type = "STRING";
+
+        // views the String's storage; valid for the duration of the call
+        static bool from(Object *obj, std::string_view &out) {
+            const auto str = dynamic_cast<String *>(obj);
+            if (str == nullptr) {
+                return false;
+            }
+            out = str->value;
+            return true;
+        }
+
+        static Object *to(const std::string_view value) {
+            return make<String>(std::string(value));
+        }
+    };
+
+    template<>
+    struct Arg<std::string> {
+        static constexpr const char *type = "STRING";
+
+        static bool from(Object *obj, std::string &out) {
+            const auto str = dynamic_cast<String *>(obj);
+            if (str == nullptr) {
+                return false;
+            }
+            out = str->value;
+            return true;
+        }
+
+        static Object *to(std::string value) {
+            return make<String>(std::move(value));
+        }
+    };
+
+    template<>
+    struct Arg<Object *> {
+        static constexpr const char *type = "ANY";
+
+        static bool from(Object *obj, Object *&out) {
+            out = obj;
+            return true;
+        }
+
+        static Object *to(Object *value) {
+            return value;
+        }
+    };
+
+    template<auto Fn, typename Signature = decltype(Fn)>
+    struct Binding;
+
+    template<auto Fn, typename R, typename... Params>
+    struct Binding<Fn, R(*)(Params...)> {
+        static Object *call(const ArgSpan args) {
+            if (args.size() != sizeof...(Params)) {
+                return make<Error>(fmt::format("wrong number of arguments. got={:d}, want={:d}",
+                                               args.size(), sizeof...(Params)));
+            }
+            return invoke(args, std::index_sequence_for<Params...>{});
+        }
+
+    private:
+        template<size_t... I>
+        static Object *invoke([[maybe_unused]] const ArgSpan args, std::index_sequence<I...>) {
+            std::tuple<std::decay_t<Params>...> values;
+            Object *error = nullptr;
+            // converts left to right and stops at the first mismatch
+            static_cast<void>((((error = convert<I>(args[I], std::get<I>(values))) == nullptr) && ...));
+            if (error != nullptr) {
+                return error;
+            }
+
+            if constexpr (std::is_void_v<R>) {
+                Fn(std::get<I>(values)...);
+                return nullptr;
+            } else {
+                return Arg<std::decay_t<R> >::to(Fn(std::get<I>(values)...));
+            }
+        }
+
+        template<size_t I, typename T>
+        static Object *convert(Object *obj, T &out) {
+            if (Arg<T>::from(obj, out)) {
+                return nullptr;
+            }
+            return make<Error>(fmt::format("argument {:d} must be {:s}, got {:s}",
+                                           I + 1, Arg<T>::type, obj->type()));
+        }
+    };
+}
+
+// Host functions are assumed to touch host state, so they are impure (rejected by `pmap`) unless marked otherwise.
+template<auto Fn>
+Builtin *bindNative(const bool pure = false) {
+    return new Builtin(&Native::Binding<Fn>::call, pure);
+}
+
+#endif //NATIVE_H
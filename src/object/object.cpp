@@ -4,6 +4,11 @@
 
 #include "object.h"
 
+#include <mutex>
+#include <optional>
+
+#include "alloc_stats.h"
+#include "builtins.h"
 #include "fmt/format.h"
 
 ObjectType Integer::inspect() {
@@ -91,6 +96,17 @@ std::string Builtin::inspect() {
     return "builtin function";
 }
 
+Object *Builtin::call(const ArgSpan args, Caller &caller) const {
+    std::optional<AllocStats::Site> site;
+    if (AllocStats::active()) {
+        site.emplace(getBuiltinName(*this));
+    }
+    if (this->callbackFn != nullptr) {
+        return this->callbackFn(args, caller);
+    }
+    return this->fn(args);
+}
+
 ObjectType Array::type() {
     return ARRAY_OBJ;
 }
@@ -104,13 +120,21 @@ std::string Array::inspect() {
     return fmt::format("[{}]", fmt::join(elements_str, ", "));
 }
 
+ObjectType IntArray::type() {
+    return ARRAY_OBJ;
+}
+
+std::string IntArray::inspect() {
+    return fmt::format("[{}]", fmt::join(values, ", "));
+}
+
 ObjectType Hash::type() {
     return HASH_OBJ;
 }
 
 std::string Hash::inspect() {
     std::vector<std::string> pairs_str;
-    for (const auto &[_, pair]: pairs) {
+    for (const auto &[_, pair]: this->pairs()) {
         pairs_str.push_back(
             fmt::format("{}: {}",
                         pair.key->inspect(),
@@ -120,6 +144,47 @@ std::string Hash::inspect() {
     return fmt::format("{{{}}}", fmt::join(pairs_str, ", "));
 }
 
+Shape::Shape(const std::vector<String *> &keys) : keys(keys) {
+    for (size_t i = 0; i < keys.size(); i++) {
+        this->hashKeys.push_back(keys[i]->hash_key());
+        this->slots[keys[i]->value] = static_cast<int>(i);
+    }
+}
+
+int Shape::slotOf(const std::string &key) const {
+    const auto it = this->slots.find(key);
+    if (it == this->slots.end()) {
+        return -1;
+    }
+    return it->second;
+}
+
+ObjectType Shape::type() {
+    return SHAPE_OBJ;
+}
+
+std::string Shape::inspect() {
+    std::vector<std::string> keys_str;
+    for (auto *key: keys) {
+        keys_str.push_back(key->inspect());
+    }
+
+    return fmt::format("Shape[{}]", fmt::join(keys_str, ", "));
+}
+
+void Hash::buildPairs() const {
+    // a record may be shared between tasks on different threads
+    static std::mutex mutex;
+    std::lock_guard lock(mutex);
+    if (this->built.load(std::memory_order_relaxed)) {
+        return;
+    }
+    for (size_t i = 0; i < this->slots.size(); i++) {
+        this->trie = this->trie.set(this->shape->hashKeys[i], HashPair(*this->shape->keys[i], *this->slots[i]));
+    }
+    this->built.store(true, std::memory_order_release);
+}
+
 ObjectType CompiledFunction::type() {
     return COMPILED_FUNCTION_OBJ;
 }
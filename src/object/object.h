@@ -7,32 +7,40 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include <atomic>
 #include <memory>
 #include <functional>
+#include <initializer_list>
 #include <unordered_map>
 #include "../ast/ast.h"
 #include "../code/code.h"
+#include "../code/line_table.h"
+#include "hash_trie.h"
 
 using ObjectType = std::string;
 
-inline ObjectType NULL_OBJ = "NULL";
-inline ObjectType ERROR_OBJ = "ERROR";
+inline const ObjectType NULL_OBJ = "NULL";
+inline const ObjectType ERROR_OBJ = "ERROR";
 
-inline ObjectType INTEGER_OBJ = "INTEGER";
-inline ObjectType BOOLEAN_OBJ = "BOOLEAN";
-inline ObjectType STRING_OBJ = "STRING";
+inline const ObjectType INTEGER_OBJ = "INTEGER";
+inline const ObjectType BOOLEAN_OBJ = "BOOLEAN";
+inline const ObjectType STRING_OBJ = "STRING";
 
-inline ObjectType RETURN_VALUE_OBJ = "RETURN_VALUE";
+inline const ObjectType RETURN_VALUE_OBJ = "RETURN_VALUE";
 
-inline ObjectType FUNCTION_OBJ = "FUNCTION";
-inline ObjectType BUILTIN_OBJ = "BUILTIN";
-inline ObjectType COMPILED_FUNCTION_OBJ = "COMPILED_FUNCTION_OBJ";
-inline ObjectType CLOSURE_OBJ = "CLOSURE";
+inline const ObjectType FUNCTION_OBJ = "FUNCTION";
+inline const ObjectType BUILTIN_OBJ = "BUILTIN";
+inline const ObjectType COMPILED_FUNCTION_OBJ = "COMPILED_FUNCTION_OBJ";
+inline const ObjectType CLOSURE_OBJ = "CLOSURE";
 
-inline ObjectType ARRAY_OBJ = "ARRAY";
-inline ObjectType HASH_OBJ = "HASH";
+inline const ObjectType ARRAY_OBJ = "ARRAY";
+inline const ObjectType HASH_OBJ = "HASH";
+inline const ObjectType SHAPE_OBJ = "SHAPE";
+
+inline const ObjectType CHANNEL_OBJ = "CHANNEL";
 
 class Object;
+class Channel;
 
 struct HashKey {
     ObjectType type;
@@ -183,18 +191,98 @@ public:
     std::string inspect() override;
 };
 
+// Non-owning view of a call's arguments. The VM points it straight into its stack,
+// so calling a builtin copies nothing. Only valid for the duration of the call.
+class ArgSpan {
+    Object *const *first{nullptr};
+    size_t count{0};
+
+public:
+    ArgSpan() = default;
+
+    ArgSpan(Object *const *first, const size_t count) : first(first), count(count) {
+    }
+
+    // implicit so host code can pass a vector of arguments directly
+    ArgSpan(const std::vector<Object *> &args) : first(args.data()), count(args.size()) { // NOLINT
+    }
+
+    size_t size() const {
+        return this->count;
+    }
+
+    bool empty() const {
+        return this->count == 0;
+    }
+
+    Object *operator[](const size_t i) const {
+        return this->first[i];
+    }
+
+    Object *back() const {
+        return this->first[this->count - 1];
+    }
+
+    Object *const *begin() const {
+        return this->first;
+    }
+
+    Object *const *end() const {
+        return this->first + this->count;
+    }
+};
+
+// Implemented by the VM and the evaluator so builtins can call back into Monkey functions.
+class Caller {
+public:
+    virtual ~Caller() = default;
+
+    virtual Object *callFunction(Object &fn, ArgSpan args) = 0;
+
+    // Creates `count` independent callers that can each run `fn` on another thread while this one waits.
+    // Returns none if this caller cannot run work in parallel at all, or sets `error` when `fn` could
+    // observe or change state shared with other threads; that is checked even if `count` is 0.
+    virtual std::vector<std::unique_ptr<Caller> > isolates(Object &, size_t, std::string &) {
+        return {};
+    }
+
+    // Starts `fn(args)` as a task that runs concurrently with this caller, or sets `error`.
+    virtual void spawn(Object &, ArgSpan, std::string &error) {
+        error = "tasks are only supported by the VM";
+    }
+
+    // Waits for a value on the empty `channel`. Returns nullptr and sets `error` if none can arrive;
+    // a VM task may also return nullptr after parking itself, to retry the call when it resumes.
+    virtual Object *receive(Channel &, std::string &error) {
+        error = "deadlock: no task is left to send on the channel";
+        return nullptr;
+    }
+};
+
 // You'll need to implement these types based on your needs
-using BuiltinFunction = Object*(*)(const std::vector<Object *> &);
+using BuiltinFunction = Object*(*)(ArgSpan);
+
+// Higher-order builtins (`map`, `filter`, ...) additionally receive whoever is running them.
+using CallbackBuiltinFunction = Object*(*)(ArgSpan, Caller &);
 
 class Builtin final : public Object {
 public:
-    BuiltinFunction fn;
+    // exactly one of these is set
+    BuiltinFunction fn{nullptr};
+    CallbackBuiltinFunction callbackFn{nullptr};
+    // false for builtins with side effects outside the script (e.g. `puts`); those may not run in `pmap`
+    bool pure{true};
 
-    explicit Builtin(const BuiltinFunction fn) : fn(fn) {
+    explicit Builtin(const BuiltinFunction fn, const bool pure = true) : fn(fn), pure(pure) {
+    }
+
+    explicit Builtin(const CallbackBuiltinFunction fn) : callbackFn(fn) {
     }
 
     ~Builtin() override = default;
 
+    Object *call(ArgSpan args, Caller &caller) const;
+
     ObjectType type() override;
 
     std::string inspect() override;
@@ -215,6 +303,24 @@ public:
     std::string inspect() override;
 };
 
+// Unboxed array of integers. Integer-only array literals compile to one of these, and the numeric
+// builtins (`sum`, `dot`, `add`, ...) run SIMD kernels over `values` instead of chasing `Integer*`s.
+// It reports ARRAY as its type so scripts cannot tell it apart from a boxed `Array`.
+class IntArray final : public Object {
+public:
+    std::vector<int64_t> values;
+
+    explicit IntArray(std::vector<int64_t> values)
+        : values(std::move(values)) {
+    }
+
+    ~IntArray() override = default;
+
+    ObjectType type() override;
+
+    std::string inspect() override;
+};
+
 struct HashPair {
     Object *key;
     Object *value;
@@ -227,19 +333,64 @@ struct HashPair {
     }
 };
 
+// Hidden class shared by every record hash literal with the same string keys.
+// It maps each key to a slot so `OpIndexConstKey` sites can cache (shape, slot) and skip the hash probe.
+class Shape final : public Object {
+public:
+    std::vector<String *> keys;
+    std::vector<HashKey> hashKeys;
+    std::unordered_map<std::string, int> slots;
+
+    explicit Shape(const std::vector<String *> &keys);
+
+    ~Shape() override = default;
+
+    int slotOf(const std::string &key) const;
+
+    ObjectType type() override;
+
+    std::string inspect() override;
+};
+
 class Hash final : public Object {
 public:
-    std::unordered_map<HashKey, HashPair> pairs;
+    // set only for records built by `OpRecord`; `slots` then holds the values in shape order
+    Shape *shape{nullptr};
+    std::vector<Object *> slots{};
+
+    explicit Hash(const std::unordered_map<HashKey, HashPair> &pairs = {}) {
+        for (const auto &[key, pair]: pairs) {
+            this->trie = this->trie.set(key, pair);
+        }
+    }
+
+    explicit Hash(HashTrie pairs)
+        : trie(std::move(pairs)) {
+    }
 
-    explicit Hash(const std::unordered_map<HashKey, HashPair> &pairs = {})
-        : pairs(pairs) {
+    // a record; its pairs are built from the slots only when something asks for them
+    Hash(Shape &shape, std::vector<Object *> slots)
+        : shape(&shape), slots(std::move(slots)), built(false) {
     }
 
     ~Hash() override = default;
 
+    const HashTrie &pairs() const {
+        if (!this->built.load(std::memory_order_acquire)) {
+            this->buildPairs();
+        }
+        return this->trie;
+    }
+
     ObjectType type() override;
 
     std::string inspect() override;
+
+private:
+    mutable HashTrie trie;
+    mutable std::atomic<bool> built{true};
+
+    void buildPairs() const;
 };
 
 class CompiledFunction final : public Object {
@@ -247,6 +398,11 @@ public:
     Instructions instructions;
     int numLocals;
     int numParameters;
+    // name of the `let` that defined it, for profiles; empty for anonymous functions
+    std::string name{};
+    LineTable lines{};
+    // index in the constant pool it was compiled into, which names it in flight recordings; -1 if unknown
+    int constant{-1};
 
     explicit CompiledFunction(const Instructions &instructions)
         : instructions(instructions), numLocals(0), numParameters(0) {
@@ -0,0 +1,329 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+    struct Kernels {
+        const char *isa;
+        int64_t (*sum)(const int64_t *, size_t);
+        int64_t (*min)(const int64_t *, size_t);
+        int64_t (*max)(const int64_t *, size_t);
+        int64_t (*dot)(const int64_t *, const int64_t *, size_t);
+        void (*add)(const int64_t *, const int64_t *, int64_t *, size_t);
+        void (*mul)(const int64_t *, const int64_t *, int64_t *, size_t);
+    };
+
+    // scalar kernels go through uint64_t so that overflow wraps like the vector lanes do
+
+    int64_t wrapAdd(const int64_t a, const int64_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    }
+
+    int64_t wrapMul(const int64_t a, const int64_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+    }
+
+    int64_t scalarSum(const int64_t *values, const size_t n) {
+        int64_t total = 0;
+        for (size_t i = 0; i < n; i++) {
+            total = wrapAdd(total, values[i]);
+        }
+        return total;
+    }
+
+    int64_t scalarMin(const int64_t *values, const size_t n) {
+        auto result = values[0];
+        for (size_t i = 1; i < n; i++) {
+            result = values[i] < result ? values[i] : result;
+        }
+        return result;
+    }
+
+    int64_t scalarMax(const int64_t *values, const size_t n) {
+        auto result = values[0];
+        for (size_t i = 1; i < n; i++) {
+            result = values[i] > result ? values[i] : result;
+        }
+        return result;
+    }
+
+    int64_t scalarDot(const int64_t *a, const int64_t *b, const size_t n) {
+        int64_t total = 0;
+        for (size_t i = 0; i < n; i++) {
+            total = wrapAdd(total, wrapMul(a[i], b[i]));
+        }
+        return total;
+    }
+
+    void scalarAdd(const int64_t *a, const int64_t *b, int64_t *out, const size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = wrapAdd(a[i], b[i]);
+        }
+    }
+
+    void scalarMul(const int64_t *a, const int64_t *b, int64_t *out, const size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            out[i] = wrapMul(a[i], b[i]);
+        }
+    }
+
+    constexpr Kernels scalarKernels{
+        "scalar", scalarSum, scalarMin, scalarMax, scalarDot, scalarAdd, scalarMul
+    };
+
+#ifdef SIMD_X86
+    // ------------------------------------------------------------------ SSE4.2: 2 lanes
+
+    // low 64 bits of a 64x64 multiply, built from 32x32->64 partial products
+    __attribute__((target("sse4.2"))) __m128i mullo64(const __m128i a, const __m128i b) {
+        const auto lo = _mm_mul_epu32(a, b);
+        const auto cross = _mm_add_epi64(_mm_mul_epu32(a, _mm_srli_epi64(b, 32)),
+                                         _mm_mul_epu32(_mm_srli_epi64(a, 32), b));
+        return _mm_add_epi64(lo, _mm_slli_epi64(cross, 32));
+    }
+
+    __attribute__((target("sse4.2"))) int64_t sseReduceAdd(const __m128i v) {
+        alignas(16) int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes), v);
+        return wrapAdd(lanes[0], lanes[1]);
+    }
+
+    __attribute__((target("sse4.2"))) int64_t sseSum(const int64_t *values, const size_t n) {
+        auto acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            acc = _mm_add_epi64(acc, _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i)));
+        }
+        return wrapAdd(sseReduceAdd(acc), scalarSum(values + i, n - i));
+    }
+
+    __attribute__((target("sse4.2"))) int64_t sseMin(const int64_t *values, const size_t n) {
+        if (n < 2) {
+            return scalarMin(values, n);
+        }
+        auto acc = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+        size_t i = 2;
+        for (; i + 2 <= n; i += 2) {
+            const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+            acc = _mm_blendv_epi8(acc, v, _mm_cmpgt_epi64(acc, v));
+        }
+        alignas(16) int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc);
+        auto result = lanes[0] < lanes[1] ? lanes[0] : lanes[1];
+        for (; i < n; i++) {
+            result = values[i] < result ? values[i] : result;
+        }
+        return result;
+    }
+
+    __attribute__((target("sse4.2"))) int64_t sseMax(const int64_t *values, const size_t n) {
+        if (n < 2) {
+            return scalarMax(values, n);
+        }
+        auto acc = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values));
+        size_t i = 2;
+        for (; i + 2 <= n; i += 2) {
+            const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(values + i));
+            acc = _mm_blendv_epi8(acc, v, _mm_cmpgt_epi64(v, acc));
+        }
+        alignas(16) int64_t lanes[2];
+        _mm_store_si128(reinterpret_cast<__m128i *>(lanes), acc);
+        auto result = lanes[0] > lanes[1] ? lanes[0] : lanes[1];
+        for (; i < n; i++) {
+            result = values[i] > result ? values[i] : result;
+        }
+        return result;
+    }
+
+    __attribute__((target("sse4.2"))) int64_t sseDot(const int64_t *a, const int64_t *b, const size_t n) {
+        auto acc = _mm_setzero_si128();
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+            const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+            acc = _mm_add_epi64(acc, mullo64(va, vb));
+        }
+        return wrapAdd(sseReduceAdd(acc), scalarDot(a + i, b + i, n - i));
+    }
+
+    __attribute__((target("sse4.2"))) void sseAdd(const int64_t *a, const int64_t *b, int64_t *out, const size_t n) {
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+            const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_add_epi64(va, vb));
+        }
+        scalarAdd(a + i, b + i, out + i, n - i);
+    }
+
+    __attribute__((target("sse4.2"))) void sseMul(const int64_t *a, const int64_t *b, int64_t *out, const size_t n) {
+        size_t i = 0;
+        for (; i + 2 <= n; i += 2) {
+            const auto va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+            const auto vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), mullo64(va, vb));
+        }
+        scalarMul(a + i, b + i, out + i, n - i);
+    }
+
+    constexpr Kernels sseKernels{
+        "sse4.2", sseSum, sseMin, sseMax, sseDot, sseAdd, sseMul
+    };
+
+    // ------------------------------------------------------------------ AVX2: 4 lanes
+
+    __attribute__((target("avx2"))) __m256i mullo64(const __m256i a, const __m256i b) {
+        const auto lo = _mm256_mul_epu32(a, b);
+        const auto cross = _mm256_add_epi64(_mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)),
+                                            _mm256_mul_epu32(_mm256_srli_epi64(a, 32), b));
+        return _mm256_add_epi64(lo, _mm256_slli_epi64(cross, 32));
+    }
+
+    __attribute__((target("avx2"))) int64_t avxReduceAdd(const __m256i v) {
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), v);
+        return wrapAdd(wrapAdd(lanes[0], lanes[1]), wrapAdd(lanes[2], lanes[3]));
+    }
+
+    __attribute__((target("avx2"))) int64_t avxSum(const int64_t *values, const size_t n) {
+        // two accumulators hide the latency of the dependent adds
+        auto acc0 = _mm256_setzero_si256();
+        auto acc1 = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8) {
+            acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)));
+            acc1 = _mm256_add_epi64(acc1, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i + 4)));
+        }
+        for (; i + 4 <= n; i += 4) {
+            acc0 = _mm256_add_epi64(acc0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i)));
+        }
+        return wrapAdd(avxReduceAdd(_mm256_add_epi64(acc0, acc1)), scalarSum(values + i, n - i));
+    }
+
+    __attribute__((target("avx2"))) int64_t avxMin(const int64_t *values, const size_t n) {
+        if (n < 4) {
+            return scalarMin(values, n);
+        }
+        auto acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values));
+        size_t i = 4;
+        for (; i + 4 <= n; i += 4) {
+            const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+            acc = _mm256_blendv_epi8(acc, v, _mm256_cmpgt_epi64(acc, v));
+        }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+        auto result = scalarMin(lanes, 4);
+        for (; i < n; i++) {
+            result = values[i] < result ? values[i] : result;
+        }
+        return result;
+    }
+
+    __attribute__((target("avx2"))) int64_t avxMax(const int64_t *values, const size_t n) {
+        if (n < 4) {
+            return scalarMax(values, n);
+        }
+        auto acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values));
+        size_t i = 4;
+        for (; i + 4 <= n; i += 4) {
+            const auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+            acc = _mm256_blendv_epi8(acc, v, _mm256_cmpgt_epi64(v, acc));
+        }
+        alignas(32) int64_t lanes[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+        auto result = scalarMax(lanes, 4);
+        for (; i < n; i++) {
+            result = values[i] > result ? values[i] : result;
+        }
+        return result;
+    }
+
+    __attribute__((target("avx2"))) int64_t avxDot(const int64_t *a, const int64_t *b, const size_t n) {
+        auto acc = _mm256_setzero_si256();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            const auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            acc = _mm256_add_epi64(acc, mullo64(va, vb));
+        }
+        return wrapAdd(avxReduceAdd(acc), scalarDot(a + i, b + i, n - i));
+    }
+
+    __attribute__((target("avx2"))) void avxAdd(const int64_t *a, const int64_t *b, int64_t *out, const size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            const auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), _mm256_add_epi64(va, vb));
+        }
+        scalarAdd(a + i, b + i, out + i, n - i);
+    }
+
+    __attribute__((target("avx2"))) void avxMul(const int64_t *a, const int64_t *b, int64_t *out, const size_t n) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            const auto va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+            const auto vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), mullo64(va, vb));
+        }
+        scalarMul(a + i, b + i, out + i, n - i);
+    }
+
+    constexpr Kernels avxKernels{
+        "avx2", avxSum, avxMin, avxMax, avxDot, avxAdd, avxMul
+    };
+#endif
+
+    Kernels selectKernels() {
+#ifdef SIMD_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return avxKernels;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return sseKernels;
+        }
+#endif
+        return scalarKernels;
+    }
+
+    const Kernels &kernels() {
+        static const Kernels selected = selectKernels();
+        return selected;
+    }
+}
+
+const char *Simd::isa() {
+    return kernels().isa;
+}
+
+int64_t Simd::sum(const int64_t *values, const size_t n) {
+    return kernels().sum(values, n);
+}
+
+int64_t Simd::min(const int64_t *values, const size_t n) {
+    return kernels().min(values, n);
+}
+
+int64_t Simd::max(const int64_t *values, const size_t n) {
+    return kernels().max(values, n);
+}
+
+int64_t Simd::dot(const int64_t *a, const int64_t *b, const size_t n) {
+    return kernels().dot(a, b, n);
+}
+
+void Simd::add(const int64_t *a, const int64_t *b, int64_t *out, const size_t n) {
+    kernels().add(a, b, out, n);
+}
+
+void Simd::mul(const int64_t *a, const int64_t *b, int64_t *out, const size_t n) {
+    kernels().mul(a, b, out, n);
+}
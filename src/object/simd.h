@@ -0,0 +1,31 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef SIMD_H
+#define SIMD_H
+#include <cstddef>
+#include <cstdint>
+
+// Kernels over contiguous int64 buffers used by the IntArray builtins.
+// The best implementation (AVX2, SSE4.2 or scalar) is picked once at runtime from the host CPU.
+// Arithmetic wraps on overflow in every implementation.
+namespace Simd {
+    const char *isa();
+
+    int64_t sum(const int64_t *values, size_t n);
+
+    // n must be > 0
+    int64_t min(const int64_t *values, size_t n);
+
+    // n must be > 0
+    int64_t max(const int64_t *values, size_t n);
+
+    int64_t dot(const int64_t *a, const int64_t *b, size_t n);
+
+    void add(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+
+    void mul(const int64_t *a, const int64_t *b, int64_t *out, size_t n);
+}
+
+#endif //SIMD_H
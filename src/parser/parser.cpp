@@ -62,6 +62,9 @@ std::unique_ptr<Ast::LetStatement> Parser::parseLetStatement() {
     this->nextToken();
 
     auto value = parseExpression(Precedence::LOWEST);
+    if (const auto fn = dynamic_cast<Ast::FunctionLiteral *>(value.get())) {
+        fn->name = name->value;
+    }
 
     if (this->peekTokenIs(SEMICOLON)) {
         this->nextToken();
@@ -112,14 +115,14 @@ std::unique_ptr<Ast::Expression> Parser::parseExpression(Precedence precedence)
 
 Precedence Parser::peekPrecedence() const {
     if (const auto iterator = precedences.find(this->peekToken.type); iterator != precedences.end()) {
-        return precedences[this->peekToken.type];
+        return iterator->second;
     }
     return Precedence::LOWEST;
 }
 
 Precedence Parser::curPrecedence() const {
     if (const auto iterator = precedences.find(this->curToken.type); iterator != precedences.end()) {
-        return precedences[this->curToken.type];
+        return iterator->second;
     }
     return Precedence::LOWEST;
 }
@@ -25,7 +25,7 @@ enum class Precedence:unsigned int {
     INDEX,
 };
 
-inline std::map<TokenType, Precedence> precedences = {
+inline const std::map<TokenType, Precedence> precedences = {
     {EQ, Precedence::EQUALS},
     {NOT_EQ, Precedence::EQUALS},
     {LT, Precedence::LESS_GREATER},
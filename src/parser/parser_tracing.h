@@ -6,9 +6,9 @@
 #define PARSER_TRACING_H
 #include <string>
 
-static int traceLevel = 0;
+inline thread_local int traceLevel = 0;
 
-inline std::string traceIdentPlaceholder = "\t";
+inline const std::string traceIdentPlaceholder = "\t";
 
 std::string identLevel();
 
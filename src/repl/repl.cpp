@@ -3,22 +3,16 @@
 //
 
 #include "repl.h"
+#include <fstream>
 #include <string>
-#include "../compiler/compiler.h"
+#include "session.h"
 #include "../lexer/lexer.h"
 #include "../object/object.h"
 #include "../parser/parser.h"
-#include "../vm/vm.h"
 
 namespace Repl {
     void start(std::istream &in, std::ostream &out) {
-        std::vector<Object *> constants;
-        const std::vector<Object *> globals(__globals__size);
-
-        const auto symbolTable = new SymbolTable();
-        for (size_t i = 0; i < builtins.size(); i++) {
-            symbolTable->defineBuiltin(i, builtins[i].first);
-        }
+        Session session;
 
         std::string line;
         while (true) {
@@ -26,6 +20,22 @@ namespace Repl {
             if (!std::getline(in, line)) {
                 return;
             }
+            // `:heap <file>` writes what the session holds to a heap graph file for heap_dominators
+            if (line.rfind(":heap ", 0) == 0) {
+                const auto path = line.substr(6);
+                std::ofstream file(path);
+                session.heap().write(file);
+                out << (file ? "heap written to " : "Woops! Cannot write ") << path << "\n";
+                continue;
+            }
+            // `:flight <file>` writes the last calls, builtin calls and errors for flight_decode
+            if (line.rfind(":flight ", 0) == 0) {
+                const auto path = line.substr(8);
+                std::ofstream file(path, std::ios::binary);
+                session.writeFlight(file);
+                out << (file ? "flight recording written to " : "Woops! Cannot write ") << path << "\n";
+                continue;
+            }
 
             const auto lexer = new Lexer(line);
             const auto parser = new Parser(*lexer);
@@ -36,27 +46,24 @@ namespace Repl {
                 continue;
             }
 
-            const auto comp = new Compiler(constants, std::make_shared<SymbolTable>(*symbolTable));
             try {
-                comp->compile(program.get());
+                session.compile(program.get());
             } catch (std::runtime_error &err) {
                 out << "Woops! Compilation failed:\n " << err.what() << "\n";
                 continue;
             }
 
-            auto code = comp->byteCode();
-            constants = code.constants;
-
-            const auto machine = new VM(code, globals);
+            Object *lastPopped;
             try {
-                machine->run();
+                lastPopped = session.run();
             } catch (std::runtime_error &err) {
                 out << "Woops! Executing bytecode failed:\n " << err.what() << "\n";
                 continue;
             }
 
-            const auto lastPopped = machine->lastPoppedStackElem();
-            out << lastPopped->inspect() << "\n";
+            if (lastPopped != nullptr) {
+                out << lastPopped->inspect() << "\n";
+            }
         }
     }
 
@@ -0,0 +1,52 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "session.h"
+
+namespace Repl {
+    Session::Session() : compiler(std::make_shared<Compiler>()) {
+        // the VM reads the compiler's constants in place, so constants a line adds need no copying
+        this->machine = std::make_unique<VM>(
+            std::shared_ptr<const std::vector<Object *> >(this->compiler, &this->compiler->constants),
+            std::make_shared<std::vector<Object *> >(__globals__size));
+    }
+
+    void Session::compile(Ast::Node *program) {
+        try {
+            this->compiler->compile(program);
+        } catch (...) {
+            this->compiler->takeInstructions();
+            throw;
+        }
+        auto main = this->compiler->takeInstructions();
+        this->empty = main.instructions.empty();
+        this->machine->load(std::move(main));
+    }
+
+    HeapGraph Session::heap() const {
+        std::vector<std::string> names;
+        for (const auto &[name, symbol]: this->compiler->symbolTable->store) {
+            if (symbol.scope != GlobalScope) {
+                continue;
+            }
+            if (symbol.index >= static_cast<int>(names.size())) {
+                names.resize(symbol.index + 1);
+            }
+            names[symbol.index] = name;
+        }
+        return HeapGraph::capture(*this->machine, names);
+    }
+
+    void Session::writeFlight(std::ostream &out) const {
+        this->machine->writeFlight(out);
+    }
+
+    Object *Session::run() {
+        if (this->empty) {
+            return nullptr;
+        }
+        this->machine->run();
+        return this->machine->lastPoppedStackElem();
+    }
+}
@@ -0,0 +1,45 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef SESSION_H
+#define SESSION_H
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "../ast/ast.h"
+#include "../compiler/compiler.h"
+#include "../vm/heap_graph.h"
+#include "../vm/vm.h"
+
+namespace Repl {
+    // One compiler and one VM that live as long as the REPL does. Each line is compiled onto the same
+    // constants and symbols and run against the same globals, which grow in place, so a line costs the
+    // same however many came before it.
+    class Session {
+    public:
+        Session();
+
+        // Compiles `program` as the next line. Throws std::runtime_error on a compile error; names the line
+        // defined before failing stay defined, but unset.
+        void compile(Ast::Node *program);
+
+        // Runs the line compiled last and returns the value it popped last, or nullptr for an empty line.
+        // A runtime error is thrown, leaving the globals the line set before it failed.
+        Object *run();
+
+        // What the session holds on to between lines, with globals named after their `let`.
+        HeapGraph heap() const;
+
+        // The VM's flight recorder, which keeps the last calls and errors across lines.
+        void writeFlight(std::ostream &out) const;
+
+    private:
+        std::shared_ptr<Compiler> compiler;
+        std::unique_ptr<VM> machine;
+        bool empty{true};
+    };
+}
+
+#endif //SESSION_H
@@ -0,0 +1,19 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "isolate.h"
+
+#include "../vm/vm.h"
+
+Isolate::Isolate() : globals(std::make_shared<std::vector<Object *> >(__globals__size)) {
+}
+
+Object *Isolate::run(const std::shared_ptr<const ByteCode> &bytecode, const Budget &budget,
+                     const std::string &flightPath) {
+    Heap::Scope scope(&this->heap);
+    VM vm(bytecode, this->globals);
+    vm.writeFlightOnError(flightPath);
+    vm.run(budget);
+    return vm.lastPoppedStackElem();
+}
@@ -0,0 +1,33 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef ISOLATE_H
+#define ISOLATE_H
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../compiler/compiler.h"
+#include "../object/heap.h"
+
+// An independent Monkey runtime with its own globals and heap.
+// Compiled `ByteCode`, builtins and the True/False/Null singletons are immutable and shared by every isolate,
+// so separate isolates can run on separate threads without locking.
+// A single isolate must only be used by one thread at a time.
+class Isolate {
+public:
+    Heap heap;
+    std::shared_ptr<std::vector<Object *> > globals;
+
+    Isolate();
+
+    // Runs `bytecode` against this isolate's globals and returns the last popped value.
+    // Objects created by the run, including the result, are owned by `heap` and die with the isolate.
+    // Throws BudgetExceeded if the run exceeds `budget`. A run that fails writes its VM's flight recorder to
+    // `flightPath`, unless that is empty.
+    Object *run(const std::shared_ptr<const ByteCode> &bytecode, const Budget &budget = {},
+                const std::string &flightPath = {});
+};
+
+#endif //ISOLATE_H
@@ -0,0 +1,190 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "thread_pool.h"
+#include "../vm/vm.h"
+
+namespace {
+    // how long a blocked receiver sleeps before it looks for tasks to run or a deadlock again
+    constexpr auto pollInterval = std::chrono::milliseconds(1);
+}
+
+void Channel::send(Object &value) {
+    std::lock_guard lock(this->mutex);
+    this->values.push_back(&value);
+    if (!this->waiters.empty()) {
+        auto *fiber = this->waiters.front();
+        this->waiters.pop_front();
+        fiber->waitingOn = nullptr;
+        TaskGroup::wake(*fiber);
+    }
+    this->ready.notify_one();
+}
+
+Object *Channel::tryReceive() {
+    std::lock_guard lock(this->mutex);
+    if (this->values.empty()) {
+        return nullptr;
+    }
+    auto *value = this->values.front();
+    this->values.pop_front();
+    return value;
+}
+
+ObjectType Channel::type() {
+    return CHANNEL_OBJ;
+}
+
+std::string Channel::inspect() {
+    return "channel";
+}
+
+TaskGroup::TaskGroup(Heap *home) : home(home) {
+}
+
+Fiber &TaskGroup::add(std::unique_ptr<VM> vm, const bool tracked) {
+    auto fiber = std::make_unique<Fiber>();
+    fiber->vm = std::move(vm);
+    fiber->group = this;
+    fiber->tracked = tracked;
+
+    std::lock_guard lock(this->mutex);
+    this->fibers.push_back(std::move(fiber));
+    return *this->fibers.back();
+}
+
+void TaskGroup::schedule(Fiber &fiber) {
+    {
+        std::lock_guard lock(this->mutex);
+        this->runnable++;
+    }
+    this->enqueue(fiber);
+}
+
+void TaskGroup::enqueue(Fiber &fiber) {
+    // the queued slice keeps the group alive even if its spawner is gone by the time it runs
+    ThreadPool::shared().submit([group = this->shared_from_this(), &fiber] {
+        group->step(fiber);
+    });
+}
+
+void TaskGroup::step(Fiber &fiber) {
+    fiber.state = Fiber::Running;
+    auto finished = true;
+    {
+        Heap::Scope scope(fiber.tracked ? &fiber.heap : nullptr);
+        try {
+            finished = fiber.vm->resume();
+        } catch (const std::exception &e) {
+            std::lock_guard lock(this->mutex);
+            if (this->failure.empty()) {
+                this->failure = e.what();
+            }
+        }
+        if (finished) {
+            fiber.vm.reset();
+        }
+    }
+
+    if (finished) {
+        fiber.state = Fiber::Finished;
+    } else if (auto expected = Fiber::Parking; !fiber.state.compare_exchange_strong(expected, Fiber::Parked)) {
+        // a value arrived while the task was parking; give it another slice right away
+        this->enqueue(fiber);
+        return;
+    }
+    {
+        std::lock_guard lock(this->mutex);
+        this->runnable--;
+    }
+    this->idle.notify_all();
+}
+
+void TaskGroup::park(Fiber &fiber, Channel &channel) {
+    fiber.state = Fiber::Parking;
+    fiber.waitingOn = &channel;
+    channel.waiters.push_back(&fiber);
+}
+
+void TaskGroup::wake(Fiber &fiber) {
+    if (auto expected = Fiber::Parking; fiber.state.compare_exchange_strong(expected, Fiber::Notified)) {
+        // the slice that is parking it sees this and requeues it
+        return;
+    }
+    if (auto expected = Fiber::Parked; fiber.state.compare_exchange_strong(expected, Fiber::Ready)) {
+        fiber.group->schedule(fiber);
+    }
+}
+
+int TaskGroup::countRunnable() {
+    std::lock_guard lock(this->mutex);
+    return this->runnable;
+}
+
+std::string TaskGroup::firstFailure() {
+    std::lock_guard lock(this->mutex);
+    return this->failure;
+}
+
+Object *TaskGroup::await(TaskGroup *group, Channel &channel, std::string &error) {
+    auto &pool = ThreadPool::shared();
+    while (true) {
+        {
+            std::unique_lock lock(channel.mutex);
+            if (!channel.values.empty()) {
+                auto *value = channel.values.front();
+                channel.values.pop_front();
+                return value;
+            }
+            if (group != nullptr) {
+                if (auto failure = group->firstFailure(); !failure.empty()) {
+                    error = "spawned task failed: " + failure;
+                    return nullptr;
+                }
+            }
+            if (group == nullptr || group->countRunnable() == 0) {
+                error = "deadlock: no task is left to send on the channel";
+                return nullptr;
+            }
+        }
+        // help out rather than idle; sleep only if there was nothing to run
+        if (!pool.runPending()) {
+            std::unique_lock lock(channel.mutex);
+            channel.ready.wait_for(lock, pollInterval);
+        }
+    }
+}
+
+void TaskGroup::drain() {
+    auto &pool = ThreadPool::shared();
+    while (this->countRunnable() > 0) {
+        if (!pool.runPending()) {
+            std::unique_lock lock(this->mutex);
+            this->idle.wait_for(lock, pollInterval, [this] { return this->runnable == 0; });
+        }
+    }
+
+    std::vector<std::unique_ptr<Fiber> > drained;
+    {
+        std::lock_guard lock(this->mutex);
+        drained.swap(this->fibers);
+    }
+    for (auto &fiber: drained) {
+        // nothing is left to wake a task that is still parked
+        if (auto *channel = fiber->waitingOn; channel != nullptr) {
+            std::lock_guard lock(channel->mutex);
+            auto &waiters = channel->waiters;
+            waiters.erase(std::remove(waiters.begin(), waiters.end(), fiber.get()), waiters.end());
+        }
+        fiber->vm.reset();
+        if (this->home != nullptr) {
+            this->home->adopt(fiber->heap);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../object/heap.h"
+#include "../object/object.h"
+
+class VM;
+class TaskGroup;
+
+// A task started by `spawn`: a VM of its own (value stack and frames) that runs on the shared thread pool
+// a slice at a time. A slice ends when the task returns or parks in `recv` on an empty channel;
+// a parked task holds no thread and is queued again by the `send` that wakes it.
+struct Fiber {
+    enum State { Ready, Running, Parking, Parked, Notified, Finished };
+
+    std::unique_ptr<VM> vm;
+    TaskGroup *group{nullptr};
+    std::atomic<State> state{Ready};
+    // owns what the task allocates, if its spawner allocated into a heap too
+    Heap heap;
+    bool tracked{false};
+    // the channel a parked task waits on
+    Channel *waitingOn{nullptr};
+};
+
+// Unbounded FIFO queue between tasks. `send` never blocks; `recv` parks a task, or blocks any other caller,
+// until a value arrives.
+class Channel final : public Object {
+public:
+    std::mutex mutex;
+    // signalled for receivers that block their thread instead of parking
+    std::condition_variable ready;
+    std::deque<Object *> values;
+    std::deque<Fiber *> waiters;
+
+    void send(Object &value);
+
+    // nullptr if the channel is empty
+    Object *tryReceive();
+
+    ObjectType type() override;
+
+    std::string inspect() override;
+};
+
+// The tasks spawned, directly or transitively, by one VM. They are scheduled M:N on `ThreadPool::shared()`,
+// which steals work between workers. The spawning VM drains the group before it is destroyed.
+class TaskGroup : public std::enable_shared_from_this<TaskGroup> {
+public:
+    // `home` is the heap the spawning VM allocates into, or null
+    explicit TaskGroup(Heap *home);
+
+    // Takes `vm`, already set up to call the task's function. `schedule` then queues its first slice.
+    Fiber &add(std::unique_ptr<VM> vm, bool tracked);
+
+    void schedule(Fiber &fiber);
+
+    // Registers `fiber` as waiting on `channel`. The caller holds the channel's mutex.
+    static void park(Fiber &fiber, Channel &channel);
+
+    // Called with the channel's mutex held once `fiber` has been taken off its waiters.
+    static void wake(Fiber &fiber);
+
+    // Waits on the calling thread for a value on `channel`, running queued tasks meanwhile.
+    // Sets `error` instead if no task of `group` (which may be null) is left that could send one.
+    static Object *await(TaskGroup *group, Channel &channel, std::string &error);
+
+    // Waits until every task has finished or parked for good, then moves their heaps into the home heap
+    // and drops them. Without a home heap, what they allocated lives as long as the process.
+    void drain();
+
+private:
+    Heap *home;
+    std::mutex mutex;
+    std::condition_variable idle;
+    std::vector<std::unique_ptr<Fiber> > fibers;
+    // tasks queued or running; none can make progress once this drops to zero
+    int runnable{0};
+    // message of the first task that failed
+    std::string failure;
+
+    void enqueue(Fiber &fiber);
+
+    void step(Fiber &fiber);
+
+    int countRunnable();
+
+    std::string firstFailure();
+};
+
+#endif //SCHEDULER_H
@@ -0,0 +1,157 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "thread_pool.h"
+
+#include <chrono>
+#include <exception>
+
+namespace {
+    // the pool and queue owned by the current thread, if it is a pool worker
+    thread_local const ThreadPool *workerPool{nullptr};
+    thread_local size_t workerIndex{0};
+}
+
+ThreadPool::ThreadPool(const size_t threads) {
+    const auto count = threads == 0 ? 1 : threads;
+    for (size_t i = 0; i < count; i++) {
+        this->queues.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < count; i++) {
+        this->workers.emplace_back([this, i] { this->workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(this->sleepMutex);
+        this->stopping = true;
+    }
+    this->wake.notify_all();
+    for (auto &worker: this->workers) {
+        worker.join();
+    }
+}
+
+size_t ThreadPool::size() const {
+    return this->workers.size();
+}
+
+void ThreadPool::submit(Task task) {
+    // workers keep what they spawn local; outside threads spread tasks round-robin
+    const auto home = workerPool == this
+                          ? workerIndex
+                          : this->nextQueue.fetch_add(1, std::memory_order_relaxed) % this->queues.size();
+    {
+        // counted before it is queued so `pending` never underflows when a thief is quick
+        std::lock_guard lock(this->sleepMutex);
+        this->pending.fetch_add(1);
+    }
+    {
+        auto &queue = *this->queues[home];
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    this->wake.notify_one();
+}
+
+bool ThreadPool::take(const size_t home, Task &task) {
+    {
+        auto &own = *this->queues[home];
+        std::lock_guard lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            this->pending.fetch_sub(1);
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < this->queues.size(); offset++) {
+        auto &victim = *this->queues[(home + offset) % this->queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            this->pending.fetch_sub(1);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::runPending() {
+    const auto home = workerPool == this ? workerIndex : 0;
+    Task task;
+    if (!this->take(home, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(const size_t index) {
+    workerPool = this;
+    workerIndex = index;
+    while (true) {
+        Task task;
+        if (this->take(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock lock(this->sleepMutex);
+        this->wake.wait(lock, [this] { return this->stopping || this->pending.load() > 0; });
+        if (this->stopping && this->pending.load() == 0) {
+            return;
+        }
+    }
+}
+
+void ThreadPool::parallelFor(const size_t count, const std::function<void(size_t)> &body) {
+    std::mutex doneMutex;
+    std::condition_variable done;
+    size_t remaining = count;
+    std::exception_ptr failure;
+
+    for (size_t i = 0; i < count; i++) {
+        this->submit([&, i] {
+            std::exception_ptr error;
+            try {
+                body(i);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard lock(doneMutex);
+            if (error != nullptr && failure == nullptr) {
+                failure = error;
+            }
+            if (--remaining == 0) {
+                done.notify_all();
+            }
+        });
+    }
+
+    while (true) {
+        {
+            std::unique_lock lock(doneMutex);
+            if (remaining == 0) {
+                break;
+            }
+        }
+        if (this->runPending()) {
+            continue;
+        }
+        // nothing left to help with: our tasks are running elsewhere
+        std::unique_lock lock(doneMutex);
+        done.wait_for(lock, std::chrono::milliseconds(1), [&] { return remaining == 0; });
+    }
+
+    if (failure != nullptr) {
+        std::rethrow_exception(failure);
+    }
+}
+
+ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool(std::thread::hardware_concurrency());
+    return pool;
+}
@@ -0,0 +1,66 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size pool where every worker owns a deque of tasks.
+// Workers pop their own deque from the back and steal from the front of the others when it runs dry,
+// so tasks spawned by a busy worker are picked up by idle ones.
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit ThreadPool(size_t threads);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const;
+
+    void submit(Task task);
+
+    // Runs one queued task on the calling thread. Returns false if there was nothing to run.
+    bool runPending();
+
+    // Runs body(0) ... body(count - 1) on the pool and waits for all of them.
+    // The calling thread helps while it waits, so this may be nested inside pool tasks.
+    // The first exception thrown by a body is rethrown here once every task has finished.
+    void parallelFor(size_t count, const std::function<void(size_t)> &body);
+
+    static ThreadPool &shared();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> workers;
+
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    // tasks submitted but not yet taken off a queue
+    std::atomic<size_t> pending{0};
+    std::atomic<size_t> nextQueue{0};
+    bool stopping{false};
+
+    bool take(size_t home, Task &task);
+
+    void workerLoop(size_t index);
+};
+
+#endif //THREAD_POOL_H
@@ -0,0 +1,348 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "json.h"
+
+#include <charconv>
+
+#include "../object/heap.h"
+#include "../vm/vm.h"
+#include "fmt/format.h"
+
+namespace {
+    class Reader {
+        std::string_view text;
+        size_t pos{0};
+
+    public:
+        std::string error;
+
+        explicit Reader(const std::string_view text) : text(text) {
+        }
+
+        Object *document() {
+            auto *value = this->value();
+            this->skipSpace();
+            if (value != nullptr && this->pos != this->text.size()) {
+                return this->fail("unexpected trailing characters");
+            }
+            return value;
+        }
+
+    private:
+        Object *fail(const std::string &message) {
+            if (this->error.empty()) {
+                this->error = fmt::format("invalid JSON at offset {:d}: {:s}", this->pos, message);
+            }
+            return nullptr;
+        }
+
+        void skipSpace() {
+            while (this->pos < this->text.size() &&
+                   (this->text[this->pos] == ' ' || this->text[this->pos] == '\t' ||
+                    this->text[this->pos] == '\n' || this->text[this->pos] == '\r')) {
+                this->pos++;
+            }
+        }
+
+        bool consume(const std::string_view literal) {
+            if (this->text.substr(this->pos, literal.size()) != literal) {
+                return false;
+            }
+            this->pos += literal.size();
+            return true;
+        }
+
+        Object *value() {
+            this->skipSpace();
+            if (this->pos >= this->text.size()) {
+                return this->fail("unexpected end of input");
+            }
+            switch (this->text[this->pos]) {
+                case '{':
+                    return this->object();
+                case '[':
+                    return this->array();
+                case '"': {
+                    std::string s;
+                    if (!this->string(s)) {
+                        return nullptr;
+                    }
+                    return make<String>(std::move(s));
+                }
+                default:
+                    break;
+            }
+            if (this->consume("true")) {
+                return VM::True;
+            }
+            if (this->consume("false")) {
+                return VM::False;
+            }
+            if (this->consume("null")) {
+                return VM::Null;
+            }
+            return this->number();
+        }
+
+        Object *number() {
+            int64_t value{};
+            const auto *begin = this->text.data() + this->pos;
+            const auto *end = this->text.data() + this->text.size();
+            const auto [next, ec] = std::from_chars(begin, end, value);
+            if (ec != std::errc() || next == begin) {
+                return this->fail("expected a value");
+            }
+            if (next != end && (*next == '.' || *next == 'e' || *next == 'E')) {
+                return this->fail("only integer numbers are supported");
+            }
+            this->pos += next - begin;
+            return make<Integer>(value);
+        }
+
+        static void appendUtf8(std::string &out, const uint32_t cp) {
+            if (cp < 0x80) {
+                out += static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                out += static_cast<char>(0xC0 | cp >> 6);
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                out += static_cast<char>(0xE0 | cp >> 12);
+                out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | cp >> 18);
+                out += static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+                out += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+        bool hex4(uint32_t &cp) {
+            if (this->pos + 4 > this->text.size()) {
+                return false;
+            }
+            const auto *begin = this->text.data() + this->pos;
+            const auto [next, ec] = std::from_chars(begin, begin + 4, cp, 16);
+            if (ec != std::errc() || next != begin + 4) {
+                return false;
+            }
+            this->pos += 4;
+            return true;
+        }
+
+        bool string(std::string &out) {
+            this->pos++; // opening quote
+            while (this->pos < this->text.size()) {
+                const auto c = this->text[this->pos++];
+                if (c == '"') {
+                    return true;
+                }
+                if (c != '\\') {
+                    out += c;
+                    continue;
+                }
+                if (this->pos >= this->text.size()) {
+                    break;
+                }
+                switch (const auto escape = this->text[this->pos++]) {
+                    case '"':
+                    case '\\':
+                    case '/':
+                        out += escape;
+                        break;
+                    case 'b':
+                        out += '\b';
+                        break;
+                    case 'f':
+                        out += '\f';
+                        break;
+                    case 'n':
+                        out += '\n';
+                        break;
+                    case 'r':
+                        out += '\r';
+                        break;
+                    case 't':
+                        out += '\t';
+                        break;
+                    case 'u': {
+                        uint32_t cp{};
+                        if (!this->hex4(cp)) {
+                            this->fail("bad \\u escape");
+                            return false;
+                        }
+                        // surrogate pair
+                        if (cp >= 0xD800 && cp < 0xDC00 && this->consume("\\u")) {
+                            uint32_t low{};
+                            if (!this->hex4(low) || low < 0xDC00 || low >= 0xE000) {
+                                this->fail("bad surrogate pair");
+                                return false;
+                            }
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        appendUtf8(out, cp);
+                        break;
+                    }
+                    default:
+                        this->fail("bad escape");
+                        return false;
+                }
+            }
+            this->fail("unterminated string");
+            return false;
+        }
+
+        Object *array() {
+            this->pos++;
+            std::vector<Object *> elements;
+            this->skipSpace();
+            if (this->consume("]")) {
+                return make<Array>(std::move(elements));
+            }
+            while (true) {
+                auto *element = this->value();
+                if (element == nullptr) {
+                    return nullptr;
+                }
+                elements.push_back(element);
+                this->skipSpace();
+                if (this->consume("]")) {
+                    return make<Array>(std::move(elements));
+                }
+                if (!this->consume(",")) {
+                    return this->fail("expected ',' or ']'");
+                }
+            }
+        }
+
+        Object *object() {
+            this->pos++;
+            HashTrie pairs;
+            this->skipSpace();
+            if (this->consume("}")) {
+                return make<Hash>(std::move(pairs));
+            }
+            while (true) {
+                this->skipSpace();
+                if (this->pos >= this->text.size() || this->text[this->pos] != '"') {
+                    return this->fail("expected a string key");
+                }
+                std::string name;
+                if (!this->string(name)) {
+                    return nullptr;
+                }
+                this->skipSpace();
+                if (!this->consume(":")) {
+                    return this->fail("expected ':'");
+                }
+                auto *value = this->value();
+                if (value == nullptr) {
+                    return nullptr;
+                }
+                auto *key = make<String>(std::move(name));
+                pairs = pairs.set(key->hash_key(), HashPair(*key, *value));
+                this->skipSpace();
+                if (this->consume("}")) {
+                    return make<Hash>(std::move(pairs));
+                }
+                if (!this->consume(",")) {
+                    return this->fail("expected ',' or '}'");
+                }
+            }
+        }
+    };
+
+    void write(std::string &out, Object &value) {
+        if (const auto integer = dynamic_cast<Integer *>(&value)) {
+            out += std::to_string(integer->value);
+        } else if (const auto boolean = dynamic_cast<Boolean *>(&value)) {
+            out += boolean->value ? "true" : "false";
+        } else if (value.type() == NULL_OBJ) {
+            out += "null";
+        } else if (const auto string = dynamic_cast<String *>(&value)) {
+            out += Json::quote(string->value);
+        } else if (const auto array = dynamic_cast<Array *>(&value)) {
+            out += '[';
+            for (size_t i = 0; i < array->elements.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                write(out, *array->elements[i]);
+            }
+            out += ']';
+        } else if (const auto ints = dynamic_cast<IntArray *>(&value)) {
+            out += '[';
+            for (size_t i = 0; i < ints->values.size(); i++) {
+                if (i > 0) {
+                    out += ',';
+                }
+                out += std::to_string(ints->values[i]);
+            }
+            out += ']';
+        } else if (const auto hash = dynamic_cast<Hash *>(&value)) {
+            out += '{';
+            auto first = true;
+            for (const auto &[_, pair]: hash->pairs()) {
+                if (!first) {
+                    out += ',';
+                }
+                first = false;
+                const auto key = dynamic_cast<String *>(pair.key);
+                out += Json::quote(key != nullptr ? key->value : pair.key->inspect());
+                out += ':';
+                write(out, *pair.value);
+            }
+            out += '}';
+        } else {
+            out += Json::quote(value.inspect());
+        }
+    }
+}
+
+namespace Json {
+    Object *parse(const std::string_view text, std::string &error) {
+        Reader reader(text);
+        auto *value = reader.document();
+        error = reader.error;
+        return value;
+    }
+
+    std::string dump(Object &value) {
+        std::string out;
+        write(out, value);
+        return out;
+    }
+
+    std::string quote(const std::string_view text) {
+        std::string out = "\"";
+        for (const auto c: text) {
+            switch (c) {
+                case '"':
+                    out += "\\\"";
+                    break;
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '\r':
+                    out += "\\r";
+                    break;
+                case '\t':
+                    out += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        out += fmt::format("\\u{:04x}", static_cast<int>(c));
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+        return out;
+    }
+}
@@ -0,0 +1,27 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef JSON_H
+#define JSON_H
+#include <string>
+#include <string_view>
+
+#include "../object/object.h"
+
+// Conversion between JSON text and Monkey values, for the script server and the tools.
+// Objects become hashes with string keys, arrays become arrays and numbers must be integers.
+namespace Json {
+    // Parses a single JSON document. Returns nullptr and sets `error` if the text is not valid JSON
+    // or holds a number with a fraction or exponent.
+    Object *parse(std::string_view text, std::string &error);
+
+    // Serializes `value`. Values with no JSON form, such as functions, are written as their inspect() string,
+    // and hash keys that are not strings are written as theirs.
+    std::string dump(Object &value);
+
+    // `text` as a quoted and escaped JSON string
+    std::string quote(std::string_view text);
+}
+
+#endif //JSON_H
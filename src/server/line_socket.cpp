@@ -0,0 +1,111 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "line_socket.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "fmt/format.h"
+
+namespace {
+    sockaddr_un address(const std::string &path) {
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error(fmt::format("socket path too long: {:s}", path));
+        }
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        return addr;
+    }
+
+    std::runtime_error systemError(const std::string &what) {
+        return std::runtime_error(fmt::format("{:s}: {:s}", what, std::strerror(errno)));
+    }
+}
+
+LineSocket::LineSocket(const int fd) : fd(fd) {
+}
+
+LineSocket::LineSocket(LineSocket &&other) noexcept
+    : fd(other.fd), buffer(std::move(other.buffer)), start(other.start) {
+    other.fd = -1;
+}
+
+LineSocket::~LineSocket() {
+    if (this->fd >= 0) {
+        close(this->fd);
+    }
+}
+
+LineSocket LineSocket::connect(const std::string &path) {
+    const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw systemError("socket");
+    }
+    LineSocket connection(fd);
+    const auto addr = address(path);
+    if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+        throw systemError(fmt::format("connect to {:s}", path));
+    }
+    return connection;
+}
+
+int LineSocket::listen(const std::string &path) {
+    const auto fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw systemError("socket");
+    }
+    unlink(path.c_str());
+    const auto addr = address(path);
+    if (bind(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        close(fd);
+        throw systemError(fmt::format("listen on {:s}", path));
+    }
+    return fd;
+}
+
+bool LineSocket::readLine(std::string &line) {
+    while (true) {
+        if (const auto end = this->buffer.find('\n', this->start); end != std::string::npos) {
+            line.assign(this->buffer, this->start, end - this->start);
+            this->start = end + 1;
+            return true;
+        }
+        // drop consumed lines before reading more
+        this->buffer.erase(0, this->start);
+        this->start = 0;
+
+        char chunk[4096];
+        const auto n = read(this->fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        this->buffer.append(chunk, n);
+    }
+}
+
+bool LineSocket::writeLine(const std::string_view line) {
+    std::string message(line);
+    message += '\n';
+    size_t written = 0;
+    while (written < message.size()) {
+        const auto n = send(this->fd, message.data() + written, message.size() - written, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
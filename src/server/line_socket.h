@@ -0,0 +1,41 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef LINE_SOCKET_H
+#define LINE_SOCKET_H
+#include <string>
+#include <string_view>
+
+// A connected Unix domain stream socket carrying newline-terminated messages. POSIX only.
+class LineSocket {
+public:
+    explicit LineSocket(int fd);
+
+    ~LineSocket();
+
+    LineSocket(const LineSocket &) = delete;
+
+    LineSocket &operator=(const LineSocket &) = delete;
+
+    // Connects to the server listening at `path`; throws std::runtime_error on failure.
+    static LineSocket connect(const std::string &path);
+
+    LineSocket(LineSocket &&other) noexcept;
+
+    // Reads the next line without its newline. Returns false once the peer has closed the connection.
+    bool readLine(std::string &line);
+
+    // Writes `line` and a newline. Returns false if the peer has gone.
+    bool writeLine(std::string_view line);
+
+    // Binds and listens at `path`, replacing a stale socket file. Returns the listening descriptor.
+    static int listen(const std::string &path);
+
+private:
+    int fd;
+    std::string buffer;
+    size_t start{0};
+};
+
+#endif //LINE_SOCKET_H
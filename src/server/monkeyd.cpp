@@ -0,0 +1,104 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+// monkeyd: keeps scripts compiled and warm, and runs requests from local clients on the shared thread pool.
+//
+//   monkeyd [--flight-dir <dir>] <socket> [script.monkey ...]
+//
+// Each script file is loaded under its file name without the extension; clients can load more at runtime.
+// With --flight-dir, a failed load or request writes the flight recorder of its VM into <dir> (see
+// ScriptHost::writeFlightsTo), for flight_decode to print.
+// Requests and responses are one JSON object per line (see ScriptHost::handle). Requests on one connection
+// run concurrently and their responses are written as each finishes, so clients match them up by "id".
+
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "line_socket.h"
+#include "script_host.h"
+#include "../runtime/thread_pool.h"
+
+namespace {
+    const char *socketPath{nullptr};
+
+    void stop(int) {
+        unlink(socketPath);
+        _exit(0);
+    }
+
+    struct Connection {
+        LineSocket socket;
+        std::mutex writeMutex;
+
+        explicit Connection(const int fd) : socket(fd) {
+        }
+    };
+
+    void serve(ScriptHost &host, const std::shared_ptr<Connection> &connection) {
+        auto &pool = ThreadPool::shared();
+        std::string line;
+        while (connection->socket.readLine(line)) {
+            if (line.empty()) {
+                continue;
+            }
+            pool.submit([&host, connection, request = std::move(line)] {
+                const auto response = host.handle(request);
+                std::lock_guard lock(connection->writeMutex);
+                connection->socket.writeLine(response);
+            });
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    ScriptHost host;
+    auto first = 1;
+    if (argc > 2 && std::string(argv[1]) == "--flight-dir") {
+        host.writeFlightsTo(argv[2]);
+        first = 3;
+    }
+    if (argc <= first) {
+        std::cerr << "usage: monkeyd [--flight-dir <dir>] <socket> [script.monkey ...]" << std::endl;
+        return 2;
+    }
+    socketPath = argv[first];
+
+    try {
+        for (auto i = first + 1; i < argc; i++) {
+            std::ifstream file(argv[i]);
+            if (!file) {
+                throw std::runtime_error(std::string("cannot read ") + argv[i]);
+            }
+            std::stringstream source;
+            source << file.rdbuf();
+            host.load(std::filesystem::path(argv[i]).stem().string(), source.str());
+        }
+
+        const auto listener = LineSocket::listen(socketPath);
+        std::signal(SIGINT, stop);
+        std::signal(SIGTERM, stop);
+        std::cerr << "monkeyd: listening on " << socketPath << " with " << ThreadPool::shared().size()
+                << " workers" << std::endl;
+
+        while (true) {
+            const auto fd = accept(listener, nullptr, nullptr);
+            if (fd < 0) {
+                continue;
+            }
+            std::thread(serve, std::ref(host), std::make_shared<Connection>(fd)).detach();
+        }
+    } catch (const std::runtime_error &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,102 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+// monkeyd_bench: measures request latency against a running monkeyd under concurrent load.
+//
+//   monkeyd_bench <socket> [clients=8] [requests per client=2000]
+//
+// Loads a small scoring script, then every client sends its requests one at a time over its own connection
+// and times each round trip. Prints throughput and latency percentiles over all requests.
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json.h"
+#include "line_socket.h"
+#include "fmt/format.h"
+
+namespace {
+    const std::string script = "let weights = [3, 5, 7];"
+            "fn(a, b, c) { let s = a * weights[0] + b * weights[1] + c * weights[2]; if (s > 100) { s - 100 } else { 0 } }";
+
+    double percentile(const std::vector<double> &sorted, const double p) {
+        const auto index = static_cast<size_t>(p / 100 * static_cast<double>(sorted.size() - 1));
+        return sorted[index];
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: monkeyd_bench <socket> [clients] [requests per client]" << std::endl;
+        return 2;
+    }
+    const std::string path = argv[1];
+    const auto clients = argc > 2 ? std::stoi(argv[2]) : 8;
+    const auto requests = argc > 3 ? std::stoi(argv[3]) : 2000;
+
+    try {
+        auto setup = LineSocket::connect(path);
+        std::string response;
+        setup.writeLine(fmt::format(R"({{"id":0,"load":"bench_score","source":{:s}}})", Json::quote(script)));
+        if (!setup.readLine(response) || response.find("\"error\"") != std::string::npos) {
+            throw std::runtime_error("loading the script failed: " + response);
+        }
+
+        std::vector<std::vector<double> > latencies(clients);
+        std::vector<std::string> failures(clients);
+        const auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (auto c = 0; c < clients; c++) {
+            threads.emplace_back([&, c] {
+                try {
+                    auto connection = LineSocket::connect(path);
+                    std::string line;
+                    latencies[c].reserve(requests);
+                    for (auto i = 0; i < requests; i++) {
+                        const auto request = fmt::format(R"({{"id":{:d},"script":"bench_score","args":[{:d},{:d},{:d}]}})",
+                                                         i, i % 10, c, i % 7);
+                        const auto start = std::chrono::steady_clock::now();
+                        if (!connection.writeLine(request) || !connection.readLine(line)) {
+                            throw std::runtime_error("connection closed");
+                        }
+                        latencies[c].push_back(
+                            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+                        if (line.find("\"error\"") != std::string::npos) {
+                            throw std::runtime_error(line);
+                        }
+                    }
+                } catch (const std::exception &e) {
+                    failures[c] = e.what();
+                }
+            });
+        }
+        for (auto &thread: threads) {
+            thread.join();
+        }
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        for (const auto &failure: failures) {
+            if (!failure.empty()) {
+                throw std::runtime_error(failure);
+            }
+        }
+        std::vector<double> all;
+        for (const auto &client: latencies) {
+            all.insert(all.end(), client.begin(), client.end());
+        }
+        std::sort(all.begin(), all.end());
+        std::cout << fmt::format("{:d} clients x {:d} requests: {:.0f} req/s\n", clients, requests,
+                                 static_cast<double>(all.size()) / elapsed);
+        std::cout << fmt::format("latency us: p50={:.1f} p90={:.1f} p99={:.1f} max={:.1f}\n", percentile(all, 50),
+                                 percentile(all, 90), percentile(all, 99), all.back());
+    } catch (const std::runtime_error &e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,153 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "script_host.h"
+
+#include <cctype>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+
+#include "json.h"
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+#include "../vm/vm.h"
+#include "fmt/format.h"
+
+namespace {
+    Object *field(Hash &request, const std::string &name) {
+        String key(name);
+        const auto pair = request.pairs().get(key.hash_key());
+        return pair != nullptr ? pair->value : nullptr;
+    }
+
+    std::string stringField(Hash &request, const std::string &name) {
+        const auto value = dynamic_cast<String *>(field(request, name));
+        if (value == nullptr) {
+            throw std::runtime_error(fmt::format("request needs a string `{:s}`", name));
+        }
+        return value->value;
+    }
+}
+
+ScriptHost::Warm::~Warm() = default;
+
+ScriptHost::~ScriptHost() = default;
+
+void ScriptHost::load(const std::string &name, const std::string &source) {
+    auto parser = Parser(Lexer(source));
+    auto program = parser.parseProgram();
+    if (const auto errors = parser.errors(); !errors.empty()) {
+        throw std::runtime_error(fmt::format("parser errors in `{:s}`: {:s}", name, errors.front()));
+    }
+    auto compiler = Compiler();
+    compiler.compile(program.get());
+
+    auto script = std::make_shared<Script>();
+    script->code = std::make_shared<const ByteCode>(compiler.byteCode());
+    script->fn = script->isolate.run(script->code, {}, this->flightPath(name));
+    if (script->fn == nullptr || script->fn->type() != CLOSURE_OBJ) {
+        throw std::runtime_error(fmt::format("script `{:s}` must evaluate to a function", name));
+    }
+
+    std::unique_lock lock(this->mutex);
+    this->scripts[name] = std::move(script);
+}
+
+void ScriptHost::writeFlightsTo(std::string directory) {
+    this->flightDirectory = std::move(directory);
+}
+
+std::string ScriptHost::flightPath(const std::string &name) {
+    if (this->flightDirectory.empty()) {
+        return "";
+    }
+    // names come from clients, so they must not reach outside the directory
+    auto file = name;
+    for (auto &c: file) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') {
+            c = '_';
+        }
+    }
+    return (std::filesystem::path(this->flightDirectory) / fmt::format("{:s}.{:d}.flight", file, this->flights++))
+            .string();
+}
+
+std::shared_ptr<ScriptHost::Script> ScriptHost::find(const std::string &name) {
+    std::shared_lock lock(this->mutex);
+    const auto it = this->scripts.find(name);
+    if (it == this->scripts.end()) {
+        throw std::runtime_error(fmt::format("unknown script `{:s}`", name));
+    }
+    return it->second;
+}
+
+std::string ScriptHost::handle(const std::string_view request) {
+    // everything the request allocates is dropped once the response is written
+    Heap heap;
+    Heap::Scope scope(&heap);
+
+    std::string id = "null";
+    try {
+        std::string error;
+        const auto parsed = Json::parse(request, error);
+        if (parsed == nullptr) {
+            throw std::runtime_error(error);
+        }
+        const auto hash = dynamic_cast<Hash *>(parsed);
+        if (hash == nullptr) {
+            throw std::runtime_error("request must be a JSON object");
+        }
+        if (const auto value = field(*hash, "id"); value != nullptr) {
+            id = Json::dump(*value);
+        }
+
+        if (field(*hash, "load") != nullptr) {
+            this->load(stringField(*hash, "load"), stringField(*hash, "source"));
+            return fmt::format("{{\"id\":{:s},\"result\":null}}", id);
+        }
+
+        const auto name = stringField(*hash, "script");
+        const auto script = this->find(name);
+        std::vector<Object *> args;
+        if (const auto value = field(*hash, "args"); value != nullptr) {
+            const auto array = dynamic_cast<Array *>(value);
+            if (array == nullptr) {
+                throw std::runtime_error("`args` must be an array");
+            }
+            args = array->elements;
+        }
+
+        // VMs stay warm across requests, one per thread and script name; a reloaded script replaces the VM
+        // of the old one, which is held only as long as that VM
+        Warm *warm;
+        {
+            std::unique_lock lock(this->mutex);
+            warm = &this->warm[std::this_thread::get_id()][name];
+        }
+        auto &[owner, vm] = *warm;
+        if (owner != script) {
+            // the VM goes first: it runs the old script's bytecode
+            vm.reset();
+            owner = script;
+            vm = std::make_unique<VM>(script->code, script->isolate.globals);
+            vm->writeFlightOnError(this->flightPath(name));
+        }
+        Object *result;
+        try {
+            result = vm->callFunction(*script->fn, args);
+        } catch (...) {
+            vm->joinTasks();
+            throw;
+        }
+        // tasks allocate into the request's heap too
+        vm->joinTasks();
+        if (const auto failed = dynamic_cast<Error *>(result)) {
+            throw std::runtime_error(failed->message);
+        }
+        return fmt::format("{{\"id\":{:s},\"result\":{:s}}}", id, Json::dump(*result));
+    } catch (const std::exception &e) {
+        return fmt::format("{{\"id\":{:s},\"error\":{:s}}}", id, Json::quote(e.what()));
+    }
+}
@@ -0,0 +1,73 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef SCRIPT_HOST_H
+#define SCRIPT_HOST_H
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+#include "../compiler/compiler.h"
+#include "../runtime/isolate.h"
+
+class VM;
+
+// The scripts a server keeps resident. A script is compiled and run once when it is loaded and must evaluate
+// to a function; requests then call that function. Every thread keeps a warmed-up VM per script, so a
+// request pays neither compilation nor VM construction.
+// Scripts should not assign globals from their functions, since requests run on many threads at once.
+class ScriptHost {
+public:
+    ~ScriptHost();
+
+    // Compiles and runs `source`, replacing any script already loaded as `name`.
+    // Throws std::runtime_error if it does not compile, fails, or does not evaluate to a function.
+    void load(const std::string &name, const std::string &source);
+
+    // Handles one request and returns the one-line response. Thread-safe.
+    //   {"id": 7, "script": "score", "args": [1, 2]}  ->  {"id":7,"result":3}
+    //   {"id": 8, "load": "score", "source": "fn(a, b) { a + b }"}  ->  {"id":8,"result":null}
+    // Failures of any kind are answered with {"id":...,"error":"..."}.
+    std::string handle(std::string_view request);
+
+    // Makes the VMs that load scripts and serve requests write their flight recorder into `directory` when a
+    // load or request fails, as `<script>.<n>.flight` where n numbers the VMs. Call before serving requests.
+    void writeFlightsTo(std::string directory);
+
+private:
+    struct Script {
+        std::shared_ptr<const ByteCode> code;
+        // owns the globals and objects made while loading, including `fn`
+        Isolate isolate;
+        Object *fn{nullptr};
+    };
+
+    // a VM kept warm for one script, which it holds on to until the script is replaced
+    struct Warm {
+        std::shared_ptr<Script> script;
+        std::unique_ptr<VM> vm;
+
+        ~Warm();
+    };
+
+    // guards `scripts` and the maps in `warm`; a Warm itself is only used by its thread
+    std::shared_mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Script> > scripts;
+    // by thread, then by script name
+    std::unordered_map<std::thread::id, std::unordered_map<std::string, Warm> > warm;
+
+    std::string flightDirectory;
+    std::atomic<int> flights{0};
+
+    std::shared_ptr<Script> find(const std::string &name);
+
+    // where a new VM for the script `name` writes its flight recorder, or empty
+    std::string flightPath(const std::string &name);
+};
+
+#endif //SCRIPT_HOST_H
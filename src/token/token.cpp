@@ -5,5 +5,6 @@
 #include  "token.h"
 
 TokenType lookupIdent(std::string_view ident) {
-    return keywords.count(std::string(ident)) > 0 ? keywords[std::string(ident)] : IDENT;
+    const auto keyword = keywords.find(std::string(ident));
+    return keyword != keywords.end() ? keyword->second : IDENT;
 }
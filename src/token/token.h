@@ -12,53 +12,62 @@
 using TokenType = std::string;
 
 namespace TokenType_t {
-    inline TokenType ILLEGAL = "ILLEGAL";
-    inline TokenType EOF_ = "EOF";
+    inline const TokenType ILLEGAL = "ILLEGAL";
+    inline const TokenType EOF_ = "EOF";
 
     // Identifiers + literals
-    inline TokenType IDENT = "IDENT"; // add, foobar, x, y, ...
-    inline TokenType INT = "INT"; // 1343456
-    inline TokenType STRING = "STRING"; // "foobar"
+    inline const TokenType IDENT = "IDENT"; // add, foobar, x, y, ...
+    inline const TokenType INT = "INT"; // 1343456
+    inline const TokenType STRING = "STRING"; // "foobar"
 
     // Operators
-    inline TokenType ASSIGN = "=";
-    inline TokenType PLUS = "+";
-    inline TokenType MINUS = "-";
-    inline TokenType BANG = "!";
-    inline TokenType ASTERISK = "*";
-    inline TokenType SLASH = "/";
+    inline const TokenType ASSIGN = "=";
+    inline const TokenType PLUS = "+";
+    inline const TokenType MINUS = "-";
+    inline const TokenType BANG = "!";
+    inline const TokenType ASTERISK = "*";
+    inline const TokenType SLASH = "/";
 
-    inline TokenType LT = "<";
-    inline TokenType GT = ">";
+    inline const TokenType LT = "<";
+    inline const TokenType GT = ">";
 
-    inline TokenType EQ = "==";
-    inline TokenType NOT_EQ = "!=";
+    inline const TokenType EQ = "==";
+    inline const TokenType NOT_EQ = "!=";
 
     // Delimiters
-    inline TokenType COMMA = ",";
-    inline TokenType SEMICOLON = ";";
-    inline TokenType COLON = ":";
+    inline const TokenType COMMA = ",";
+    inline const TokenType SEMICOLON = ";";
+    inline const TokenType COLON = ":";
 
-    inline TokenType LPAREN = "(";
-    inline TokenType RPAREN = ")";
-    inline TokenType LBRACE = "{";
-    inline TokenType RBRACE = "}";
-    inline TokenType LBRACKET = "[";
-    inline TokenType RBRACKET = "]";
+    inline const TokenType LPAREN = "(";
+    inline const TokenType RPAREN = ")";
+    inline const TokenType LBRACE = "{";
+    inline const TokenType RBRACE = "}";
+    inline const TokenType LBRACKET = "[";
+    inline const TokenType RBRACKET = "]";
 
     // Keywords
-    inline TokenType FUNCTION = "FUNCTION";
-    inline TokenType LET = "LET";
-    inline TokenType TRUE = "TRUE";
-    inline TokenType FALSE = "FALSE";
-    inline TokenType IF = "IF";
-    inline TokenType ELSE = "ELSE";
-    inline TokenType RETURN = "RETURN";
+    inline const TokenType FUNCTION = "FUNCTION";
+    inline const TokenType LET = "LET";
+    inline const TokenType TRUE = "TRUE";
+    inline const TokenType FALSE = "FALSE";
+    inline const TokenType IF = "IF";
+    inline const TokenType ELSE = "ELSE";
+    inline const TokenType RETURN = "RETURN";
 }
 
+// Where a token starts in the source: byte offset, and 1-based line and column (in bytes).
+// Line 0 means unknown, as for tokens made by hand.
+struct Position {
+    int offset{0};
+    int line{0};
+    int column{0};
+};
+
 struct Token {
     TokenType type;
     std::string literal;
+    Position position{};
 
     Token() = default;
 
@@ -80,7 +89,7 @@ struct Token {
 
 using namespace TokenType_t;
 
-inline std::map<std::string, TokenType> keywords{
+inline const std::map<std::string, TokenType> keywords{
     {"fn", FUNCTION},
     {"let", LET},
     {"true", TRUE},
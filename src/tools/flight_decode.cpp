@@ -0,0 +1,31 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "../vm/flight_recorder.h"
+
+// Prints a flight recording, as a failed run or the REPL's `:flight <file>` writes it: the last calls, returns,
+// builtin calls, errors and allocation spikes of a VM, oldest first.
+
+int main(int argc, char *argv[]) {
+    if (argc != 2) {
+        std::cerr << "usage: flight_decode <flight recording>" << std::endl;
+        return 1;
+    }
+    const std::string path = argv[1];
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "cannot read " << path << std::endl;
+        return 1;
+    }
+    try {
+        FlightLog::read(in).print(std::cout);
+    } catch (const std::runtime_error &err) {
+        std::cerr << path << ": " << err.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,98 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "fmt/format.h"
+#include "../vm/heap_graph.h"
+
+// Reads a heap graph file, as the REPL's `:heap <file>` writes it, and prints which roots retain the most
+// memory: the size of everything that would be freed if the root let go of its object.
+
+namespace {
+    void printRoots(const HeapGraph &graph, const std::vector<size_t> &retained, const size_t top) {
+        auto roots = graph.nodes[0].edges;
+        std::sort(roots.begin(), roots.end());
+        roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+        std::stable_sort(roots.begin(), roots.end(), [&](const size_t a, const size_t b) {
+            return retained[a] > retained[b];
+        });
+        if (roots.size() > top) {
+            roots.resize(top);
+        }
+
+        std::cout << fmt::format("{:<32s}{:<22s}{:>12s}{:>14s}{:>8s}\n", "root", "kind", "shallow", "retained",
+                                 "share");
+        for (const auto id: roots) {
+            const auto &node = graph.nodes[id];
+            std::cout << fmt::format("{:<32s}{:<22s}{:>12d}{:>14d}{:>7.2f}%\n", node.name, node.kind, node.size,
+                                     retained[id], retained[0] == 0 ? 0.0 : 100.0 * retained[id] / retained[0]);
+        }
+    }
+
+    void printKinds(const HeapGraph &graph, const std::vector<size_t> &idom) {
+        std::map<std::string, std::pair<size_t, size_t> > kinds;
+        for (size_t id = 1; id < graph.nodes.size(); id++) {
+            if (idom[id] != HeapGraph::none) {
+                auto &[count, bytes] = kinds[graph.nodes[id].kind];
+                count++;
+                bytes += graph.nodes[id].size;
+            }
+        }
+        std::cout << fmt::format("\n{:<22s}{:>12s}{:>14s}\n", "kind", "objects", "bytes");
+        for (const auto &[kind, totals]: kinds) {
+            std::cout << fmt::format("{:<22s}{:>12d}{:>14d}\n", kind, totals.first, totals.second);
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string path;
+    size_t top = 20;
+    for (auto i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        if (arg.rfind("--top=", 0) == 0) {
+            top = std::stoul(arg.substr(6));
+        } else if (path.empty()) {
+            path = arg;
+        } else {
+            path.clear();
+            break;
+        }
+    }
+    if (path.empty()) {
+        std::cerr << "usage: heap_dominators <heap graph file> [--top=<roots>]" << std::endl;
+        return 1;
+    }
+
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "cannot read " << path << std::endl;
+        return 1;
+    }
+    HeapGraph graph;
+    try {
+        graph = HeapGraph::read(in);
+    } catch (const std::runtime_error &err) {
+        std::cerr << path << ": " << err.what() << std::endl;
+        return 1;
+    }
+    if (graph.nodes.empty()) {
+        std::cerr << path << ": no roots" << std::endl;
+        return 1;
+    }
+
+    const auto idom = graph.dominators();
+    const auto retained = graph.retainedSizes();
+    std::cout << fmt::format("{:d} objects, {:d} bytes reachable\n\n",
+                             std::count_if(idom.begin() + 1, idom.end(),
+                                           [](const size_t d) { return d != HeapGraph::none; }), retained[0]);
+    printRoots(graph, retained, top);
+    printKinds(graph, idom);
+    return 0;
+}
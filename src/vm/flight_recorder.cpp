@@ -0,0 +1,200 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "flight_recorder.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "../object/builtins.h"
+#include "../object/object.h"
+#include "fmt/format.h"
+
+namespace {
+    constexpr char magic[8] = {'M', 'K', 'F', 'L', 'I', 'G', 'H', '1'};
+
+    template<typename T>
+    void put(std::ostream &out, const T value) {
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+
+    template<typename T>
+    T get(std::istream &in) {
+        T value{};
+        if (!in.read(reinterpret_cast<char *>(&value), sizeof(T))) {
+            throw std::runtime_error("flight recording is truncated");
+        }
+        return value;
+    }
+
+    std::string functionName(const std::vector<Object *> &constants, const int64_t constant) {
+        const auto *fn = constant >= 0 && static_cast<size_t>(constant) < constants.size()
+                             ? dynamic_cast<CompiledFunction *>(constants[constant])
+                             : nullptr;
+        if (fn == nullptr) {
+            return "fn";
+        }
+        if (fn->name.empty()) {
+            const auto line = fn->lines.lineAt(0);
+            return line == 0 ? "fn" : "fn@" + std::to_string(line);
+        }
+        return fn->name;
+    }
+}
+
+FlightRecorder::FlightRecorder(const size_t capacity)
+    : lastTime(now()), lastAllocated(Heap::allocated()), startTicks(this->lastTime),
+      start(std::chrono::steady_clock::now()) {
+    size_t size = 1;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    this->ring.resize(size);
+    this->mask = size - 1;
+}
+
+void FlightRecorder::error(const std::string &message, const int depth) {
+    this->errors.push_back(message);
+    if (this->errors.size() > keptErrors) {
+        this->errors.pop_front();
+    }
+    // errors are rare enough to be stamped with their own time
+    if constexpr (enabled) {
+        this->stamp(depth);
+    }
+    this->record(Kind::Error, depth, this->errorCount++);
+}
+
+uint64_t FlightRecorder::recorded() const {
+    return this->count;
+}
+
+void FlightRecorder::write(std::ostream &out, const std::vector<Object *> &constants) const {
+    const auto kept = std::min<uint64_t>(this->count, this->ring.size());
+    const auto first = this->count - kept;
+
+    // ticks to nanoseconds, measured over the recorder's lifetime
+    const auto ticks = now() - this->startTicks;
+    const auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - this->start).count();
+    const auto scale = ticks == 0 ? 1.0 : static_cast<double>(nanoseconds) / static_cast<double>(ticks);
+
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, uint32_t> ids;
+    const auto intern = [&](const std::string &string) {
+        const auto [it, added] = ids.emplace(string, static_cast<uint32_t>(strings.size()));
+        if (added) {
+            strings.push_back(string);
+        }
+        return it->second;
+    };
+    std::vector<uint64_t> values(kept);
+    const auto firstError = this->errorCount - this->errors.size();
+    for (uint64_t i = 0; i < kept; i++) {
+        const auto &event = this->ring[(first + i) & this->mask];
+        switch (event.kind) {
+            case Kind::Enter:
+            case Kind::Exit:
+                values[i] = intern(functionName(constants, static_cast<int64_t>(event.value)));
+                break;
+            case Kind::Builtin:
+                values[i] = intern(getBuiltinName(*reinterpret_cast<const Builtin *>(event.value)));
+                break;
+            case Kind::Error:
+                values[i] = intern(event.value >= firstError
+                                       ? this->errors[event.value - firstError]
+                                       : "(message overwritten)");
+                break;
+            case Kind::AllocSpike:
+                values[i] = event.value;
+                break;
+        }
+    }
+
+    out.write(magic, sizeof(magic));
+    put(out, static_cast<uint64_t>(first));
+    put(out, static_cast<uint32_t>(strings.size()));
+    for (const auto &string: strings) {
+        put(out, static_cast<uint32_t>(string.size()));
+        out.write(string.data(), static_cast<std::streamsize>(string.size()));
+    }
+    put(out, static_cast<uint32_t>(kept));
+    const auto origin = kept == 0 ? 0 : this->ring[first & this->mask].time;
+    for (uint64_t i = 0; i < kept; i++) {
+        const auto &event = this->ring[(first + i) & this->mask];
+        put(out, static_cast<uint64_t>(static_cast<double>(event.time - origin) * scale));
+        put(out, event.kind);
+        put(out, event.depth);
+        put(out, values[i]);
+    }
+}
+
+FlightLog FlightLog::read(std::istream &in) {
+    char header[sizeof(magic)];
+    if (!in.read(header, sizeof(header)) || !std::equal(header, header + sizeof(header), magic)) {
+        throw std::runtime_error("not a flight recording");
+    }
+    FlightLog log;
+    log.lost = get<uint64_t>(in);
+
+    std::vector<std::string> strings(get<uint32_t>(in));
+    for (auto &string: strings) {
+        string.resize(get<uint32_t>(in));
+        if (!in.read(string.data(), static_cast<std::streamsize>(string.size()))) {
+            throw std::runtime_error("flight recording is truncated");
+        }
+    }
+
+    const auto count = get<uint32_t>(in);
+    for (uint32_t i = 0; i < count; i++) {
+        Entry entry{};
+        entry.nanoseconds = get<uint64_t>(in);
+        entry.kind = get<FlightRecorder::Kind>(in);
+        entry.depth = get<uint32_t>(in);
+        const auto value = get<uint64_t>(in);
+        if (entry.kind < FlightRecorder::Kind::Enter || entry.kind > FlightRecorder::Kind::AllocSpike) {
+            throw std::runtime_error(fmt::format("flight recording event {:d} has an unknown kind", i));
+        }
+        if (entry.kind == FlightRecorder::Kind::AllocSpike) {
+            entry.bytes = value;
+        } else if (value < strings.size()) {
+            entry.name = strings[value];
+        } else {
+            throw std::runtime_error(fmt::format("flight recording event {:d} names no string", i));
+        }
+        log.entries.push_back(std::move(entry));
+    }
+    return log;
+}
+
+void FlightLog::print(std::ostream &out) const {
+    if (this->lost != 0) {
+        out << fmt::format("({:d} earlier events overwritten)\n", this->lost);
+    }
+    out << fmt::format("{:>14s}{:>7s}  {:s}\n", "ms", "depth", "event");
+    for (const auto &entry: this->entries) {
+        const auto what = entry.kind == FlightRecorder::Kind::AllocSpike
+                              ? fmt::format("{:d} bytes", entry.bytes)
+                              : entry.name;
+        out << fmt::format("{:>14.3f}{:>7d}  {:<9s}{:s}\n", entry.nanoseconds / 1e6, entry.depth,
+                           kindName(entry.kind), what);
+    }
+}
+
+const char *FlightLog::kindName(const FlightRecorder::Kind kind) {
+    switch (kind) {
+        case FlightRecorder::Kind::Enter:
+            return "enter";
+        case FlightRecorder::Kind::Exit:
+            return "exit";
+        case FlightRecorder::Kind::Builtin:
+            return "builtin";
+        case FlightRecorder::Kind::Error:
+            return "error";
+        case FlightRecorder::Kind::AllocSpike:
+            return "alloc";
+    }
+    return "?";
+}
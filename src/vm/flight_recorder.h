@@ -0,0 +1,160 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../object/heap.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define FLIGHT_RECORDER_RDTSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define FLIGHT_RECORDER_RDTSC
+#endif
+
+class Builtin;
+class Object;
+
+// The last events of a VM, kept in a ring of fixed size that overwrites the oldest: calls of and returns from
+// compiled functions, builtin calls, errors, and allocation spikes. It is on unless built with
+// MONKEY_NO_FLIGHT_RECORDER, so recording an event is a few stores, and a time stamp and an allocation check
+// once every `stampEvery` events; the ring is written out when a run fails or on demand and read back by
+// FlightLog, e.g. in the flight_decode tool.
+class FlightRecorder {
+public:
+    enum class Kind : uint8_t { Enter = 1, Exit, Builtin, Error, AllocSpike };
+
+#ifdef MONKEY_NO_FLIGHT_RECORDER
+    static constexpr bool enabled = false;
+#else
+    static constexpr bool enabled = true;
+#endif
+
+    struct Event {
+        // time stamp counter where there is one, nanoseconds elsewhere; the events between two stamps carry the
+        // earlier one
+        uint64_t time;
+        // the function's constant index, the builtin's address, the error's number or the bytes allocated
+        uint64_t value;
+        uint32_t depth;
+        Kind kind;
+    };
+
+    // bytes allocated between two events that make a spike
+    static constexpr size_t spikeBytes = 1 << 20;
+    // error messages kept; older error events lose their message
+    static constexpr size_t keptErrors = 16;
+    // events per time stamp, a power of two; reading the clock costs more than the rest of an event
+    static constexpr uint64_t stampEvery = 16;
+
+    // Keeps the last `capacity` events, rounded up to a power of two.
+    explicit FlightRecorder(size_t capacity);
+
+    // `constant` is the index of the function in the constant pool, or -1
+    void enter(const int constant, const int depth) {
+        this->record(Kind::Enter, depth, static_cast<uint64_t>(static_cast<int64_t>(constant)));
+    }
+
+    void exit(const int constant, const int depth) {
+        this->record(Kind::Exit, depth, static_cast<uint64_t>(static_cast<int64_t>(constant)));
+    }
+
+    // the builtin is named when the ring is written, by its address alone, so it need not live that long
+    void builtin(const Builtin &builtin, const int depth) {
+        this->record(Kind::Builtin, depth, reinterpret_cast<uintptr_t>(&builtin));
+    }
+
+    void error(const std::string &message, int depth);
+
+    // events recorded so far, including those the ring has overwritten
+    uint64_t recorded() const;
+
+    // Writes the events in the ring, oldest first, naming functions after `constants`. Integers are written in
+    // the byte order of the machine.
+    void write(std::ostream &out, const std::vector<Object *> &constants) const;
+
+private:
+    // a power of two in size
+    std::vector<Event> ring;
+    uint64_t mask;
+    uint64_t count{0};
+    uint64_t lastTime;
+    size_t lastAllocated;
+    std::deque<std::string> errors;
+    uint64_t errorCount{0};
+    // where ticks are counted from, to convert them to nanoseconds when writing
+    uint64_t startTicks;
+    std::chrono::steady_clock::time_point start;
+
+    static uint64_t now() {
+#ifdef FLIGHT_RECORDER_RDTSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    void push(const Kind kind, const int depth, const uint64_t value) {
+        this->ring[this->count++ & this->mask] = {this->lastTime, value, static_cast<uint32_t>(depth), kind};
+    }
+
+    void stamp(const int depth) {
+        this->lastTime = now();
+        // a spike goes before the event that noticed it; the count is per thread, and a task may resume on
+        // another one, so it can go down
+        if (const auto allocated = Heap::allocated(); allocated < this->lastAllocated) {
+            this->lastAllocated = allocated;
+        } else if (allocated - this->lastAllocated >= spikeBytes) {
+            this->push(Kind::AllocSpike, depth, allocated - this->lastAllocated);
+            this->lastAllocated = allocated;
+        }
+    }
+
+    void record(const Kind kind, const int depth, const uint64_t value) {
+        if constexpr (enabled) {
+            if ((this->count & (stampEvery - 1)) == 0) {
+                this->stamp(depth);
+            }
+            this->push(kind, depth, value);
+        }
+    }
+};
+
+// A flight recording read back from what FlightRecorder::write wrote.
+struct FlightLog {
+    struct Entry {
+        // since the oldest event
+        uint64_t nanoseconds;
+        FlightRecorder::Kind kind;
+        uint32_t depth;
+        // the function, builtin or error message; empty for a spike
+        std::string name;
+        // allocated before a spike
+        uint64_t bytes;
+    };
+
+    // events the ring had overwritten before it was written
+    uint64_t lost{0};
+    std::vector<Entry> entries;
+
+    // Throws std::runtime_error if `in` is no flight recording.
+    static FlightLog read(std::istream &in);
+
+    // One line per event: time, depth, kind and what it names.
+    void print(std::ostream &out) const;
+
+    static const char *kindName(FlightRecorder::Kind kind);
+};
+
+#endif //FLIGHT_RECORDER_H
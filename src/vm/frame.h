@@ -12,6 +12,9 @@ struct Frame {
     int ip;
     int basePointer;
 
+    Frame() : cl(nullptr), ip(-1), basePointer(0) {
+    }
+
     Frame(Closure &closure, const int base_pointer)
         : cl(&closure),
           ip(-1), basePointer(base_pointer) {
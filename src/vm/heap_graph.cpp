@@ -0,0 +1,286 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "heap_graph.h"
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "fmt/format.h"
+#include "vm.h"
+#include "../object/heap.h"
+#include "../runtime/scheduler.h"
+
+namespace {
+    constexpr auto magic = "monkey-heap 1";
+
+    size_t shallowSize(Object &object) {
+        if (const auto string = dynamic_cast<String *>(&object)) {
+            return footprint(*string);
+        }
+        if (const auto array = dynamic_cast<Array *>(&object)) {
+            return footprint(*array);
+        }
+        if (const auto ints = dynamic_cast<IntArray *>(&object)) {
+            return footprint(*ints);
+        }
+        if (const auto hash = dynamic_cast<Hash *>(&object)) {
+            // a record's pairs, if built, only repeat its shape and slots
+            const auto pairs = hash->shape == nullptr ? hash->pairs().size() : 0;
+            return sizeof(Hash) + pairs * sizeof(HashTrie::value_type) +
+                   hash->slots.capacity() * sizeof(Object *);
+        }
+        if (const auto closure = dynamic_cast<Closure *>(&object)) {
+            return sizeof(Closure) + closure->fn.instructions.capacity() + closure->free.capacity() * sizeof(Object *);
+        }
+        if (const auto fn = dynamic_cast<CompiledFunction *>(&object)) {
+            return sizeof(CompiledFunction) + fn->instructions.capacity();
+        }
+        if (const auto error = dynamic_cast<Error *>(&object)) {
+            return sizeof(Error) + error->message.capacity();
+        }
+        if (dynamic_cast<Integer *>(&object) != nullptr) {
+            return sizeof(Integer);
+        }
+        return sizeof(Object);
+    }
+
+    void forEachReference(Object &object, const std::function<void(Object *)> &visit) {
+        if (const auto array = dynamic_cast<Array *>(&object)) {
+            for (const auto element: array->elements) {
+                visit(element);
+            }
+        } else if (const auto hash = dynamic_cast<Hash *>(&object)) {
+            if (hash->shape == nullptr) {
+                for (const auto &[_, pair]: hash->pairs()) {
+                    visit(pair.key);
+                    visit(pair.value);
+                }
+            }
+            visit(hash->shape);
+            for (const auto value: hash->slots) {
+                visit(value);
+            }
+        } else if (const auto closure = dynamic_cast<Closure *>(&object)) {
+            for (const auto free: closure->free) {
+                visit(free);
+            }
+        } else if (const auto shape = dynamic_cast<Shape *>(&object)) {
+            for (const auto key: shape->keys) {
+                visit(key);
+            }
+        } else if (const auto value = dynamic_cast<ReturnValue *>(&object)) {
+            visit(value->value);
+        } else if (const auto channel = dynamic_cast<Channel *>(&object)) {
+            std::lock_guard lock(channel->mutex);
+            for (const auto queued: channel->values) {
+                visit(queued);
+            }
+        }
+    }
+}
+
+HeapGraph HeapGraph::capture(const VM &vm, const std::vector<std::string> &globalNames) {
+    HeapGraph graph;
+    graph.nodes.push_back({"ROOTS", 0, "", {}});
+
+    // objects in the order of their ids, starting at 1; their edges are filled in breadth first
+    std::vector<Object *> objects;
+    std::unordered_map<Object *, size_t> ids;
+    const auto visit = [&](Object *object, const std::string &name) {
+        if (const auto it = ids.find(object); it != ids.end()) {
+            return it->second;
+        }
+        const auto id = graph.nodes.size();
+        ids.emplace(object, id);
+        objects.push_back(object);
+        auto label = name;
+        if (const auto closure = dynamic_cast<Closure *>(object); closure != nullptr && label.empty()) {
+            label = closure->fn.name;
+        }
+        graph.nodes.push_back({object->type(), shallowSize(*object), label, {}});
+        return id;
+    };
+    const auto root = [&](Object *object, const std::string &name) {
+        if (object != nullptr) {
+            // visiting may grow the nodes, so not inline
+            const auto id = visit(object, name);
+            graph.nodes[0].edges.push_back(id);
+        }
+    };
+
+    for (size_t i = 0; i < vm.globals->size(); i++) {
+        const auto known = i < globalNames.size() && !globalNames[i].empty();
+        root((*vm.globals)[i], known ? "global " + globalNames[i] : fmt::format("global #{:d}", i));
+    }
+    for (auto i = 0; i < vm.sp; i++) {
+        root(vm.stack[i], fmt::format("stack #{:d}", i));
+    }
+    for (auto i = 0; i < vm.framesIndex; i++) {
+        const auto closure = vm.frames[i].cl;
+        root(closure, i == 0 ? "main" : fmt::format("frame #{:d} {:s}", i, closure->fn.name));
+    }
+    for (size_t i = 0; i < vm.constants->size(); i++) {
+        root((*vm.constants)[i], fmt::format("constant #{:d}", i));
+    }
+
+    for (size_t next = 0; next < objects.size(); next++) {
+        std::vector<size_t> edges;
+        forEachReference(*objects[next], [&](Object *reference) {
+            if (reference != nullptr) {
+                edges.push_back(visit(reference, ""));
+            }
+        });
+        graph.nodes[next + 1].edges = std::move(edges);
+    }
+    return graph;
+}
+
+void HeapGraph::write(std::ostream &out) const {
+    out << magic << "\n" << this->nodes.size() << "\n";
+    for (size_t id = 0; id < this->nodes.size(); id++) {
+        const auto &node = this->nodes[id];
+        out << id << " " << node.kind << " " << node.size << " " << node.edges.size();
+        for (const auto edge: node.edges) {
+            out << " " << edge;
+        }
+        out << " " << node.name << "\n";
+    }
+}
+
+HeapGraph HeapGraph::read(std::istream &in) {
+    std::string line;
+    if (!std::getline(in, line) || line != magic) {
+        throw std::runtime_error("not a heap graph");
+    }
+    size_t count = 0;
+    if (!std::getline(in, line) || !(std::istringstream(line) >> count)) {
+        throw std::runtime_error("heap graph has no node count");
+    }
+
+    HeapGraph graph;
+    graph.nodes.resize(count);
+    for (size_t id = 0; id < count; id++) {
+        if (!std::getline(in, line)) {
+            throw std::runtime_error(fmt::format("heap graph ends after {:d} of {:d} nodes", id, count));
+        }
+        std::istringstream fields(line);
+        auto &node = graph.nodes[id];
+        size_t read = 0;
+        size_t edges = 0;
+        if (!(fields >> read >> node.kind >> node.size >> edges) || read != id) {
+            throw std::runtime_error(fmt::format("heap graph node {:d} is malformed", id));
+        }
+        node.edges.resize(edges);
+        for (auto &edge: node.edges) {
+            if (!(fields >> edge) || edge >= count) {
+                throw std::runtime_error(fmt::format("heap graph node {:d} has a bad edge", id));
+            }
+        }
+        fields.get();
+        std::getline(fields, node.name);
+    }
+    return graph;
+}
+
+// Cooper, Harvey and Kennedy's iterative algorithm: nodes are visited in reverse postorder until no immediate
+// dominator changes, intersecting the dominators of each node's predecessors on the way.
+std::vector<size_t> HeapGraph::dominators() const {
+    const auto n = this->nodes.size();
+    std::vector<size_t> idom(n, none);
+    if (n == 0) {
+        return idom;
+    }
+
+    // postorder by an explicit stack, as the graph can be far deeper than the native one
+    std::vector<size_t> postorder;
+    std::vector<size_t> number(n, none);
+    std::vector<bool> seen(n, false);
+    std::vector<std::pair<size_t, size_t> > stack{{0, 0}};
+    seen[0] = true;
+    while (!stack.empty()) {
+        auto &[node, edge] = stack.back();
+        if (edge < this->nodes[node].edges.size()) {
+            const auto next = this->nodes[node].edges[edge++];
+            if (!seen[next]) {
+                seen[next] = true;
+                stack.emplace_back(next, 0);
+            }
+            continue;
+        }
+        number[node] = postorder.size();
+        postorder.push_back(node);
+        stack.pop_back();
+    }
+
+    std::vector<std::vector<size_t> > predecessors(n);
+    for (const auto node: postorder) {
+        for (const auto next: this->nodes[node].edges) {
+            predecessors[next].push_back(node);
+        }
+    }
+
+    const auto intersect = [&](size_t a, size_t b) {
+        while (a != b) {
+            while (number[a] < number[b]) {
+                a = idom[a];
+            }
+            while (number[b] < number[a]) {
+                b = idom[b];
+            }
+        }
+        return a;
+    };
+
+    idom[0] = 0;
+    for (auto changed = true; changed;) {
+        changed = false;
+        for (auto it = postorder.rbegin(); it != postorder.rend(); ++it) {
+            if (*it == 0) {
+                continue;
+            }
+            auto dominator = none;
+            for (const auto predecessor: predecessors[*it]) {
+                if (idom[predecessor] != none) {
+                    dominator = dominator == none ? predecessor : intersect(predecessor, dominator);
+                }
+            }
+            if (idom[*it] != dominator) {
+                idom[*it] = dominator;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+std::vector<size_t> HeapGraph::retainedSizes() const {
+    const auto idom = this->dominators();
+    std::vector<size_t> retained(this->nodes.size(), 0);
+    std::vector<std::vector<size_t> > children(this->nodes.size());
+    for (size_t id = 1; id < this->nodes.size(); id++) {
+        if (idom[id] != none) {
+            children[idom[id]].push_back(id);
+        }
+    }
+
+    // children before their dominator, again without recursion
+    std::vector<size_t> order{0};
+    for (size_t i = 0; i < order.size(); i++) {
+        for (const auto child: children[order[i]]) {
+            order.push_back(child);
+        }
+    }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        retained[*it] += this->nodes[*it].size;
+        if (*it != 0) {
+            retained[idom[*it]] += retained[*it];
+        }
+    }
+    return retained;
+}
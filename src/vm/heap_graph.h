@@ -0,0 +1,52 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef HEAP_GRAPH_H
+#define HEAP_GRAPH_H
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class VM;
+
+// The objects reachable from a VM's roots and the references between them, written to and read from a heap
+// graph file. Node 0 stands for the roots: an edge from it leads to every object on the stack, in a global,
+// run by a live frame or in the constant pool, and those objects carry the name of the root.
+// Sizes are shallow: the object and the buffers it owns, not what it refers to.
+class HeapGraph {
+public:
+    static constexpr size_t none = static_cast<size_t>(-1);
+
+    struct Node {
+        // the object's type, or ROOTS for node 0
+        std::string kind;
+        size_t size{0};
+        // the root it was found at, or the function a closure runs; may be empty
+        std::string name;
+        std::vector<size_t> edges;
+    };
+
+    std::vector<Node> nodes;
+
+    // Walks the heap of `vm`, which must not be running. `globalNames` names globals by index; globals
+    // without a name are called by their index.
+    static HeapGraph capture(const VM &vm, const std::vector<std::string> &globalNames = {});
+
+    // One line per node: id, kind, size, edge count, edges, then the name up to the end of the line.
+    void write(std::ostream &out) const;
+
+    // Throws std::runtime_error if `in` is no heap graph.
+    static HeapGraph read(std::istream &in);
+
+    // Immediate dominator of every node: the node every path from node 0 to it passes through last.
+    // Node 0 is its own, nodes that cannot be reached have `none`.
+    std::vector<size_t> dominators() const;
+
+    // Size of every node and of all the nodes it dominates, which would be freed along with it.
+    std::vector<size_t> retainedSizes() const;
+};
+
+#endif //HEAP_GRAPH_H
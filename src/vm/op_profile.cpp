@@ -0,0 +1,128 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "op_profile.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+
+#ifdef OP_PROFILE_RDTSC
+const char *const OpProfile::unit = "cycles";
+#else
+const char *const OpProfile::unit = "ns";
+#endif
+
+namespace {
+    std::string nameOf(const int op) {
+        if (const auto def = lookup(static_cast<uint8_t>(op)); def != nullptr) {
+            return def->name;
+        }
+        return fmt::format("Op{:d}", op);
+    }
+}
+
+OpProfile::OpProfile()
+    : counts(numOps), pairs(numOps * numOps), histogram(numOps * numBuckets), elapsed(numOps) {
+}
+
+void OpProfile::sample(const uint64_t time) {
+    auto bucket = 0;
+    for (auto t = time; t != 0 && bucket < numBuckets - 1; t >>= 1) {
+        bucket++;
+    }
+    this->histogram[this->timed * numBuckets + bucket]++;
+    this->elapsed[this->timed] += time;
+    this->timed = -1;
+}
+
+uint64_t OpProfile::count(const OpCode op) const {
+    return this->counts[static_cast<int>(op)];
+}
+
+uint64_t OpProfile::pairCount(const OpCode first, const OpCode second) const {
+    return this->pairs[static_cast<int>(first) * numOps + static_cast<int>(second)];
+}
+
+uint64_t OpProfile::samples(const OpCode op) const {
+    uint64_t n = 0;
+    for (auto b = 0; b < numBuckets; b++) {
+        n += this->histogram[static_cast<int>(op) * numBuckets + b];
+    }
+    return n;
+}
+
+uint64_t OpProfile::median(const int op) const {
+    const auto n = this->samples(static_cast<OpCode>(op));
+    uint64_t seen = 0;
+    for (auto b = 0; b < numBuckets; b++) {
+        seen += this->histogram[op * numBuckets + b];
+        if (n > 0 && seen * 2 >= n) {
+            return b == 0 ? 0 : (uint64_t{1} << b) - 1;
+        }
+    }
+    return 0;
+}
+
+void OpProfile::report(std::ostream &out, const int topPairs) const {
+    std::vector<int> ops;
+    uint64_t total = 0;
+    for (auto op = 0; op < numOps; op++) {
+        if (this->counts[op] > 0) {
+            ops.push_back(op);
+            total += this->counts[op];
+        }
+    }
+    std::sort(ops.begin(), ops.end(), [this](const int a, const int b) { return this->counts[a] > this->counts[b]; });
+
+    out << fmt::format("{:<18s}{:>14s}{:>8s}{:>10s}{:>14s}{:>14s}\n", "opcode", "count", "share", "samples",
+                       fmt::format("mean {:s}", unit), fmt::format("p50 {:s}", unit));
+    for (const auto op: ops) {
+        const auto n = this->samples(static_cast<OpCode>(op));
+        out << fmt::format("{:<18s}{:>14d}{:>7.2f}%{:>10d}{:>14.1f}{:>14d}\n", nameOf(op), this->counts[op],
+                           100.0 * this->counts[op] / total, n,
+                           n == 0 ? 0.0 : static_cast<double>(this->elapsed[op]) / n, this->median(op));
+    }
+
+    std::vector<int> pairs;
+    for (auto i = 0; i < numOps * numOps; i++) {
+        if (this->pairs[i] > 0) {
+            pairs.push_back(i);
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [this](const int a, const int b) { return this->pairs[a] > this->pairs[b]; });
+    if (static_cast<int>(pairs.size()) > topPairs) {
+        pairs.resize(topPairs);
+    }
+
+    out << fmt::format("\n{:<36s}{:>14s}\n", "opcode pair", "count");
+    for (const auto pair: pairs) {
+        out << fmt::format("{:<36s}{:>14d}\n", nameOf(pair / numOps) + " " + nameOf(pair % numOps), this->pairs[pair]);
+    }
+}
+
+std::string OpProfile::toJson() const {
+    std::string ops;
+    std::string pairs;
+    for (auto op = 0; op < numOps; op++) {
+        if (this->counts[op] == 0) {
+            continue;
+        }
+        std::string buckets;
+        for (auto b = 0; b < numBuckets; b++) {
+            buckets += fmt::format("{:s}{:d}", b == 0 ? "" : ",", this->histogram[op * numBuckets + b]);
+        }
+        ops += fmt::format(R"({:s}"{:s}":{{"count":{:d},"samples":{:d},"elapsed":{:d},"histogram":[{:s}]}})",
+                           ops.empty() ? "" : ",", nameOf(op), this->counts[op],
+                           this->samples(static_cast<OpCode>(op)), this->elapsed[op], buckets);
+
+        for (auto next = 0; next < numOps; next++) {
+            if (const auto n = this->pairs[op * numOps + next]; n > 0) {
+                pairs += fmt::format(R"({:s}["{:s}","{:s}",{:d}])", pairs.empty() ? "" : ",", nameOf(op),
+                                     nameOf(next), n);
+            }
+        }
+    }
+    return fmt::format(R"({{"unit":"{:s}","samplePeriod":{:d},"ops":{{{:s}}},"pairs":[{:s}]}})", unit,
+                       samplePeriod, ops, pairs);
+}
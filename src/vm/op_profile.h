@@ -0,0 +1,99 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef OP_PROFILE_H
+#define OP_PROFILE_H
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../code/code.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define OP_PROFILE_RDTSC
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>
+#define OP_PROFILE_RDTSC
+#endif
+
+// What a VM's dispatch loop records while profiling: how often each opcode ran, how often each opcode ran
+// straight after another, and a histogram of how long sampled instructions took, in log2 buckets of `unit`.
+// One in every `samplePeriod` instructions is timed, from its dispatch to the dispatch of the next instruction.
+class OpProfile {
+public:
+    static constexpr int numOps = 256;
+    static constexpr int numBuckets = 32;
+    static constexpr uint64_t samplePeriod = 64;
+
+    // "cycles" where the time stamp counter is read directly, "ns" elsewhere
+    static const char *const unit;
+
+    OpProfile();
+
+    // Called by the dispatch loop before running each instruction.
+    void enter(OpCode op) {
+        const auto index = static_cast<int>(op);
+        if (this->timed >= 0) {
+            this->sample(now() - this->started);
+        }
+        this->counts[index]++;
+        if (this->previous >= 0) {
+            this->pairs[this->previous * numOps + index]++;
+        }
+        this->previous = index;
+        if (++this->total % samplePeriod == 0) {
+            this->timed = index;
+            this->started = now();
+        }
+    }
+
+    // Ends the instruction that is being timed, if any; the VM calls this when its dispatch loop returns.
+    void leave() {
+        if (this->timed >= 0) {
+            this->sample(now() - this->started);
+        }
+        this->previous = -1;
+    }
+
+    uint64_t count(OpCode op) const;
+
+    uint64_t pairCount(OpCode first, OpCode second) const;
+
+    uint64_t samples(OpCode op) const;
+
+    // Opcodes by count, with their share, mean and median sampled time, then the `topPairs` most frequent pairs.
+    void report(std::ostream &out, int topPairs = 20) const;
+
+    std::string toJson() const;
+
+    static uint64_t now() {
+#ifdef OP_PROFILE_RDTSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+private:
+    std::vector<uint64_t> counts;
+    std::vector<uint64_t> pairs;
+    // numBuckets per opcode; bucket b holds times t with bit_width(t) == b
+    std::vector<uint64_t> histogram;
+    std::vector<uint64_t> elapsed;
+    uint64_t total{0};
+    int previous{-1};
+    int timed{-1};
+    uint64_t started{0};
+
+    void sample(uint64_t time);
+
+    // upper bound of the bucket holding the median sample
+    uint64_t median(int op) const;
+};
+
+#endif //OP_PROFILE_H
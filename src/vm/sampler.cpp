@@ -0,0 +1,158 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "sampler.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <pthread.h>
+#include <signal.h>
+#include <sys/time.h>
+#endif
+
+#include "vm.h"
+
+namespace {
+    std::atomic<Sampler *> active{nullptr};
+#ifndef _WIN32
+    pthread_t sampledThread;
+    struct sigaction previousAction;
+#endif
+}
+
+Sampler::Sampler(const std::chrono::microseconds interval, const size_t bufferSize)
+    : interval(interval), buffer(bufferSize) {
+}
+
+Sampler::~Sampler() {
+    this->disarm();
+}
+
+void Sampler::start(const VM &vm) {
+#ifdef _WIN32
+    throw std::runtime_error("the sampling profiler needs SIGPROF, which this platform does not have");
+#else
+    if (Sampler *expected = nullptr; !active.compare_exchange_strong(expected, this)) {
+        throw std::runtime_error("another sampler is already running");
+    }
+    this->vm = &vm;
+    this->main = &vm.mainClosure->fn;
+    this->used = 0;
+    sampledThread = pthread_self();
+
+    struct sigaction action{};
+    action.sa_handler = &Sampler::onSignal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGPROF, &action, &previousAction);
+
+    const auto micros = this->interval.count();
+    itimerval timer{};
+    timer.it_interval.tv_sec = micros / 1000000;
+    timer.it_interval.tv_usec = micros % 1000000;
+    timer.it_value = timer.it_interval;
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    this->running = true;
+#endif
+}
+
+void Sampler::disarm() {
+#ifndef _WIN32
+    if (!this->running) {
+        return;
+    }
+    constexpr itimerval off{};
+    setitimer(ITIMER_PROF, &off, nullptr);
+    sigaction(SIGPROF, &previousAction, nullptr);
+    active = nullptr;
+    this->running = false;
+    this->vm = nullptr;
+#endif
+}
+
+void Sampler::stop() {
+#ifndef _WIN32
+    if (!this->running) {
+        return;
+    }
+    this->disarm();
+
+    const auto end = this->used.load();
+    for (size_t at = 0; at < end;) {
+        const auto depth = static_cast<int>(this->buffer[at++]);
+        const auto kept = std::min(depth, maxDepth);
+        std::string stack = depth > kept ? "[truncated]" : "";
+        for (auto i = 0; i < kept; i++) {
+            if (!stack.empty()) {
+                stack += ';';
+            }
+            stack += this->nameOf(this->buffer[at++]);
+        }
+        this->folded[stack]++;
+    }
+#endif
+}
+
+void Sampler::onSignal(int) {
+#ifndef _WIN32
+    const auto savedErrno = errno;
+    if (auto *sampler = active.load(); sampler != nullptr) {
+        if (pthread_equal(pthread_self(), sampledThread)) {
+            sampler->record();
+        } else {
+            ++sampler->missed;
+        }
+    }
+    errno = savedErrno;
+#endif
+}
+
+void Sampler::record() {
+    const auto depth = this->vm->framesIndex;
+    const auto kept = std::min(depth, maxDepth);
+    const auto at = this->used.load(std::memory_order_relaxed);
+    if (at + kept + 1 > this->buffer.size()) {
+        ++this->missed;
+        return;
+    }
+    this->buffer[at] = static_cast<uintptr_t>(depth);
+    for (auto i = 0; i < kept; i++) {
+        const auto *closure = this->vm->frames[depth - kept + i].cl;
+        this->buffer[at + 1 + i] = reinterpret_cast<uintptr_t>(closure == nullptr ? nullptr : &closure->fn);
+    }
+    this->used.store(at + kept + 1, std::memory_order_release);
+    ++this->taken;
+}
+
+std::string Sampler::nameOf(const uintptr_t fn) const {
+    const auto *function = reinterpret_cast<const CompiledFunction *>(fn);
+    if (function == this->main) {
+        return "main";
+    }
+    if (function == nullptr) {
+        return "fn";
+    }
+    if (function->name.empty()) {
+        const auto line = function->lines.lineAt(0);
+        return line == 0 ? "fn" : "fn@" + std::to_string(line);
+    }
+    return function->name;
+}
+
+void Sampler::writeFolded(std::ostream &out) const {
+    for (const auto &[stack, count]: this->folded) {
+        out << stack << ' ' << count << '\n';
+    }
+}
+
+uint64_t Sampler::samples() const {
+    return this->taken;
+}
+
+uint64_t Sampler::dropped() const {
+    return this->missed;
+}
@@ -0,0 +1,78 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class VM;
+class CompiledFunction;
+
+// Statistical profiler for Monkey functions. While running, a SIGPROF timer fires every `interval` of CPU time
+// the process uses, and the handler copies the VM's call stack (the function of every live frame) into a buffer
+// allocated up front; names are only looked up when sampling stops. Native profilers see just the dispatch loop,
+// this sees which Monkey functions it is running.
+//
+// One sampler can run at a time, for a VM running on the thread that started it. Ticks that land on other
+// threads are counted as dropped, as are stacks that no longer fit into the buffer.
+class Sampler {
+public:
+    explicit Sampler(std::chrono::microseconds interval = std::chrono::milliseconds(1),
+                     size_t bufferSize = size_t{1} << 20);
+
+    // Turns the timer off if still running, without folding what was recorded: the sampled VM may be gone.
+    ~Sampler();
+
+    Sampler(const Sampler &) = delete;
+
+    Sampler &operator=(const Sampler &) = delete;
+
+    // Throws std::runtime_error if another sampler is running, or where there is no SIGPROF.
+    void start(const VM &vm);
+
+    // Stops the timer and folds what was recorded. Must be called while the functions the sampled VM ran
+    // are still alive, that is before its heap is dropped.
+    void stop();
+
+    // One line per distinct stack, outermost function first: "main;fib;fib 42". Anonymous functions show
+    // as "fn@<line>", and the top-level program as "main". Deep stacks keep their innermost frames.
+    void writeFolded(std::ostream &out) const;
+
+    uint64_t samples() const;
+
+    uint64_t dropped() const;
+
+private:
+    static constexpr int maxDepth = 256;
+
+    std::chrono::microseconds interval;
+    // set only while running
+    const VM *vm{nullptr};
+    // the top-level program of the sampled VM, named "main"
+    const CompiledFunction *main{nullptr};
+    // each sample is the stack's depth followed by the functions of up to maxDepth of its innermost frames
+    std::vector<uintptr_t> buffer;
+    std::atomic<size_t> used{0};
+    std::atomic<uint64_t> taken{0};
+    std::atomic<uint64_t> missed{0};
+    std::map<std::string, uint64_t> folded;
+    bool running{false};
+
+    static void onSignal(int signal);
+
+    // Turns the timer off and gives SIGPROF its previous handler back.
+    void disarm();
+
+    void record();
+
+    std::string nameOf(uintptr_t fn) const;
+};
+
+#endif //SAMPLER_H
@@ -0,0 +1,467 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "vm.h"
+#include "../object/builtins.h"
+#include "../object/heap.h"
+#include "fmt/format.h"
+
+namespace {
+    constexpr char magic[8] = {'M', 'K', 'S', 'N', 'A', 'P', '0', '4'};
+    // reference to no object, e.g. an unset global
+    constexpr uint32_t none = UINT32_MAX;
+
+    enum class Kind : uint8_t {
+        Integer = 1, True, False, Null, String, Error, Array, IntArray, Hash, Shape, CompiledFunction, Closure,
+        Builtin,
+    };
+
+    class Writer {
+        std::unordered_map<Object *, uint32_t> ids;
+        std::unordered_set<Object *> visiting;
+
+    public:
+        std::string objects;
+        uint32_t count{0};
+
+        template<typename T>
+        static void put(std::string &out, const T value) {
+            out.append(reinterpret_cast<const char *>(&value), sizeof(T));
+        }
+
+        static void putString(std::string &out, const std::string &value) {
+            put(out, static_cast<uint32_t>(value.size()));
+            out.append(value);
+        }
+
+        static void putFunction(std::string &out, const CompiledFunction &fn) {
+            put(out, static_cast<uint32_t>(fn.instructions.size()));
+            out.append(reinterpret_cast<const char *>(fn.instructions.data()), fn.instructions.size());
+            put(out, static_cast<int32_t>(fn.numLocals));
+            put(out, static_cast<int32_t>(fn.numParameters));
+            putString(out, fn.name);
+            const auto &lines = fn.lines.encoded();
+            put(out, static_cast<uint32_t>(lines.size()));
+            out.append(reinterpret_cast<const char *>(lines.data()), lines.size());
+            put(out, static_cast<int32_t>(fn.constant));
+        }
+
+        // Writes `object` after everything it references and returns its index in the table.
+        uint32_t ref(Object *object) {
+            if (object == nullptr) {
+                return none;
+            }
+            if (const auto it = this->ids.find(object); it != this->ids.end()) {
+                return it->second;
+            }
+            if (!this->visiting.insert(object).second) {
+                throw std::runtime_error("cannot snapshot a value that contains itself");
+            }
+
+            std::string record;
+            const auto refs = [&](const std::vector<Object *> &children) {
+                // resolve first: children are written before the record that points at them
+                std::vector<uint32_t> indices;
+                indices.reserve(children.size());
+                for (auto *child: children) {
+                    indices.push_back(this->ref(child));
+                }
+                put(record, static_cast<uint32_t>(indices.size()));
+                for (const auto index: indices) {
+                    put(record, index);
+                }
+            };
+
+            if (const auto integer = dynamic_cast<Integer *>(object)) {
+                put(record, Kind::Integer);
+                put(record, integer->value);
+            } else if (const auto boolean = dynamic_cast<Boolean *>(object)) {
+                put(record, boolean->value ? Kind::True : Kind::False);
+            } else if (object->type() == NULL_OBJ) {
+                put(record, Kind::Null);
+            } else if (const auto string = dynamic_cast<String *>(object)) {
+                put(record, Kind::String);
+                putString(record, string->value);
+            } else if (const auto error = dynamic_cast<Error *>(object)) {
+                put(record, Kind::Error);
+                putString(record, error->message);
+            } else if (const auto array = dynamic_cast<Array *>(object)) {
+                std::string elements;
+                std::swap(record, elements);
+                refs(array->elements);
+                std::swap(record, elements);
+                put(record, Kind::Array);
+                record += elements;
+            } else if (const auto ints = dynamic_cast<IntArray *>(object)) {
+                put(record, Kind::IntArray);
+                put(record, static_cast<uint32_t>(ints->values.size()));
+                record.append(reinterpret_cast<const char *>(ints->values.data()), ints->values.size() * sizeof(int64_t));
+            } else if (const auto hash = dynamic_cast<Hash *>(object)) {
+                // a record's pairs are rebuilt from its shape and slots when loaded
+                std::vector<Object *> pairs;
+                if (hash->shape == nullptr) {
+                    for (const auto &[_, pair]: hash->pairs()) {
+                        pairs.push_back(pair.key);
+                        pairs.push_back(pair.value);
+                    }
+                }
+                const auto shape = this->ref(hash->shape);
+                std::string body;
+                std::swap(record, body);
+                refs(hash->slots);
+                refs(pairs);
+                std::swap(record, body);
+                put(record, Kind::Hash);
+                put(record, shape);
+                record += body;
+            } else if (const auto shape = dynamic_cast<Shape *>(object)) {
+                std::string keys;
+                std::swap(record, keys);
+                refs(std::vector<Object *>(shape->keys.begin(), shape->keys.end()));
+                std::swap(record, keys);
+                put(record, Kind::Shape);
+                record += keys;
+            } else if (const auto fn = dynamic_cast<CompiledFunction *>(object)) {
+                put(record, Kind::CompiledFunction);
+                putFunction(record, *fn);
+            } else if (const auto closure = dynamic_cast<Closure *>(object)) {
+                std::string free;
+                std::swap(record, free);
+                refs(closure->free);
+                std::swap(record, free);
+                put(record, Kind::Closure);
+                putFunction(record, closure->fn);
+                record += free;
+            } else if (const auto builtin = dynamic_cast<Builtin *>(object)) {
+                uint32_t index = none;
+                for (size_t i = 0; i < builtins.size(); i++) {
+                    if (builtins[i].second == builtin) {
+                        index = static_cast<uint32_t>(i);
+                    }
+                }
+                if (index == none) {
+                    throw std::runtime_error("cannot snapshot a host function; bind it again after loading");
+                }
+                put(record, Kind::Builtin);
+                put(record, index);
+            } else {
+                throw std::runtime_error(fmt::format("cannot snapshot a value of type {:s}", object->type()));
+            }
+
+            this->visiting.erase(object);
+            this->objects += record;
+            this->ids[object] = this->count;
+            return this->count++;
+        }
+    };
+
+    // The whole file, mapped read-only where the platform allows and read into memory otherwise.
+    class MappedFile {
+        const char *bytes{nullptr};
+        size_t length{0};
+        std::string copy;
+
+    public:
+        explicit MappedFile(const std::string &path) {
+#ifndef _WIN32
+            const auto fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error(fmt::format("cannot open snapshot {:s}", path));
+            }
+            struct stat info{};
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                auto *mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    this->bytes = static_cast<const char *>(mapped);
+                    this->length = info.st_size;
+                }
+            }
+            close(fd);
+            if (this->bytes != nullptr) {
+                return;
+            }
+#endif
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                throw std::runtime_error(fmt::format("cannot open snapshot {:s}", path));
+            }
+            this->copy.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            this->bytes = this->copy.data();
+            this->length = this->copy.size();
+        }
+
+        ~MappedFile() {
+#ifndef _WIN32
+            if (this->copy.empty() && this->bytes != nullptr) {
+                munmap(const_cast<char *>(this->bytes), this->length);
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        const char *data() const {
+            return this->bytes;
+        }
+
+        size_t size() const {
+            return this->length;
+        }
+    };
+
+    class Reader {
+        const char *data;
+        size_t size;
+        size_t pos{0};
+
+    public:
+        std::vector<Object *> objects;
+
+        Reader(const char *data, const size_t size) : data(data), size(size) {
+        }
+
+        const char *bytes(const size_t n) {
+            if (n > this->size - this->pos) {
+                throw std::runtime_error("corrupt snapshot: truncated");
+            }
+            const auto *at = this->data + this->pos;
+            this->pos += n;
+            return at;
+        }
+
+        // Throws unless `count` items of at least `each` bytes can fit in what is left, so a corrupt count is
+        // caught before anything is reserved for it.
+        void expect(const size_t count, const size_t each) {
+            if (count > (this->size - this->pos) / each) {
+                throw std::runtime_error("corrupt snapshot: truncated");
+            }
+        }
+
+        template<typename T>
+        T get() {
+            T value;
+            std::memcpy(&value, this->bytes(sizeof(T)), sizeof(T));
+            return value;
+        }
+
+        std::string string() {
+            const auto n = this->get<uint32_t>();
+            return {this->bytes(n), n};
+        }
+
+        Object *ref() {
+            const auto index = this->get<uint32_t>();
+            if (index == none) {
+                return nullptr;
+            }
+            if (index >= this->objects.size()) {
+                throw std::runtime_error("corrupt snapshot: bad reference");
+            }
+            return this->objects[index];
+        }
+
+        std::vector<Object *> refs() {
+            const auto n = this->get<uint32_t>();
+            this->expect(n, sizeof(uint32_t));
+            std::vector<Object *> values;
+            values.reserve(n);
+            for (uint32_t i = 0; i < n; i++) {
+                values.push_back(this->ref());
+            }
+            return values;
+        }
+
+        CompiledFunction function() {
+            const auto n = this->get<uint32_t>();
+            const auto *code = reinterpret_cast<const std::byte *>(this->bytes(n));
+            Instructions instructions(code, code + n);
+            const auto numLocals = this->get<int32_t>();
+            const auto numParameters = this->get<int32_t>();
+            CompiledFunction fn(std::move(instructions), numLocals, numParameters);
+            fn.name = this->string();
+            const auto numLines = this->get<uint32_t>();
+            const auto *lines = reinterpret_cast<const uint8_t *>(this->bytes(numLines));
+            fn.lines = LineTable(std::vector<uint8_t>(lines, lines + numLines));
+            fn.constant = this->get<int32_t>();
+            return fn;
+        }
+
+        template<typename T>
+        T *as(Object *object) {
+            auto *typed = dynamic_cast<T *>(object);
+            if (typed == nullptr) {
+                throw std::runtime_error("corrupt snapshot: unexpected object kind");
+            }
+            return typed;
+        }
+
+        Object *object() {
+            switch (this->get<Kind>()) {
+                case Kind::Integer:
+                    return make<Integer>(this->get<int64_t>());
+                case Kind::True:
+                    return VM::True;
+                case Kind::False:
+                    return VM::False;
+                case Kind::Null:
+                    return VM::Null;
+                case Kind::String:
+                    return make<String>(this->string());
+                case Kind::Error:
+                    return make<Error>(this->string());
+                case Kind::Array:
+                    return make<Array>(this->refs());
+                case Kind::IntArray: {
+                    const auto n = this->get<uint32_t>();
+                    const auto *values = reinterpret_cast<const char *>(this->bytes(n * sizeof(int64_t)));
+                    std::vector<int64_t> copy(n);
+                    std::memcpy(copy.data(), values, n * sizeof(int64_t));
+                    return make<IntArray>(std::move(copy));
+                }
+                case Kind::Hash: {
+                    auto *shape = this->ref();
+                    auto slots = this->refs();
+                    const auto flat = this->refs();
+                    if (shape != nullptr) {
+                        return make<Hash>(*this->as<Shape>(shape), std::move(slots));
+                    }
+                    HashTrie pairs;
+                    for (size_t i = 0; i + 1 < flat.size(); i += 2) {
+                        auto *key = this->as<Hashable>(flat[i]);
+                        pairs = pairs.set(key->hash_key(), HashPair(*flat[i], *flat[i + 1]));
+                    }
+                    return make<Hash>(std::move(pairs));
+                }
+                case Kind::Shape: {
+                    std::vector<String *> keys;
+                    for (auto *key: this->refs()) {
+                        keys.push_back(this->as<String>(key));
+                    }
+                    return make<Shape>(keys);
+                }
+                case Kind::CompiledFunction: {
+                    return make<CompiledFunction>(this->function());
+                }
+                case Kind::Closure: {
+                    const auto fn = this->function();
+                    return make<Closure>(fn, this->refs());
+                }
+                case Kind::Builtin: {
+                    const auto index = this->get<uint32_t>();
+                    if (index >= builtins.size()) {
+                        throw std::runtime_error("corrupt snapshot: unknown builtin");
+                    }
+                    return builtins[index].second;
+                }
+            }
+            throw std::runtime_error("corrupt snapshot: unknown object kind");
+        }
+    };
+}
+
+void Snapshot::save(const std::string &path, const std::vector<Object *> &constants,
+                    const std::vector<Object *> &globals, const SymbolTable *symbols) {
+    Writer writer;
+    std::string tail;
+    Writer::put(tail, static_cast<uint32_t>(constants.size()));
+    for (auto *constant: constants) {
+        Writer::put(tail, writer.ref(constant));
+    }
+    // unset slots at the end are left out; `load` pads back to the full size
+    auto used = globals.size();
+    while (used > 0 && globals[used - 1] == nullptr) {
+        used--;
+    }
+    Writer::put(tail, static_cast<uint32_t>(used));
+    for (size_t i = 0; i < used; i++) {
+        // host functions bound as globals are left out for the host to bind again
+        const auto builtin = dynamic_cast<Builtin *>(globals[i]);
+        const auto host = builtin != nullptr && std::none_of(builtins.begin(), builtins.end(), [&](const auto &entry) {
+            return entry.second == builtin;
+        });
+        Writer::put(tail, writer.ref(host ? nullptr : globals[i]));
+    }
+
+    std::vector<const Symbol *> names;
+    if (symbols != nullptr) {
+        for (const auto &[_, symbol]: symbols->store) {
+            if (symbol.scope == GlobalScope) {
+                names.push_back(&symbol);
+            }
+        }
+    }
+    Writer::put(tail, static_cast<int32_t>(symbols != nullptr ? symbols->num_definitions : 0));
+    Writer::put(tail, static_cast<uint32_t>(names.size()));
+    for (const auto *symbol: names) {
+        Writer::putString(tail, symbol->name);
+        Writer::put(tail, static_cast<int32_t>(symbol->index));
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(magic, sizeof(magic));
+    const auto count = writer.count;
+    file.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    file.write(writer.objects.data(), static_cast<std::streamsize>(writer.objects.size()));
+    file.write(tail.data(), static_cast<std::streamsize>(tail.size()));
+    if (!file) {
+        throw std::runtime_error(fmt::format("cannot write snapshot {:s}", path));
+    }
+}
+
+void Snapshot::save(const std::string &path, const VM &vm, const SymbolTable *symbols) {
+    save(path, *vm.constants, *vm.globals, symbols);
+}
+
+Snapshot::Image Snapshot::load(const std::string &path, SymbolTable *symbols) {
+    const MappedFile file(path);
+    Reader reader(file.data(), file.size());
+    if (std::memcmp(reader.bytes(sizeof(magic)), magic, sizeof(magic)) != 0) {
+        throw std::runtime_error(fmt::format("{:s} is not a snapshot", path));
+    }
+
+    const auto count = reader.get<uint32_t>();
+    // every object takes at least its kind
+    reader.expect(count, 1);
+    reader.objects.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+        reader.objects.push_back(reader.object());
+    }
+
+    ByteCode code;
+    code.constants = reader.refs();
+    auto globals = std::make_shared<std::vector<Object *> >(reader.refs());
+    globals->resize(std::max<size_t>(globals->size(), __globals__size));
+
+    const auto numDefinitions = reader.get<int32_t>();
+    const auto numNames = reader.get<uint32_t>();
+    for (uint32_t i = 0; i < numNames; i++) {
+        auto name = reader.string();
+        const auto index = reader.get<int32_t>();
+        if (symbols != nullptr) {
+            symbols->store[name] = Symbol(name, GlobalScope, index);
+        }
+    }
+    if (symbols != nullptr) {
+        symbols->num_definitions = std::max(symbols->num_definitions, numDefinitions);
+    }
+    return {std::make_shared<const ByteCode>(std::move(code)), std::move(globals)};
+}
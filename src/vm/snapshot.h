@@ -0,0 +1,47 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../compiler/compiler.h"
+#include "../compiler/symbol_table.h"
+
+class VM;
+
+// Saves the state a program has built once its top-level code ran (constants, globals and every object
+// they reach, closures with their free variables included) so a later process can start from it without
+// running that code again.
+//
+// The file is a flat table of objects in dependency order: references are table indices, which loading
+// relocates to the rebuilt objects' addresses. Loading maps the file and decodes it in one pass, copying
+// integer arrays straight out of the mapping. Snapshots are only read back by the same build on the same
+// kind of machine.
+class Snapshot {
+public:
+    // What `load` rebuilds. `code` holds the saved constants and no main instructions, so a VM made from
+    // it with `globals` picks up where the saved program left off and `run` has nothing to redo.
+    struct Image {
+        std::shared_ptr<const ByteCode> code;
+        std::shared_ptr<std::vector<Object *> > globals;
+    };
+
+    // Writes `constants` and `globals` to `path`, with the global names of `symbols` if given.
+    // Host functions bound as globals are left unset. Throws std::runtime_error for other values that cannot
+    // be saved, such as channels or host functions captured by closures.
+    static void save(const std::string &path, const std::vector<Object *> &constants,
+                     const std::vector<Object *> &globals, const SymbolTable *symbols = nullptr);
+
+    static void save(const std::string &path, const VM &vm, const SymbolTable *symbols = nullptr);
+
+    // Reads a snapshot written by `save`. Rebuilt objects are allocated into the current heap.
+    // If `symbols` is given, the saved global names are defined in it at their saved indices.
+    // Throws std::runtime_error if the file cannot be read or is not a valid snapshot.
+    static Image load(const std::string &path, SymbolTable *symbols = nullptr);
+};
+
+#endif //SNAPSHOT_H
@@ -4,15 +4,22 @@
 
 #include "vm.h"
 
+#include <algorithm>
+#include <array>
+#include <fstream>
 #include <functional>
+#include <optional>
 #include <stdexcept>
 
 #include "../common/common.h"
+#include "../object/heap.h"
+#include "../runtime/scheduler.h"
+#include "op_profile.h"
 #include "fmt/format.h"
 
-Boolean *VM::True = new Boolean(true);
-Boolean *VM::False = new Boolean(false);
-OBJ::Null *VM::Null = new OBJ::Null();
+Boolean *const VM::True = new Boolean(true);
+Boolean *const VM::False = new Boolean(false);
+OBJ::Null *const VM::Null = new OBJ::Null();
 
 Boolean *nativeBoolToBooleanObject(const bool input) {
     return input ? VM::True : VM::False;
@@ -29,8 +36,23 @@ bool isTruthy(Object &object) {
     return true;
 }
 
+namespace {
+    // opcode names, as the allocation sites of the instructions
+    const std::array<const char *, 256> &siteNames() {
+        static const auto names = [] {
+            std::array<const char *, 256> names{};
+            names.fill("OpUnknown");
+            for (const auto &[op, definition]: definitions) {
+                names[static_cast<uint8_t>(op)] = definition.name.c_str();
+            }
+            return names;
+        }();
+        return names;
+    }
+}
+
 void VM::push(Object &object) {
-    if (this->sp >= __stack__size) {
+    if (this->sp >= static_cast<int>(this->stack.size())) {
         throw std::runtime_error("stack overflow");
     }
     this->stack[this->sp] = &object;
@@ -86,7 +108,7 @@ void VM::executeBinaryIntegerOperation(OpCode op, Object &left, Object &right) {
             throw std::runtime_error(fmt::format("unknown integer operator: {:d}", static_cast<int>(op)));
     }
 
-    this->push(*new Integer(result));
+    this->push(*make<Integer>(result));
 }
 
 void VM::executeComparison(OpCode op) {
@@ -161,7 +183,7 @@ void VM::executeMinusOperator() {
     }
 
     const auto value = dynamic_cast<Integer *>(operand)->value;
-    this->push(*new Integer(-value));
+    this->push(*make<Integer>(-value));
 }
 
 void VM::executeBinaryStringOperation(OpCode op, Object &left, Object &right) {
@@ -172,7 +194,7 @@ void VM::executeBinaryStringOperation(OpCode op, Object &left, Object &right) {
     const auto leftValue = dynamic_cast<String *>(&left)->value;
     const auto rightValue = dynamic_cast<String *>(&right)->value;
 
-    this->push(*new String(leftValue + rightValue));
+    this->push(*make<String>(leftValue + rightValue));
 }
 
 Object *VM::buildArray(const int startIndex, const int endIndex) const {
@@ -183,7 +205,7 @@ Object *VM::buildArray(const int startIndex, const int endIndex) const {
         elements.push_back(this->stack[i]);
     }
 
-    return new Array(elements);
+    return make<Array>(elements);
 }
 
 Object *VM::buildHash(const int startIndex, const int endIndex) const {
@@ -193,16 +215,19 @@ Object *VM::buildHash(const int startIndex, const int endIndex) const {
         const auto key = this->stack[i];
         const auto value = this->stack[i + 1];
 
-        const auto pair = new HashPair(*key, *value);
-
         const auto hashKey = dynamic_cast<Hashable *>(key);
         if (hashKey == nullptr) {
             throw std::runtime_error(fmt::format("unusable as hash key: {:s}", key->type()));
         }
 
-        hashedPairs[hashKey->hash_key()] = *pair;
+        hashedPairs[hashKey->hash_key()] = HashPair(*key, *value);
     }
-    return new Hash(hashedPairs);
+    return make<Hash>(hashedPairs);
+}
+
+Object *VM::buildRecord(Shape &shape, const int startIndex) const {
+    const auto begin = this->stack.begin() + startIndex;
+    return make<Hash>(shape, std::vector(begin, begin + static_cast<long>(shape.keys.size())));
 }
 
 void VM::executeIndexExpression(Object &left, Object &index) {
@@ -216,8 +241,15 @@ void VM::executeIndexExpression(Object &left, Object &index) {
 }
 
 void VM::executeArrayIndex(Object &array, Object &index) {
-    const auto arrayObject = dynamic_cast<Array *>(&array);
     const auto i = dynamic_cast<Integer *>(&index)->value;
+    if (const auto ints = dynamic_cast<IntArray *>(&array)) {
+        if (i < 0 || i >= static_cast<int64_t>(ints->values.size())) {
+            return this->push(*Null);
+        }
+        return this->push(*make<Integer>(ints->values[i]));
+    }
+
+    const auto arrayObject = dynamic_cast<Array *>(&array);
     if (i < 0 || i > static_cast<int64_t>(arrayObject->elements.size() - 1)) {
         return this->push(*Null);
     }
@@ -232,25 +264,55 @@ void VM::executeHashIndex(Object &hash, Object &index) {
         throw std::runtime_error(fmt::format("unusable as hash key: {:s}", index.type()));
     }
 
-    if (hashObject->pairs.find(key->hash_key()) == hashObject->pairs.end()) {
+    // a record answers string keys from its slots, without building its pairs
+    if (const auto str = dynamic_cast<String *>(&index); str != nullptr && hashObject->shape != nullptr) {
+        const auto slot = hashObject->shape->slotOf(str->value);
+        return this->push(slot >= 0 ? *hashObject->slots[slot] : *Null);
+    }
+
+    const auto hash_pair = hashObject->pairs().get(key->hash_key());
+    if (hash_pair == nullptr) {
         return this->push(*Null);
     }
-    const auto hash_pair = hashObject->pairs[key->hash_key()];
-    return this->push(*hash_pair.value);
+    return this->push(*hash_pair->value);
+}
+
+void VM::executeConstKeyIndex(Object &left, const int constIndex) {
+    if (const auto hash = dynamic_cast<Hash *>(&left); hash != nullptr && hash->shape != nullptr) {
+        auto &cache = this->inlineCaches[constIndex];
+        if (cache.shape == hash->shape) {
+            return this->push(*hash->slots[cache.slot]);
+        }
+
+        const auto key = dynamic_cast<String *>((*this->constants)[constIndex]);
+        const auto slot = hash->shape->slotOf(key->value);
+        if (slot < 0) {
+            return this->push(*Null);
+        }
+        cache = {hash->shape, slot};
+        return this->push(*hash->slots[slot]);
+    }
+    return this->executeIndexExpression(left, *(*this->constants)[constIndex]);
 }
 
-Frame *VM::currentFrame() const {
-    return this->frames[this->framesIndex - 1];
+Frame *VM::currentFrame() {
+    return &this->frames[this->framesIndex - 1];
 }
 
-void VM::pushFrame(Frame &frame) {
-    this->frames[this->framesIndex] = &frame;
+void VM::pushFrame(const Frame &frame) {
+    if (this->framesIndex >= static_cast<int>(this->frames.size())) {
+        throw std::runtime_error("frame overflow");
+    }
+    this->frames[this->framesIndex] = frame;
     this->framesIndex++;
+    this->flight.enter(frame.cl->fn.constant, this->framesIndex);
 }
 
 Frame *VM::popFrame() {
+    const auto frame = &this->frames[this->framesIndex - 1];
+    this->flight.exit(frame->cl->fn.constant, this->framesIndex);
     this->framesIndex--;
-    return this->frames[this->framesIndex];
+    return frame;
 }
 
 void VM::executeCall(const int numArgs) {
@@ -272,16 +334,21 @@ void VM::callClosure(Closure *cl, int numArgs) {
                                              cl->fn.numParameters, numArgs));
     }
 
-    const auto frame = new Frame(*cl, this->sp - numArgs);
-    this->pushFrame(*frame);
+    this->pushFrame(Frame(*cl, this->sp - numArgs));
 
-    this->sp = frame->basePointer + cl->fn.numLocals;
+    this->sp = this->currentFrame()->basePointer + cl->fn.numLocals;
 }
 
 void VM::callBuiltin(const Builtin *builtin, const int numArgs) {
-    auto args = std::vector(this->stack.begin() + this->sp - numArgs, this->stack.begin() + this->sp);
+    // the arguments stay on the stack; anything the builtin calls back into is pushed above them
+    const ArgSpan args(this->stack.data() + this->sp - numArgs, numArgs);
 
-    auto result = builtin->fn(args);
+    this->flight.builtin(*builtin, this->framesIndex);
+    auto result = builtin->call(args, *this);
+    if (this->parked) {
+        // leave callee and arguments in place for the retry
+        return;
+    }
     this->sp = this->sp - numArgs - 1;
 
     if (result != nullptr) {
@@ -292,7 +359,7 @@ void VM::callBuiltin(const Builtin *builtin, const int numArgs) {
 }
 
 void VM::pushClosure(const int constIndex, const int numFree) {
-    const auto constant = this->constants[constIndex];
+    const auto constant = (*this->constants)[constIndex];
     const auto function = dynamic_cast<CompiledFunction *>(constant);
     if (function == nullptr) {
         throw std::runtime_error(fmt::format("not a function: {:s}", constant->inspect()));
@@ -304,30 +371,465 @@ void VM::pushClosure(const int constIndex, const int numFree) {
         free.push_back(this->stack[this->sp - numFree + i]);
     }
     this->sp = this->sp - numFree;
-    this->push(*new Closure(*function, free));
+    this->push(*make<Closure>(*function, free));
 }
 
 Object *VM::lastPoppedStackElem() const {
     return this->stack[this->sp];
 }
 
-void VM::run() {
+uint64_t VM::executed() const {
+    return this->steps;
+}
+
+VM::VM(std::shared_ptr<const std::vector<Object *> > constants, std::shared_ptr<std::vector<Object *> > globals,
+       const Instructions &main, LineTable lines, const int stackSize, const int maxFrames)
+    : constants(std::move(constants)), globals(std::move(globals)), sp(0), framesIndex(1),
+      flight(static_cast<size_t>(maxFrames) * 2) {
+    this->mainClosure = std::make_unique<Closure>(CompiledFunction(main));
+    this->mainClosure->fn.lines = std::move(lines);
+
+    this->inlineCaches = std::vector<InlineCache>(this->constants->size());
+    this->stack = std::vector<Object *>(stackSize);
+    this->frames = std::vector<Frame>(maxFrames);
+
+    this->frames[0] = Frame(*this->mainClosure, 0);
+}
+
+VM::~VM() {
+    this->joinTasks();
+}
+
+void VM::joinTasks() {
+    // tasks share the group with their spawner, which drains it
+    if (this->group != nullptr && this->fiber == nullptr) {
+        this->group->drain();
+        this->group.reset();
+    }
+}
+
+Object *VM::callFunction(Object &fn, ArgSpan args) {
+    if (const auto builtin = dynamic_cast<Builtin *>(&fn)) {
+        if (const auto result = builtin->call(args, *this); result != nullptr) {
+            return result;
+        }
+        return Null;
+    }
+    const auto closure = dynamic_cast<Closure *>(&fn);
+    if (closure == nullptr) {
+        throw std::runtime_error("calling non-closure and non-builtin");
+    }
+    return this->invoke(closure, args);
+}
+
+Object *VM::invoke(Closure *closure, const ArgSpan args) {
+    const auto savedSp = this->sp;
+    const auto savedFramesIndex = this->framesIndex;
+    // builtins such as `map` call back in here without going through OpCall
+    if (this->steps >= this->checkpoint) {
+        this->checkBudget();
+    }
+    this->nesting++;
+    this->entered++;
+    try {
+        // lay out callee and arguments exactly like OpCall would, above everything still live
+        this->push(*closure);
+        for (const auto arg: args) {
+            this->push(*arg);
+        }
+        const auto floor = this->framesIndex + 1;
+        this->callClosure(closure, static_cast<int>(args.size()));
+        this->execute(floor);
+        this->nesting--;
+        this->leave(nullptr);
+        return this->pop();
+    } catch (const std::runtime_error &err) {
+        // unwind whatever the failed call left behind so the caller's frames and stack are intact
+        this->nesting--;
+        this->leave(&err);
+        this->sp = savedSp;
+        this->framesIndex = savedFramesIndex;
+        throw;
+    } catch (...) {
+        this->nesting--;
+        this->leave(nullptr);
+        this->sp = savedSp;
+        this->framesIndex = savedFramesIndex;
+        throw;
+    }
+}
+
+template<typename Argument>
+void VM::invokeBatch(Closure *closure, const size_t numRows, Argument argument, Object **out) {
+    const auto numParameters = closure->fn.numParameters;
+    const auto savedSp = this->sp;
+    const auto savedFramesIndex = this->framesIndex;
+    // callee at savedSp, arguments and locals from base up
+    const auto base = savedSp + 1;
+    if (base + closure->fn.numLocals >= static_cast<int>(this->stack.size())) {
+        throw std::runtime_error("stack overflow");
+    }
+    if (savedFramesIndex >= static_cast<int>(this->frames.size())) {
+        throw std::runtime_error("frame overflow");
+    }
+
+    const auto floor = savedFramesIndex + 1;
+    // a batch is a series of `invoke`s: budgeted before every call, and nested for `receive`
+    this->nesting++;
+    this->entered++;
+    try {
+        for (size_t row = 0; row < numRows; row++) {
+            if (this->steps >= this->checkpoint) {
+                this->checkBudget();
+            }
+            this->stack[savedSp] = closure;
+            for (auto i = 0; i < numParameters; i++) {
+                this->stack[base + i] = argument(row, i);
+            }
+            this->frames[savedFramesIndex] = Frame(*closure, base);
+            this->framesIndex = floor;
+            this->flight.enter(closure->fn.constant, floor);
+            this->sp = base + closure->fn.numLocals;
+
+            this->execute(floor);
+            // the return leaves the result in the callee slot
+            out[row] = this->stack[savedSp];
+        }
+    } catch (const std::runtime_error &err) {
+        this->nesting--;
+        this->leave(&err);
+        this->sp = savedSp;
+        this->framesIndex = savedFramesIndex;
+        throw;
+    } catch (...) {
+        this->nesting--;
+        this->leave(nullptr);
+        this->sp = savedSp;
+        this->framesIndex = savedFramesIndex;
+        throw;
+    }
+    this->nesting--;
+    this->leave(nullptr);
+    this->sp = savedSp;
+}
+
+void VM::invokeRows(Closure *closure, const ArgSpan rows, Object **out, const size_t nullaryRows) {
+    const auto numParameters = static_cast<size_t>(closure->fn.numParameters);
+    if (numParameters == 0 ? !rows.empty() : rows.size() % numParameters != 0) {
+        throw std::runtime_error(fmt::format("wrong number of arguments: want a multiple of {:d}, got={:d}",
+                                             numParameters, rows.size()));
+    }
+    const auto numRows = numParameters == 0 ? nullaryRows : rows.size() / numParameters;
+    this->invokeBatch(closure, numRows, [&](const size_t row, const int i) {
+        return rows[row * numParameters + i];
+    }, out);
+}
+
+void VM::invokeColumns(Closure *closure, const std::vector<ArgSpan> &columns, Object **out,
+                       const size_t nullaryRows) {
+    if (static_cast<int>(columns.size()) != closure->fn.numParameters) {
+        throw std::runtime_error(fmt::format("wrong number of arguments: want={:d}, got={:d}",
+                                             closure->fn.numParameters, columns.size()));
+    }
+    const auto numRows = columns.empty() ? nullaryRows : columns[0].size();
+    for (const auto &column: columns) {
+        if (column.size() != numRows) {
+            throw std::runtime_error("columns must all have the same length");
+        }
+    }
+    this->invokeBatch(closure, numRows, [&](const size_t row, const int i) {
+        return columns[i][row];
+    }, out);
+}
+
+std::vector<std::unique_ptr<Caller> > VM::isolates(Object &fn, const size_t count, std::string &error) {
+    std::vector<Object *> visited;
+    error = this->impurity(fn, visited);
+    if (!error.empty()) {
+        return {};
+    }
+    std::vector<std::unique_ptr<Caller> > isolates;
+    isolates.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        // an isolate has an empty main frame; it only ever runs functions through `callFunction`
+        isolates.push_back(std::unique_ptr<Caller>(new VM(this->constants, this->globals, {})));
+    }
+    return isolates;
+}
+
+void VM::spawn(Object &fn, const ArgSpan args, std::string &error) {
+    const auto closure = dynamic_cast<Closure *>(&fn);
+    if (closure == nullptr) {
+        error = fmt::format("argument to `spawn` must be FUNCTION, got {:s}", fn.type());
+        return;
+    }
+    if (static_cast<int>(args.size()) != closure->fn.numParameters) {
+        error = fmt::format("wrong number of arguments: want={:d}, got={:d}", closure->fn.numParameters,
+                            args.size());
+        return;
+    }
+    std::vector<Object *> visited;
+    if (error = this->impurity(fn, visited); !error.empty()) {
+        error = "argument to `spawn` must be a pure function: " + error;
+        return;
+    }
+
+    if (this->group == nullptr) {
+        this->group = std::make_shared<TaskGroup>(Heap::current());
+    }
+    if (this->fiber != nullptr) {
+        // a task's constants are already a copy
+        this->taskConstants = this->constants;
+    } else if (this->taskConstants == nullptr || this->taskConstants->size() != this->constants->size()) {
+        this->taskConstants = std::make_shared<const std::vector<Object *> >(*this->constants);
+    }
+    auto vm = std::unique_ptr<VM>(new VM(this->taskConstants, this->globals, {}, {}, __task__stack__size,
+                                         __task__max__frames));
+    vm->group = this->group;
+    vm->push(*closure);
+    for (const auto arg: args) {
+        vm->push(*arg);
+    }
+    vm->callClosure(closure, static_cast<int>(args.size()));
+
+    auto &task = this->group->add(std::move(vm), Heap::current() != nullptr);
+    task.vm->fiber = &task;
+    this->group->schedule(task);
+}
+
+Object *VM::receive(Channel &channel, std::string &error) {
+    if (this->fiber == nullptr || this->nesting > 0) {
+        return TaskGroup::await(this->group.get(), channel, error);
+    }
+    std::lock_guard lock(channel.mutex);
+    if (!channel.values.empty()) {
+        const auto value = channel.values.front();
+        channel.values.pop_front();
+        return value;
+    }
+    TaskGroup::park(*this->fiber, channel);
+    this->parked = true;
+    return nullptr;
+}
+
+bool VM::resume() {
+    this->parked = false;
+    this->execute(1);
+    return !this->parked;
+}
+
+std::string VM::impurity(Object &fn, std::vector<Object *> &visited) const {
+    if (std::find(visited.begin(), visited.end(), &fn) != visited.end()) {
+        return "";
+    }
+    visited.push_back(&fn);
+
+    if (const auto builtin = dynamic_cast<Builtin *>(&fn)) {
+        if (builtin->pure) {
+            return "";
+        }
+        for (const auto &[name, candidate]: builtins) {
+            if (candidate == builtin) {
+                return fmt::format("calls impure builtin `{:s}`", name);
+            }
+        }
+        return "calls an impure host function";
+    }
+    if (const auto closure = dynamic_cast<Closure *>(&fn)) {
+        for (const auto free: closure->free) {
+            if (auto why = this->impurity(*free, visited); !why.empty()) {
+                return why;
+            }
+        }
+        return this->impurity(closure->fn, visited);
+    }
+    return "";
+}
+
+std::string VM::impurity(const CompiledFunction &fn, std::vector<Object *> &visited) const {
+    const auto &ins = fn.instructions;
+    size_t ip = 0;
+    while (ip < ins.size()) {
+        const auto op = static_cast<OpCode>(ins[ip]);
+        const auto def = lookup(static_cast<uint8_t>(op));
+        const auto [operands, read] = readOperands(*def, Instructions(ins.begin() + static_cast<long>(ip) + 1, ins.end()));
+        ip += 1 + read;
+
+        switch (op) {
+            case OpCode::OpSetGlobal:
+                return "assigns a global binding";
+            case OpCode::OpGetBuiltin: {
+                const auto &[name, builtin] = builtins[operands[0]];
+                if (!builtin->pure) {
+                    return fmt::format("calls impure builtin `{:s}`", name);
+                }
+                break;
+            }
+            case OpCode::OpGetGlobal: {
+                // globals are frozen while `pmap` runs, so the function stored there now is the one that will run
+                if (const auto global = (*this->globals)[operands[0]]; global != nullptr) {
+                    if (auto why = this->impurity(*global, visited); !why.empty()) {
+                        return why;
+                    }
+                }
+                break;
+            }
+            case OpCode::OpClosure: {
+                const auto nested = dynamic_cast<CompiledFunction *>((*this->constants)[operands[0]]);
+                if (nested != nullptr && std::find(visited.begin(), visited.end(), nested) == visited.end()) {
+                    visited.push_back(nested);
+                    if (auto why = this->impurity(*nested, visited); !why.empty()) {
+                        return why;
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return "";
+}
+
+void VM::run(const Budget &budget) {
+    std::optional<Heap::Quota> quota;
+    if (budget.heapBytes != 0) {
+        quota.emplace(budget.heapBytes);
+    }
+    this->steps = 0;
+    this->instructionLimit = budget.instructions;
+    this->hasDeadline = budget.time != std::chrono::steady_clock::duration::zero();
+    this->deadline = std::chrono::steady_clock::now() + budget.time;
+    this->checkpoint = 0;
+    const auto unlimited = [this] {
+        this->checkpoint = UINT64_MAX;
+        this->instructionLimit = 0;
+        this->hasDeadline = false;
+    };
+    const auto rewind = [this, &unlimited] {
+        unlimited();
+        this->frames[0] = Frame(*this->mainClosure, 0);
+        this->framesIndex = 1;
+        this->sp = 0;
+    };
+
+    this->entered++;
+    try {
+        this->checkBudget();
+        this->execute(1);
+    } catch (const std::runtime_error &err) {
+        this->leave(&err);
+        rewind();
+        throw;
+    } catch (...) {
+        this->leave(nullptr);
+        rewind();
+        throw;
+    }
+    this->leave(nullptr);
+    unlimited();
+}
+
+void VM::leave(const std::runtime_error *failure) {
+    if (--this->entered > 0 || failure == nullptr) {
+        return;
+    }
+    this->flight.error(failure->what(), this->framesIndex);
+    if (!this->flightPath.empty()) {
+        std::ofstream file(this->flightPath, std::ios::binary);
+        this->writeFlight(file);
+    }
+}
+
+void VM::writeFlight(std::ostream &out) const {
+    this->flight.write(out, *this->constants);
+}
+
+void VM::writeFlightOnError(std::string path) {
+    this->flightPath = std::move(path);
+}
+
+void VM::load(MainCode main) {
+    this->mainClosure->fn.instructions = std::move(main.instructions);
+    this->mainClosure->fn.lines = std::move(main.lines);
+    this->inlineCaches.resize(this->constants->size());
+    this->frames[0] = Frame(*this->mainClosure, 0);
+    this->framesIndex = 1;
+    this->sp = 0;
+}
+
+const LineTable &VM::lines() const {
+    return this->mainClosure->fn.lines;
+}
+
+void VM::checkBudget() {
+    if (this->instructionLimit != 0 && this->steps >= this->instructionLimit) {
+        throw BudgetExceeded(BudgetExceeded::Limit::Instructions,
+                             fmt::format("instruction budget of {:d} exhausted", this->instructionLimit));
+    }
+    if (this->hasDeadline && std::chrono::steady_clock::now() >= this->deadline) {
+        throw BudgetExceeded(BudgetExceeded::Limit::Time, "deadline exceeded");
+    }
+
+    this->checkpoint = UINT64_MAX;
+    if (this->instructionLimit != 0) {
+        this->checkpoint = this->instructionLimit;
+    }
+    if (this->hasDeadline) {
+        this->checkpoint = std::min(this->checkpoint, this->steps + __deadline__interval);
+    }
+}
+
+void VM::profileOps(OpProfile *profile) {
+    this->profile = profile;
+}
+
+void VM::execute(const int floor) {
+    if (this->profile == nullptr && !AllocStats::active()) {
+        return this->dispatch<false>(floor);
+    }
+    struct Leave {
+        OpProfile *profile;
+
+        ~Leave() {
+            if (this->profile != nullptr) {
+                this->profile->leave();
+            }
+        }
+    } leave{this->profile};
+    // gives the site back to the builtin or host that called in
+    AllocStats::Site site(AllocStats::noSite);
+    this->dispatch<true>(floor);
+}
+
+template<bool Instrumented>
+void VM::dispatch(const int floor) {
     int ip{0};
     Instructions ins{};
     OpCode op{};
 
-    while (this->currentFrame()->ip < static_cast<int>(this->currentFrame()->instructions().size() - 1)) {
+    while (this->framesIndex >= floor &&
+           this->currentFrame()->ip < static_cast<int>(this->currentFrame()->instructions().size() - 1)) {
         this->currentFrame()->ip++;
+        this->steps++;
 
         ip = this->currentFrame()->ip;
         ins = this->currentFrame()->instructions();
         op = static_cast<OpCode>(ins[ip]);
+        if constexpr (Instrumented) {
+            if (this->profile != nullptr) {
+                this->profile->enter(op);
+            }
+            if (AllocStats::active()) {
+                AllocStats::at(siteNames()[static_cast<uint8_t>(op)]);
+            }
+        }
 
         switch (op) {
             case OpCode::OpConstant: {
                 const auto constIndex = readUnit16(std::vector(ins.begin() + ip + 1, ins.end()));
                 this->currentFrame()->ip += 2;
-                this->push(*this->constants[constIndex]);
+                this->push(*(*this->constants)[constIndex]);
                 break;
             }
             case OpCode::OpAdd: {
@@ -389,6 +891,9 @@ void VM::run() {
             }
             case OpCode::OpJump: {
                 const auto pos = readUnit16(std::vector(ins.begin() + ip + 1, ins.end()));
+                if (pos <= ip && this->steps >= this->checkpoint) {
+                    this->checkBudget();
+                }
                 this->currentFrame()->ip = pos - 1;
                 break;
             }
@@ -399,13 +904,19 @@ void VM::run() {
             case OpCode::OpGetGlobal: {
                 const auto globalIndex = readUnit16(std::vector(ins.begin() + ip + 1, ins.end()));
                 this->currentFrame()->ip += 2;
-                this->push(*this->globals[globalIndex]);
+
+                // unset when a script reads a binding that another script defines in a different isolate
+                const auto global = (*this->globals)[globalIndex];
+                if (global == nullptr) {
+                    throw std::runtime_error("global binding used before it was set");
+                }
+                this->push(*global);
                 break;
             }
             case OpCode::OpSetGlobal: {
                 const auto globalIndex = readUnit16(std::vector(ins.begin() + ip + 1, ins.end()));
                 this->currentFrame()->ip += 2;
-                this->globals[globalIndex] = this->pop();
+                (*this->globals)[globalIndex] = this->pop();
                 break;
             }
             case OpCode::OpArray: {
@@ -436,8 +947,16 @@ void VM::run() {
             case OpCode::OpCall: {
                 const auto numArgs = readUnit8(std::vector(ins.begin() + ip + 1, ins.end()));
                 this->currentFrame()->ip += 1;
+                if (this->steps >= this->checkpoint) {
+                    this->checkBudget();
+                }
 
                 this->executeCall(numArgs);
+                if (this->parked) {
+                    // back to the OpCall, which runs again when the task resumes
+                    this->currentFrame()->ip -= 2;
+                    return;
+                }
                 break;
             }
             case OpCode::OpReturnValue: {
@@ -500,6 +1019,25 @@ void VM::run() {
                 this->push(*currentClosure->free[freeIndex]);
                 break;
             }
+            case OpCode::OpRecord: {
+                const auto shapeIndex = readUnit16(std::vector(ins.begin() + ip + 1, ins.end()));
+                this->currentFrame()->ip += 2;
+
+                const auto shape = dynamic_cast<Shape *>((*this->constants)[shapeIndex]);
+                const auto numValues = static_cast<int>(shape->keys.size());
+                const auto record = this->buildRecord(*shape, this->sp - numValues);
+                this->sp = this->sp - numValues;
+                this->push(*record);
+                break;
+            }
+            case OpCode::OpIndexConstKey: {
+                const auto constIndex = readUnit16(std::vector(ins.begin() + ip + 1, ins.end()));
+                this->currentFrame()->ip += 2;
+
+                const auto left = this->pop();
+                this->executeConstKeyIndex(*left, constIndex);
+                break;
+            }
         }
     }
 }
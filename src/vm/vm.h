@@ -4,29 +4,82 @@
 
 #ifndef VM_H
 #define VM_H
+#include <chrono>
+
+#include "../object/budget.h"
 #include "../object/object.h"
 #include "../compiler/compiler.h"
+#include "flight_recorder.h"
 #include "frame.h"
 
+class TaskGroup;
+struct Fiber;
+class OpProfile;
+
 inline constexpr int __stack__size = 2048;
 inline constexpr int __globals__size = 65536;
 inline constexpr int __max__frames = 1024;
+// tasks started by `spawn` get smaller stacks so thousands of them stay cheap
+inline constexpr int __task__stack__size = 256;
+inline constexpr int __task__max__frames = 128;
+// instructions between two reads of the clock while a deadline is set
+inline constexpr uint64_t __deadline__interval = 4096;
 
 Boolean *nativeBoolToBooleanObject(bool input);
 
 bool isTruthy(Object &object);
 
-class VM {
-    std::vector<Object *> constants;
+// Monomorphic cache of an `OpIndexConstKey` site: the last record shape seen there and the key's slot in it.
+// Every string literal gets its own constant, so the key's constant index identifies the site.
+struct InlineCache {
+    Shape *shape{nullptr};
+    int slot{-1};
+};
+
+class VM final : public Caller {
+    friend class Snapshot;
+    friend class Sampler;
+    friend class HeapGraph;
+
+    // shared read-only with isolates created for `pmap`
+    std::shared_ptr<const std::vector<Object *> > constants;
+
+    std::vector<InlineCache> inlineCaches;
 
     std::vector<Object *> stack;
 
-    std::vector<Object *> globals;
+    // shared with isolates, which only ever read it
+    std::shared_ptr<std::vector<Object *> > globals;
+
+    // owns the outermost closure; frames[0] runs it
+    std::unique_ptr<Closure> mainClosure;
 
-    std::vector<Frame *> frames;
+    std::vector<Frame> frames;
     int sp;
     int framesIndex;
 
+    // Budget of the current `run`: `steps` counts executed instructions, and the limits are only looked at
+    // once it reaches `checkpoint`, so an unlimited run pays a single comparison per call or backward jump.
+    uint64_t steps{0};
+    uint64_t checkpoint{UINT64_MAX};
+    uint64_t instructionLimit{0};
+    std::chrono::steady_clock::time_point deadline{};
+    bool hasDeadline{false};
+
+    void checkBudget();
+
+    // Tasks this VM spawned; shared with the VMs running them, which spawn into the same group.
+    std::shared_ptr<TaskGroup> group;
+    // the task this VM runs, if it was made by `spawn`
+    Fiber *fiber{nullptr};
+    // The constants tasks run against. A REPL's constants grow in place with every line while tasks may still
+    // run, so tasks get a copy, made again only once constants were added.
+    std::shared_ptr<const std::vector<Object *> > taskConstants;
+    // `invoke`s in progress; a task can only park in `recv` when it is called straight from bytecode
+    int nesting{0};
+    // set by a `recv` that parked the task; the dispatch loop returns and `resume` retries the call
+    bool parked{false};
+
     void push(Object &object);
 
     Object *pop();
@@ -49,15 +102,19 @@ class VM {
 
     Object *buildHash(int startIndex, int endIndex) const;
 
+    Object *buildRecord(Shape &shape, int startIndex) const;
+
     void executeIndexExpression(Object &left, Object &index);
 
     void executeArrayIndex(Object &array, Object &index);
 
     void executeHashIndex(Object &hash, Object &index);
 
-    Frame *currentFrame() const;
+    void executeConstKeyIndex(Object &left, int constIndex);
+
+    Frame *currentFrame();
 
-    void pushFrame(Frame &frame);
+    void pushFrame(const Frame &frame);
 
     Frame *popFrame();
 
@@ -69,31 +126,132 @@ class VM {
 
     void pushClosure(int constIndex, int numFree);
 
-public:
-    static Boolean *True;
-    static Boolean *False;
-    static OBJ::Null *Null;
+    // runs the dispatch loop until the frame stack drops below `floor` frames or the main frame finishes
+    void execute(int floor);
+
+    // the loop itself; the instrumented instantiation reports every instruction to `profile` and names it as
+    // the site of allocations counted by AllocStats, the plain one is what runs unless either is on
+    template<bool Instrumented>
+    void dispatch(int floor);
+
+    OpProfile *profile{nullptr};
+
+    // room for twice as many events as there can be frames
+    FlightRecorder flight;
+    // where a failed `run` or host call writes the flight recorder, if anywhere
+    std::string flightPath;
+    // `run`s and host calls in progress; the outermost records a failure
+    int entered{0};
+
+    // Ends a `run` or host call; if it is the outermost and `failure` is set, records the error and writes
+    // the flight recorder out.
+    void leave(const std::runtime_error *failure);
 
-    explicit VM(const ByteCode &bytecode): sp(0), framesIndex(1) {
-        const auto mainFn = new CompiledFunction(bytecode.instructions);
-        const auto mainClosure = new Closure(*mainFn);
-        const auto mainFrame = new Frame(*mainClosure, 0);
+    // shared loop of invokeRows/invokeColumns; argument(row, i) yields the i-th argument of a row
+    template<typename Argument>
+    void invokeBatch(Closure *closure, size_t numRows, Argument argument, Object **out);
 
-        this->constants = bytecode.constants;
-        this->stack = std::vector<Object *>(__stack__size);
-        this->globals = std::vector<Object *>(__globals__size);
-        this->frames = std::vector<Frame *>(__max__frames);
+    // returns why `fn` may not run in an isolate, or an empty string if it may
+    std::string impurity(Object &fn, std::vector<Object *> &visited) const;
 
-        this->frames[0] = mainFrame;
+    std::string impurity(const CompiledFunction &fn, std::vector<Object *> &visited) const;
+
+    VM(std::shared_ptr<const std::vector<Object *> > constants, std::shared_ptr<std::vector<Object *> > globals,
+       const Instructions &main, LineTable lines = {}, int stackSize = __stack__size, int maxFrames = __max__frames);
+
+public:
+    // immutable singletons shared by every thread
+    static Boolean *const True;
+    static Boolean *const False;
+    static OBJ::Null *const Null;
+
+    explicit VM(const ByteCode &bytecode)
+        : VM(std::make_shared<const std::vector<Object *> >(bytecode.constants),
+             std::make_shared<std::vector<Object *> >(__globals__size),
+             bytecode.instructions, bytecode.lines) {
     }
 
     VM(const ByteCode &bytecode, const std::vector<Object *> &s): VM(bytecode) {
-        this->globals = s;
+        *this->globals = s;
+    }
+
+    // Shares `bytecode` read-only and runs against `globals`, which may outlive this VM.
+    VM(const std::shared_ptr<const ByteCode> &bytecode, std::shared_ptr<std::vector<Object *> > globals)
+        : VM(std::shared_ptr<const std::vector<Object *> >(bytecode, &bytecode->constants), std::move(globals),
+             bytecode->instructions, bytecode->lines) {
+    }
+
+    // Runs against `constants` in place, e.g. those of a REPL's compiler, which may grow between runs.
+    // There is no program until `load` is called.
+    VM(std::shared_ptr<const std::vector<Object *> > constants, std::shared_ptr<std::vector<Object *> > globals)
+        : VM(std::move(constants), std::move(globals), {}) {
     }
 
+    ~VM() override;
+
     Object *lastPoppedStackElem() const;
 
-    void run();
+    // instructions the last `run` executed, nested calls from builtins included
+    uint64_t executed() const;
+
+    // Runs the program within `budget`. Exceeding it throws BudgetExceeded; after that or any other error
+    // the VM is rewound to the start of the program, keeping its globals, so it can run again.
+    void run(const Budget &budget = {});
+
+    // Makes `main` the program the next `run` starts, keeping globals, stack and frames: how the REPL runs
+    // one line after another. `main` may use constants added since the last run.
+    void load(MainCode main);
+
+    // lines of the program the next `run` starts, for the REPL those of its last line
+    const LineTable &lines() const;
+
+    // Calls `closure` from native code, either the host or a builtin that is itself running on this VM.
+    // The callee's frame is pushed on top of the live stack and run to completion by a nested
+    // dispatch loop that stops as soon as that frame returns, so outer frames are left untouched and
+    // invocations can nest. If the call throws, the stack and frames are restored before rethrowing.
+    Object *invoke(Closure *closure, ArgSpan args);
+
+    // Batch form of `invoke`: calls `closure` once per row and stores the i-th result in out[i].
+    // `rows` holds the arguments row after row (array of rows); `columns` holds one span per parameter,
+    // all of the same length. The callee slot, frame and stack layout are set up once and reused for
+    // every row, so a call costs only copying its arguments and running the body. A closure without
+    // parameters has empty rows and no columns, so it is called `nullaryRows` times instead.
+    void invokeRows(Closure *closure, ArgSpan rows, Object **out, size_t nullaryRows = 0);
+
+    void invokeColumns(Closure *closure, const std::vector<ArgSpan> &columns, Object **out,
+                       size_t nullaryRows = 0);
+
+    // `invoke` for closures; builtins are called directly
+    Object *callFunction(Object &fn, ArgSpan args) override;
+
+    // Isolates share this VM's constants and globals but have their own stack, frames and inline caches.
+    // `fn` must be pure: neither it nor anything it can reach may assign globals or call an impure builtin.
+    std::vector<std::unique_ptr<Caller> > isolates(Object &fn, size_t count, std::string &error) override;
+
+    // Runs `fn(args)` as a task with a VM of its own. `fn` must be pure, as for isolates.
+    void spawn(Object &fn, ArgSpan args, std::string &error) override;
+
+    // A task parks until a value arrives; anything else blocks its thread, running queued tasks meanwhile.
+    Object *receive(Channel &channel, std::string &error) override;
+
+    // Waits for the tasks this VM spawned so far to finish or park for good, then hands what they allocated to
+    // the heap that was current when they were spawned. The destructor does this too.
+    void joinTasks();
+
+    // Counts and times the opcodes of every run from now on into `profile`, which must outlive them, or stops
+    // profiling if it is null. Isolates and tasks are not profiled.
+    void profileOps(OpProfile *profile);
+
+    // Writes the last events the flight recorder holds: calls, returns, builtin calls, errors and allocation
+    // spikes, with the time they happened. FlightLog reads them back.
+    void writeFlight(std::ostream &out) const;
+
+    // Makes every `run`, `callFunction` or batch call that throws write the flight recorder to `path`, after
+    // recording the error, or stops that if it is empty. Calls made by builtins of a run leave it to the run.
+    void writeFlightOnError(std::string path);
+
+    // Continues a spawned task. Returns false if it parked in `recv` before returning.
+    bool resume();
 };
 
 #endif //VM_H
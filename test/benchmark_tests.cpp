@@ -0,0 +1,82 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <cmath>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/benchmark/baseline.h"
+#include "../src/benchmark/stats.h"
+
+namespace BenchmarkTest {
+    bool near(const double actual, const double expected, const double tolerance = 1e-6) {
+        return std::abs(actual - expected) <= tolerance;
+    }
+}
+
+TEST_CASE("Summary of timings", "[benchmark]") {
+    const auto odd = Summary::of({5, 1, 4, 2, 3});
+    REQUIRE(odd.median == 3);
+    REQUIRE(odd.mean == 3);
+    REQUIRE(BenchmarkTest::near(odd.stddev, std::sqrt(2.5)));
+    REQUIRE(odd.p95 == 5);
+    REQUIRE(odd.min == 1);
+    REQUIRE(odd.max == 5);
+
+    REQUIRE(Summary::of({4, 1, 3, 2}).median == 2.5);
+    REQUIRE(Summary::of({7}).stddev == 0);
+    REQUIRE(Summary::of({}).median == 0);
+}
+
+TEST_CASE("Mann-Whitney p-values", "[benchmark]") {
+    // identical samples, and samples that are all one tied value, tell nothing apart
+    REQUIRE(mannWhitney({1, 2, 3, 4, 5}, {1, 2, 3, 4, 5}) == 1);
+    REQUIRE(mannWhitney({1, 1, 1}, {1, 1, 1}) == 1);
+    REQUIRE(mannWhitney({}, {1, 2}) == 1);
+
+    // fully separated: U = 0, z = 49.5 / sqrt(175)
+    const std::vector<double> low{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const std::vector<double> high{11, 12, 13, 14, 15, 16, 17, 18, 19, 20};
+    REQUIRE(BenchmarkTest::near(mannWhitney(low, high), 1.826718e-4, 1e-9));
+    REQUIRE(mannWhitney(low, high) == mannWhitney(high, low));
+
+    // ties of 3, 4 and 2 values lower the variance to 2.5 * (12 - 90 / 110)
+    REQUIRE(BenchmarkTest::near(mannWhitney({1, 2, 2, 3, 3}, {2, 3, 3, 4, 5, 5}), 0.0723689));
+}
+
+TEST_CASE("Comparison against a baseline", "[benchmark]") {
+    const std::vector<double> before{1.00, 1.01, 0.99, 1.02, 0.98, 1.00, 1.01, 0.99, 1.00, 1.02};
+    std::vector<double> slower, faster, close;
+    for (const auto sample: before) {
+        slower.push_back(sample * 1.2);
+        faster.push_back(sample * 0.8);
+        close.push_back(sample * 1.01);
+    }
+    // the median moves by over 20%, but the samples overlap too much to tell
+    const std::vector<double> noisy{0.9, 1.5, 0.95, 1.4, 1.2, 1.3, 0.97, 1.25, 1.1, 1.6};
+
+    const auto worse = Comparison::of(before, slower, 0.05, 0.01);
+    REQUIRE(worse.verdict == Comparison::Slower);
+    REQUIRE(BenchmarkTest::near(worse.change, 0.2));
+    REQUIRE(worse.p < 0.01);
+
+    const auto better = Comparison::of(before, faster, 0.05, 0.01);
+    REQUIRE(better.verdict == Comparison::Faster);
+    REQUIRE(BenchmarkTest::near(better.change, -0.2));
+
+    // a move under the threshold is no change, however sure the test is
+    const auto small = Comparison::of(before, close, 0.05, 0.01);
+    REQUIRE(small.verdict == Comparison::Same);
+    REQUIRE(BenchmarkTest::near(small.change, 0.01));
+
+    const auto unsure = Comparison::of(before, noisy, 0.05, 0.01);
+    REQUIRE(unsure.change > 0.05);
+    REQUIRE(unsure.p >= 0.01);
+    REQUIRE(unsure.verdict == Comparison::Same);
+
+    const auto same = Comparison::of(before, before, 0.05, 0.01);
+    REQUIRE(same.verdict == Comparison::Same);
+    REQUIRE(same.p == 1);
+    REQUIRE(same.change == 0);
+}
@@ -2,6 +2,7 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include "../src/code/code.h"
+#include "../src/code/line_table.h"
 #define CATCH_CONFIG_MAIN
 
 TEST_CASE("test make", "[make]") {
@@ -90,7 +91,7 @@ TEST_CASE("test read operands", "[operands]") {
     for (const auto &tt: tests) {
         Instructions instruction = Code::make(tt.op, tt.operands);
 
-        Definition *def = lookup(static_cast<uint8_t>(tt.op));
+        const Definition *def = lookup(static_cast<uint8_t>(tt.op));
         REQUIRE(def != nullptr);
 
         Instructions ins_slice(instruction.begin() + 1, instruction.end());
@@ -104,3 +105,19 @@ TEST_CASE("test read operands", "[operands]") {
         }
     }
 }
+
+TEST_CASE("test line table", "[lines]") {
+    const std::vector<std::pair<int, int> > entries = {{0, 3}, {4, 5}, {5, 2}, {300, 1000}};
+    const LineTable table(entries);
+
+    REQUIRE(table.entries() == entries);
+    REQUIRE(table.encoded().size() == 10);
+    REQUIRE(LineTable(table.encoded()).entries() == entries);
+
+    REQUIRE(table.lineAt(0) == 3);
+    REQUIRE(table.lineAt(3) == 3);
+    REQUIRE(table.lineAt(4) == 5);
+    REQUIRE(table.lineAt(299) == 2);
+    REQUIRE(table.lineAt(301) == 1000);
+    REQUIRE(LineTable().lineAt(0) == 0);
+}
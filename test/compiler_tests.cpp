@@ -58,7 +58,7 @@ TEST_CASE("TestCompilerScopes", "[compiler]") {
 
 struct CompilerTestCase {
     std::string input;
-    std::vector<std::variant<int64_t, std::string, std::vector<Instructions> > > expectedConstants;
+    std::vector<std::variant<int64_t, std::string, std::vector<Instructions>, std::vector<int64_t> > > expectedConstants;
     std::vector<Instructions> expectedInstructions;
 };
 
@@ -80,7 +80,7 @@ Instructions concatInstructions(const std::vector<Instructions> &s) {
     return out;
 }
 
-void testConstants(const std::vector<std::variant<int64_t, std::string, std::vector<Instructions> > > &expected,
+void testConstants(const std::vector<std::variant<int64_t, std::string, std::vector<Instructions>, std::vector<int64_t> > > &expected,
                    const std::vector<Object *> &actual) {
     REQUIRE(expected.size() == actual.size());
 
@@ -100,6 +100,11 @@ void testConstants(const std::vector<std::variant<int64_t, std::string, std::vec
                            auto *fn = dynamic_cast<CompiledFunction *>(actual[i]);
                            REQUIRE(fn != nullptr);
                            testInstructions({exp}, fn->instructions);
+                       },
+                       [&](const std::vector<int64_t> &exp) {
+                           auto *ints = dynamic_cast<IntArray *>(actual[i]);
+                           REQUIRE(ints != nullptr);
+                           REQUIRE(ints->values == exp);
                        }
                    }, expected[i]);
     }
@@ -488,7 +493,15 @@ TEST_CASE("TestArrayLiterals", "[compiler]") {
         },
         {
             "[1, 2, 3]",
-            {1, 2, 3},
+            {std::vector<int64_t>{1, 2, 3}},
+            {
+                Code::make(OpCode::OpConstant, {0}),
+                Code::make(OpCode::OpPop, {})
+            }
+        },
+        {
+            "[1, \"two\", 3]",
+            {1, std::string("two"), 3},
             {
                 Code::make(OpCode::OpConstant, {0}),
                 Code::make(OpCode::OpConstant, {1}),
@@ -564,6 +577,39 @@ TEST_CASE("TestHashLiterals", "[compiler]") {
     runCompilerTests(tests);
 }
 
+TEST_CASE("TestRecordLiterals", "[compiler]") {
+    auto program = CompilerTest::parse(R"({"title": 1, "author": 2}["title"]; {"author": 3, "title": 4})");
+
+    auto compiler = Compiler();
+    compiler.compile(program.get());
+    auto bytecode = compiler.byteCode();
+
+    testInstructions({
+                         Code::make(OpCode::OpConstant, {0}),
+                         Code::make(OpCode::OpConstant, {1}),
+                         Code::make(OpCode::OpRecord, {2}),
+                         Code::make(OpCode::OpIndexConstKey, {3}),
+                         Code::make(OpCode::OpPop, {}),
+                         Code::make(OpCode::OpConstant, {4}),
+                         Code::make(OpCode::OpConstant, {5}),
+                         Code::make(OpCode::OpRecord, {2}),
+                         Code::make(OpCode::OpPop, {}),
+                     }, bytecode.instructions);
+
+    REQUIRE(bytecode.constants.size() == 6);
+    testConstants({int64_t{2}, int64_t{1}}, {bytecode.constants[0], bytecode.constants[1]});
+    testConstants({std::string("title"), int64_t{3}, int64_t{4}},
+                  {bytecode.constants[3], bytecode.constants[4], bytecode.constants[5]});
+
+    auto shape = dynamic_cast<Shape *>(bytecode.constants[2]);
+    REQUIRE(shape != nullptr);
+    REQUIRE(shape->keys.size() == 2);
+    REQUIRE(shape->keys[0]->value == "author");
+    REQUIRE(shape->keys[1]->value == "title");
+    REQUIRE(shape->slotOf("title") == 1);
+    REQUIRE(shape->slotOf("isbn") == -1);
+}
+
 TEST_CASE("TestLetStatementScopes", "[compiler]") {
     std::vector<CompilerTestCase> tests = {
         {
@@ -749,3 +795,19 @@ TEST_CASE("TestClosures", "[compiler]") {
 
     runCompilerTests(tests);
 }
+
+TEST_CASE("TestLineTables", "[compiler]") {
+    auto program = CompilerTest::parse("let f = fn(a) {\n  let b = a * 2;\n\n  b + 1\n};\nf(1);");
+    auto compiler = Compiler();
+    compiler.compile(program.get());
+    const auto bytecode = compiler.byteCode();
+
+    // OpClosure + OpSetGlobal on line 1, then OpGetGlobal OpConstant OpCall OpPop on line 6
+    REQUIRE(bytecode.lines.entries() == std::vector<std::pair<int, int> >{{0, 1}, {7, 6}});
+
+    const auto fn = dynamic_cast<CompiledFunction *>(bytecode.constants[2]);
+    REQUIRE(fn != nullptr);
+    // OpGetLocal OpConstant OpMul OpSetLocal, then OpGetLocal OpConstant OpAdd OpReturnValue
+    REQUIRE(fn->lines.entries() == std::vector<std::pair<int, int> >{{0, 2}, {8, 4}});
+    REQUIRE(fn->lines.lineAt(12) == 4);
+}
@@ -0,0 +1,142 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <stdexcept>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/engine/engine.h"
+#include "../src/object/native.h"
+
+namespace EngineTest {
+    int64_t integerValue(Object *obj) {
+        const auto integer = dynamic_cast<Integer *>(obj);
+        REQUIRE(integer != nullptr);
+        return integer->value;
+    }
+}
+
+TEST_CASE("Engine runs a compiled script repeatedly", "[engine]") {
+    monkey::Engine engine;
+    const auto script = engine.compile("let double = fn(x) { x * 2 }; double(21)");
+    REQUIRE(EngineTest::integerValue(engine.run(script)) == 42);
+    REQUIRE(EngineTest::integerValue(engine.run(script)) == 42);
+}
+
+TEST_CASE("Engine calls exported functions", "[engine]") {
+    monkey::Engine engine;
+    engine.run(engine.compile(
+        "let threshold = 10;"
+        "let score = fn(r) { if (r[\"amount\"] > threshold) { r[\"amount\"] * 2 } else { 0 } };"));
+
+    const auto score = engine.global("score");
+    REQUIRE(score != nullptr);
+    REQUIRE(engine.global("missing") == nullptr);
+
+    for (auto amount = 0; amount < 20; amount++) {
+        const auto record = new Hash(std::unordered_map<HashKey, HashPair>{
+            {String("amount").hash_key(), HashPair(*new String("amount"), *new Integer(amount))}
+        });
+        const auto result = engine.call(*score, {record});
+        REQUIRE(EngineTest::integerValue(result) == (amount > 10 ? amount * 2 : 0));
+    }
+}
+
+TEST_CASE("Engine scripts share persistent globals", "[engine]") {
+    monkey::Engine engine;
+    engine.run(engine.compile("let base = 100; let add = fn(x) { x + base };"));
+    const auto second = engine.compile("add(5)");
+    REQUIRE(EngineTest::integerValue(engine.run(second)) == 105);
+
+    // closures from the first script still run after later scripts added constants
+    engine.compile("let other = fn() { \"unused\" };");
+    REQUIRE(EngineTest::integerValue(engine.call(*engine.global("add"), {new Integer(1)})) == 101);
+}
+
+TEST_CASE("Engine runs scripts in fresh isolates", "[engine]") {
+    monkey::Engine engine;
+    const auto script = engine.compile("let x = 7; x * x");
+    Isolate fresh;
+    REQUIRE(EngineTest::integerValue(engine.run(script, fresh)) == 49);
+    REQUIRE(engine.global("x") == nullptr);
+
+    const auto dependent = engine.compile("x + 1");
+    Isolate empty;
+    REQUIRE_THROWS_WITH(engine.run(dependent, empty), "global binding used before it was set");
+}
+
+TEST_CASE("Engine reports errors and stays usable", "[engine]") {
+    monkey::Engine engine;
+    REQUIRE_THROWS_AS(engine.compile("let = 1;"), std::runtime_error);
+    REQUIRE_THROWS_WITH(engine.compile("nope + 1"), "unknown variable nope");
+
+    engine.run(engine.compile("let f = fn(x) { x + true };let g = fn(x) { x + 1 };"));
+    REQUIRE_THROWS(engine.call(*engine.global("f"), {new Integer(1)}));
+    REQUIRE_THROWS_WITH(engine.call(*engine.global("g"), {}), "wrong number of arguments: want=1, got=0");
+    REQUIRE(EngineTest::integerValue(engine.call(*engine.global("g"), {new Integer(1)})) == 2);
+}
+
+namespace EngineTest {
+    int64_t tierBonus(const int64_t amount, const std::string_view tier) {
+        return tier == "gold" ? amount * 2 : amount;
+    }
+}
+
+TEST_CASE("Engine binds typed host functions", "[engine]") {
+    monkey::Engine engine;
+    engine.bind("bonus", bindNative<&EngineTest::tierBonus>());
+
+    REQUIRE(EngineTest::integerValue(engine.run(engine.compile("bonus(10, \"gold\") + bonus(1, \"tin\")"))) == 21);
+
+    const auto bad = engine.run(engine.compile("bonus(1, 2)"));
+    REQUIRE(dynamic_cast<Error *>(bad)->message == "argument 2 must be STRING, got INTEGER");
+
+    // host functions are impure unless bound as pure
+    const auto rejected = engine.run(engine.compile("pmap([1], fn(x) { bonus(x, \"gold\") })"));
+    REQUIRE(dynamic_cast<Error *>(rejected)->message ==
+        "argument to `pmap` must be a pure function: calls an impure host function");
+}
+
+namespace EngineTest {
+    bool yes() {
+        return true;
+    }
+
+    bool no() {
+        return false;
+    }
+}
+
+TEST_CASE("Engine host booleans compare like literals", "[engine]") {
+    monkey::Engine engine;
+    engine.bind("yes", bindNative<&EngineTest::yes>());
+    engine.bind("no", bindNative<&EngineTest::no>());
+
+    const auto script = engine.compile("[yes() == true, no() == false, !no(), !yes(), yes() != no()]");
+    REQUIRE(engine.run(script)->inspect() == "[true, true, true, false, true]");
+}
+
+TEST_CASE("Engine calls a function over a batch", "[engine]") {
+    monkey::Engine engine;
+    engine.run(engine.compile("let rate = 2; let score = fn(x, y) { x * rate + y };"));
+    const auto score = engine.global("score");
+
+    std::vector<Object *> xs, ys;
+    for (auto i = 0; i < 100; i++) {
+        xs.push_back(new Integer(i));
+        ys.push_back(new Integer(1));
+    }
+    std::vector<Object *> out(100);
+    engine.callColumns(*score, {xs, ys}, out.data());
+    for (auto i = 0; i < 100; i++) {
+        REQUIRE(EngineTest::integerValue(out[i]) == i * 2 + 1);
+    }
+
+    const std::vector<Object *> rows{new Integer(5), new Integer(6), new Integer(7), new Integer(8)};
+    engine.callRows(*score, rows, out.data());
+    REQUIRE(EngineTest::integerValue(out[0]) == 16);
+    REQUIRE(EngineTest::integerValue(out[1]) == 22);
+
+    REQUIRE_THROWS_WITH(engine.callRows(*getBuiltinByName("len"), {}, out.data()),
+                        "batch calls need a closure, got BUILTIN");
+}
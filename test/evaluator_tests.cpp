@@ -115,14 +115,14 @@ namespace EvaluatorTest {
             return false;
         }
 
-        if (hash->pairs.size() != expected.size()) {
-            FAIL("Hash has wrong num of pairs. got=" + std::to_string(hash->pairs.size()));
+        if (hash->pairs().size() != expected.size()) {
+            FAIL("Hash has wrong num of pairs. got=" + std::to_string(hash->pairs().size()));
             return false;
         }
 
         for (const auto& [expectedKey, expectedValue] : expected) {
-            auto it = hash->pairs.find(expectedKey);
-            if (it == hash->pairs.end()) {
+            auto it = hash->pairs().find(expectedKey);
+            if (it == hash->pairs().end()) {
                 FAIL("no pair for given key in Pairs");
                 return false;
             }
@@ -428,6 +428,22 @@ addTwo(2);
         REQUIRE(testIntegerObject(evaluated, 4));
     }
 
+    TEST_CASE("Test function literals evaluated more than once", "[evaluator]") {
+        // the inner literal is evaluated on every call of mk, and each function keeps its body
+        Object* evaluated = testEval("let mk = fn() { fn(x) { x } }; mk()(1) + mk()(2)");
+        REQUIRE(testIntegerObject(evaluated, 3));
+
+        // a program can be evaluated again, as the benchmark does for every run
+        Lexer l("let add = fn(a) { fn(b) { a + b } }; let f = add(2); f(3) + add(1)(1)");
+        Parser p(std::move(l));
+        auto program = p.parseProgram();
+        auto evaluator = std::make_unique<Evaluator>();
+        for (auto i = 0; i < 2; i++) {
+            auto env = std::make_unique<Environment>();
+            REQUIRE(testIntegerObject(evaluator->Eval(*program, *env), 7));
+        }
+    }
+
     TEST_CASE("Test string literal", "[evaluator]") {
         std::string input = R"("Hello World!")";
 
@@ -467,6 +483,15 @@ addTwo(2);
             {"rest([])", nullptr},
             {"push([], 1)", std::vector<int64_t>{1}},
             {"push(1, 1)", std::string("argument to `push` must be ARRAY, got INTEGER")},
+            {R"(set({}, "a", 1)["a"])", int64_t(1)},
+            {R"(delete({"a": 1}, "a")["a"])", nullptr},
+            {R"(delete(1, "a"))", std::string("argument to `delete` must be HASH, got INTEGER")},
+            {"map([1, 2, 3], fn(x) { x * 2 })", std::vector<int64_t>{2, 4, 6}},
+            {"filter([1, 2, 3, 4], fn(x) { x > 2 })", std::vector<int64_t>{3, 4}},
+            {"reduce([1, 2, 3], 10, fn(acc, x) { acc + x })", int64_t(16)},
+            {"find([1, 2, 3], fn(x) { x == 2 })", int64_t(2)},
+            {"each([1, 2], fn(x) { x })", nullptr},
+            {"map([1], fn(x) { x + true })", std::string("type mismatch: INTEGER + BOOLEAN")},
         };
 
         for (const auto& tt : tests) {
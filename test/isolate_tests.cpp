@@ -0,0 +1,95 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <atomic>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/compiler/compiler.h"
+#include "../src/lexer/lexer.h"
+#include "../src/parser/parser.h"
+#include "../src/runtime/isolate.h"
+
+namespace IsolateTest {
+    std::shared_ptr<const ByteCode> compile(const std::string &input) {
+        auto parser = Parser(Lexer(input));
+        auto program = parser.parseProgram();
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        return std::make_shared<const ByteCode>(compiler.byteCode());
+    }
+
+    int64_t integerResult(Object *result) {
+        const auto integer = dynamic_cast<Integer *>(result);
+        REQUIRE(integer != nullptr);
+        return integer->value;
+    }
+
+    // touches records, hashes, strings, closures, recursion and the callback builtins
+    std::string script(const int i) {
+        return "let fib = fn(n) { if (n < 2) { n } else { fib(n - 1) + fib(n - 2) } };"
+               "let scale = fn(k) { fn(x) { x * k } };"
+               "let r = {\"id\": " + std::to_string(i) + ", \"name\": \"s" + std::to_string(i) + "\"};"
+               "let h = set({}, r[\"name\"], r[\"id\"]);"
+               "let xs = map(range(" + std::to_string(i + 1) + "), scale(2));"
+               "reduce(xs, 0, fn(a, b) { a + b }) + fib(15) + h[\"s" + std::to_string(i) + "\"] + len(r[\"name\"])";
+    }
+
+    int64_t expected(const int i) {
+        const auto name = "s" + std::to_string(i);
+        return static_cast<int64_t>(i) * (i + 1) + 610 + i + static_cast<int64_t>(name.size());
+    }
+}
+
+TEST_CASE("Isolate owns what its runs allocate", "[isolate]") {
+    Isolate isolate;
+    const auto result = isolate.run(IsolateTest::compile("let xs = map(range(3), fn(x) { x + 1 }); sum(xs)"));
+    REQUIRE(IsolateTest::integerResult(result) == 6);
+    REQUIRE(isolate.heap.size() > 0);
+}
+
+TEST_CASE("Isolates do not share globals", "[isolate]") {
+    Isolate a, b;
+    a.run(IsolateTest::compile("let x = 1;"));
+    REQUIRE((*a.globals)[0] != nullptr);
+    REQUIRE((*b.globals)[0] == nullptr);
+}
+
+TEST_CASE("64 scripts on 16 threads", "[isolate][stress]") {
+    constexpr int numScripts = 64;
+    constexpr int numThreads = 16;
+
+    std::vector<std::shared_ptr<const ByteCode> > programs;
+    for (auto i = 0; i < numScripts; i++) {
+        programs.push_back(IsolateTest::compile(IsolateTest::script(i)));
+    }
+    // one more program shared by every thread at once
+    const auto shared = IsolateTest::compile("let fib = fn(n) { if (n < 2) { n } else { fib(n - 1) + fib(n - 2) } }; fib(18)");
+
+    std::vector<int64_t> results(numScripts);
+    std::atomic<int> sharedOk{0};
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t] {
+            for (auto i = t; i < numScripts; i += numThreads) {
+                Isolate isolate;
+                const auto result = dynamic_cast<Integer *>(isolate.run(programs[i]));
+                results[i] = result != nullptr ? result->value : -1;
+            }
+            Isolate isolate;
+            if (const auto result = dynamic_cast<Integer *>(isolate.run(shared)); result && result->value == 2584) {
+                ++sharedOk;
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+
+    for (auto i = 0; i < numScripts; i++) {
+        INFO("script " << i);
+        REQUIRE(results[i] == IsolateTest::expected(i));
+    }
+    REQUIRE(sharedOk.load() == numThreads);
+}
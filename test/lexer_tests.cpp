@@ -134,3 +134,38 @@ if (5 < 10) {
         REQUIRE(tok.literal == tests[i].expectedLiteral);
     }
 }
+
+TEST_CASE("Test Token Positions", "[lexer]") {
+    const std::string input = "let x = 5;\n  x + \"a\nb\";\n\ty";
+
+    struct Expected {
+        TokenType type;
+        int offset;
+        int line;
+        int column;
+    };
+    std::vector<Expected> tests = {
+        {LET, 0, 1, 1},
+        {IDENT, 4, 1, 5},
+        {ASSIGN, 6, 1, 7},
+        {INT, 8, 1, 9},
+        {SEMICOLON, 9, 1, 10},
+        {IDENT, 13, 2, 3},
+        {PLUS, 15, 2, 5},
+        {STRING, 17, 2, 7},
+        {SEMICOLON, 22, 3, 3},
+        {IDENT, 25, 4, 2},
+        {EOF_, 26, 4, 3},
+    };
+
+    Lexer l(input);
+    for (size_t i = 0; i < tests.size(); i++) {
+        const auto tok = l.nextToken();
+
+        INFO("Test case " << i);
+        REQUIRE(tok.type == tests[i].type);
+        REQUIRE(tok.position.offset == tests[i].offset);
+        REQUIRE(tok.position.line == tests[i].line);
+        REQUIRE(tok.position.column == tests[i].column);
+    }
+}
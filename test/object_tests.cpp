@@ -3,6 +3,8 @@
 #include "../src/object/object.h"
 #include "../src/object/builtins.h"
 #include "../src/object/environment.h"
+#include "../src/object/native.h"
+#include "../src/object/simd.h"
 
 TEST_CASE("String HashKey", "[object]") {
     auto hello1 = std::make_shared<String>("Hello World");
@@ -260,3 +262,184 @@ TEST_CASE("Builtin push function", "[builtins]") {
         REQUIRE(result->type() == ERROR_OBJ);
     }
 }
+
+TEST_CASE("HashTrie set and remove", "[object]") {
+    HashTrie empty;
+    REQUIRE(empty.empty());
+    REQUIRE(empty.begin() == empty.end());
+
+    std::vector<Integer *> keys;
+    HashTrie trie;
+    for (auto i = 0; i < 2000; i++) {
+        keys.push_back(new Integer(i));
+        trie = trie.set(keys[i]->hash_key(), HashPair(*keys[i], *new Integer(i * 10)));
+    }
+    REQUIRE(trie.size() == 2000);
+
+    for (auto i = 0; i < 2000; i++) {
+        auto pair = trie.get(keys[i]->hash_key());
+        REQUIRE(pair != nullptr);
+        REQUIRE(dynamic_cast<Integer *>(pair->value)->value == i * 10);
+    }
+    REQUIRE(trie.get(Integer(2000).hash_key()) == nullptr);
+
+    size_t visited = 0;
+    for (const auto &[key, pair]: trie) {
+        REQUIRE(trie.find(key) != trie.end());
+        REQUIRE(trie.find(key)->second.value == pair.value);
+        visited++;
+    }
+    REQUIRE(visited == 2000);
+
+    auto removed = trie;
+    for (auto i = 0; i < 2000; i += 2) {
+        removed = removed.remove(keys[i]->hash_key());
+    }
+    REQUIRE(removed.size() == 1000);
+    REQUIRE(removed.get(keys[0]->hash_key()) == nullptr);
+    REQUIRE(removed.get(keys[1]->hash_key()) != nullptr);
+    REQUIRE(removed.remove(keys[0]->hash_key()).size() == 1000);
+}
+
+TEST_CASE("HashTrie updates are persistent", "[object]") {
+    auto key = new String("title");
+    auto original = HashTrie().set(key->hash_key(), HashPair(*key, *new Integer(1)));
+    auto updated = original.set(key->hash_key(), HashPair(*key, *new Integer(2)));
+    auto deleted = updated.remove(key->hash_key());
+
+    REQUIRE(original.size() == 1);
+    REQUIRE(updated.size() == 1);
+    REQUIRE(deleted.empty());
+    REQUIRE(dynamic_cast<Integer *>(original.get(key->hash_key())->value)->value == 1);
+    REQUIRE(dynamic_cast<Integer *>(updated.get(key->hash_key())->value)->value == 2);
+}
+
+TEST_CASE("HashTrie full hash collisions", "[object]") {
+    // keys of different types whose combined std::hash<HashKey> values are identical
+    const HashKey a{"A", 42};
+    HashKey b{};
+    for (auto i = 0;; i++) {
+        const auto type = "B" + std::to_string(i);
+        const auto diff = std::hash<std::string>{}("A") ^ std::hash<std::string>{}(type);
+        if ((diff & 1) == 0) {
+            b = {type, 42 ^ diff >> 1};
+            break;
+        }
+    }
+    REQUIRE(std::hash<HashKey>{}(a) == std::hash<HashKey>{}(b));
+
+    auto one = new Integer(1);
+    auto two = new Integer(2);
+    auto trie = HashTrie().set(a, HashPair(*one, *one)).set(b, HashPair(*two, *two));
+    REQUIRE(trie.size() == 2);
+    REQUIRE(trie.get(a)->value == one);
+    REQUIRE(trie.get(b)->value == two);
+
+    auto removed = trie.remove(a);
+    REQUIRE(removed.size() == 1);
+    REQUIRE(removed.get(a) == nullptr);
+    REQUIRE(removed.get(b)->value == two);
+}
+
+TEST_CASE("Builtin set and delete functions", "[builtins]") {
+    auto key = new String("name");
+    auto hash = new Hash();
+
+    std::vector<Object *> setArgs = {hash, key, new Integer(7)};
+    auto updated = dynamic_cast<Hash *>(monkey_set(setArgs));
+    REQUIRE(updated != nullptr);
+    REQUIRE(updated->pairs().size() == 1);
+    REQUIRE(hash->pairs().empty());
+
+    std::vector<Object *> deleteArgs = {updated, key};
+    auto deleted = dynamic_cast<Hash *>(monkey_delete(deleteArgs));
+    REQUIRE(deleted != nullptr);
+    REQUIRE(deleted->pairs().empty());
+    REQUIRE(updated->pairs().size() == 1);
+
+    std::vector<Object *> badArgs = {new Integer(1), key, key};
+    REQUIRE(monkey_set(badArgs)->type() == ERROR_OBJ);
+    std::vector<Object *> badKey = {hash, new Array({})};
+    REQUIRE(monkey_delete(badKey)->type() == ERROR_OBJ);
+}
+
+TEST_CASE("Simd kernels match scalar loops", "[object]") {
+    INFO("isa: " << Simd::isa());
+    // odd lengths exercise the scalar tails after the vector loops
+    for (size_t n = 1; n <= 37; n++) {
+        std::vector<int64_t> a(n), b(n);
+        for (size_t i = 0; i < n; i++) {
+            a[i] = static_cast<int64_t>(i * 7919 % 101) - 50;
+            b[i] = static_cast<int64_t>(i) * 0x100000001LL - (INT64_C(1) << 40);
+        }
+
+        int64_t sum = 0, dot = 0;
+        auto min = a[0], max = a[0];
+        std::vector<int64_t> added(n), multiplied(n);
+        for (size_t i = 0; i < n; i++) {
+            sum += a[i];
+            dot = static_cast<int64_t>(static_cast<uint64_t>(dot) +
+                                       static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(b[i]));
+            min = std::min(min, a[i]);
+            max = std::max(max, a[i]);
+            added[i] = a[i] + b[i];
+            multiplied[i] = static_cast<int64_t>(static_cast<uint64_t>(a[i]) * static_cast<uint64_t>(b[i]));
+        }
+
+        REQUIRE(Simd::sum(a.data(), n) == sum);
+        REQUIRE(Simd::min(a.data(), n) == min);
+        REQUIRE(Simd::max(a.data(), n) == max);
+        REQUIRE(Simd::dot(a.data(), b.data(), n) == dot);
+
+        std::vector<int64_t> out(n);
+        Simd::add(a.data(), b.data(), out.data(), n);
+        REQUIRE(out == added);
+        Simd::mul(a.data(), b.data(), out.data(), n);
+        REQUIRE(out == multiplied);
+    }
+}
+
+TEST_CASE("Builtins accept IntArray", "[builtins]") {
+    auto ints = new IntArray({3, 1, 2});
+    REQUIRE(ints->type() == ARRAY_OBJ);
+    REQUIRE(ints->inspect() == "[3, 1, 2]");
+
+    std::vector<Object *> args = {ints};
+    REQUIRE(dynamic_cast<Integer *>(monkey_len(args))->value == 3);
+    REQUIRE(dynamic_cast<Integer *>(monkey_first(args))->value == 3);
+    REQUIRE(dynamic_cast<Integer *>(monkey_last(args))->value == 2);
+    REQUIRE(dynamic_cast<IntArray *>(monkey_rest(args))->values == std::vector<int64_t>{1, 2});
+    REQUIRE(dynamic_cast<Integer *>(monkey_min(args))->value == 1);
+
+    std::vector<Object *> boxed = {new Array({new Integer(1), new Integer(2), new Integer(3)})};
+    REQUIRE(dynamic_cast<Integer *>(monkey_sum(boxed))->value == 6);
+}
+
+namespace NativeTest {
+    int64_t repeatLength(const int64_t times, const std::string_view text) {
+        return times * static_cast<int64_t>(text.size());
+    }
+
+    std::string shout(const std::string &text, const bool loud) {
+        return loud ? text + "!" : text;
+    }
+}
+
+TEST_CASE("Native bindings convert typed arguments", "[builtins]") {
+    const auto repeat = bindNative<&NativeTest::repeatLength>();
+    REQUIRE_FALSE(repeat->pure);
+
+    auto result = repeat->fn(std::vector<Object *>{new Integer(3), new String("abcd")});
+    REQUIRE(dynamic_cast<Integer *>(result)->value == 12);
+
+    result = repeat->fn(std::vector<Object *>{new Integer(3)});
+    REQUIRE(dynamic_cast<Error *>(result)->message == "wrong number of arguments. got=1, want=2");
+
+    result = repeat->fn(std::vector<Object *>{new Integer(3), new Integer(4)});
+    REQUIRE(dynamic_cast<Error *>(result)->message == "argument 2 must be STRING, got INTEGER");
+
+    const auto shout = bindNative<&NativeTest::shout>(true);
+    REQUIRE(shout->pure);
+    result = shout->fn(std::vector<Object *>{new String("hey"), new Boolean(true)});
+    REQUIRE(dynamic_cast<String *>(result)->value == "hey!");
+}
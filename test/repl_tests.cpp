@@ -0,0 +1,101 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <sstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/lexer/lexer.h"
+#include "../src/parser/parser.h"
+#include "../src/repl/repl.h"
+#include "../src/repl/session.h"
+
+namespace ReplTest {
+    Object *eval(Repl::Session &session, const std::string &line) {
+        auto lexer = Lexer(line);
+        auto parser = Parser(lexer);
+        const auto program = parser.parseProgram();
+        session.compile(program.get());
+        return session.run();
+    }
+}
+
+TEST_CASE("Session keeps definitions across lines", "[repl]") {
+    Repl::Session session;
+    ReplTest::eval(session, "let x = 40;");
+    ReplTest::eval(session, "let add = fn(a, b) { a + b };");
+    REQUIRE(ReplTest::eval(session, "add(x, 2)")->inspect() == "42");
+    REQUIRE(ReplTest::eval(session, "\"a\" + \"b\"")->inspect() == "ab");
+    REQUIRE(ReplTest::eval(session, "") == nullptr);
+
+    REQUIRE_THROWS_WITH(ReplTest::eval(session, "fn() { y }"), "unknown variable y");
+    REQUIRE_THROWS_WITH(ReplTest::eval(session, "add(1, true)"),
+                        "unsupported types for binary operation: INTEGER BOOLEAN");
+    REQUIRE(ReplTest::eval(session, "add(x, 1)")->inspect() == "41");
+}
+
+TEST_CASE("Session tasks outlive the line that spawned them", "[repl]") {
+    Repl::Session session;
+    ReplTest::eval(session, "let c = chan(); let d = chan(); spawn(fn() { send(d, recv(c) * 2) });");
+
+    // enough constants to move the session's constant pool while the task waits
+    std::string strings;
+    for (auto i = 0; i < 5000; i++) {
+        strings += "\"s" + std::to_string(i) + "\"; ";
+    }
+    ReplTest::eval(session, strings);
+    REQUIRE(ReplTest::eval(session, "send(c, 21); recv(d)")->inspect() == "42");
+}
+
+TEST_CASE("REPL prints each line's value", "[repl]") {
+    std::istringstream in("let x = 5;\nx * 2\nlet f = fn() { x + 1 }; f()\nf() + 1\n");
+    std::ostringstream out;
+    Repl::start(in, out);
+    REQUIRE(out.str() == ">> 5\n>> 10\n>> 6\n>> 7\n>> ");
+}
+
+TEST_CASE("Session heap graph tells what each global retains", "[repl]") {
+    Repl::Session session;
+    ReplTest::eval(session, "let big = [\"a\" + \"b\", \"c\" + \"d\"];");
+    ReplTest::eval(session, "let pair = [big, big];");
+    ReplTest::eval(session, "let alias = big;");
+    ReplTest::eval(session, "let own = [\"x\" + \"y\"];");
+
+    const auto graph = session.heap();
+    const auto idom = graph.dominators();
+    const auto retained = graph.retainedSizes();
+    const auto find = [&](const std::string &name) {
+        for (size_t id = 0; id < graph.nodes.size(); id++) {
+            if (graph.nodes[id].name == name) {
+                return id;
+            }
+        }
+        FAIL("no node named " << name);
+        return HeapGraph::none;
+    };
+
+    const auto big = find("global big");
+    const auto pair = find("global pair");
+    const auto own = find("global own");
+    REQUIRE(graph.nodes[big].kind == ARRAY_OBJ);
+    REQUIRE(graph.nodes[big].edges.size() == 2);
+    REQUIRE(graph.nodes[pair].edges == std::vector<size_t>{big, big});
+    // `big` is held by three globals, so none of them retains it
+    REQUIRE(idom[big] == 0);
+    REQUIRE(retained[pair] == graph.nodes[pair].size);
+    REQUIRE(retained[big] == graph.nodes[big].size + graph.nodes[graph.nodes[big].edges[0]].size +
+            graph.nodes[graph.nodes[big].edges[1]].size);
+    REQUIRE(retained[own] > graph.nodes[own].size);
+    REQUIRE(retained[0] >= retained[big] + retained[pair] + retained[own]);
+
+    std::stringstream file;
+    graph.write(file);
+    const auto read = HeapGraph::read(file);
+    REQUIRE(read.nodes.size() == graph.nodes.size());
+    REQUIRE(read.nodes[big].name == "global big");
+    REQUIRE(read.nodes[pair].edges == graph.nodes[pair].edges);
+    REQUIRE(read.retainedSizes() == retained);
+
+    std::istringstream bad("monkey-heap 1\n2\n0 ROOTS 0 1 5 \n");
+    REQUIRE_THROWS_WITH(HeapGraph::read(bad), "heap graph node 0 has a bad edge");
+}
@@ -0,0 +1,84 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/compiler/compiler.h"
+#include "../src/lexer/lexer.h"
+#include "../src/parser/parser.h"
+#include "../src/runtime/isolate.h"
+
+namespace SchedulerTest {
+    Object *run(Isolate &isolate, const std::string &input) {
+        auto parser = Parser(Lexer(input));
+        auto program = parser.parseProgram();
+        REQUIRE(parser.errors().empty());
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        return isolate.run(std::make_shared<const ByteCode>(compiler.byteCode()));
+    }
+
+    std::string errorMessage(Object *result) {
+        const auto error = dynamic_cast<Error *>(result);
+        REQUIRE(error != nullptr);
+        return error->message;
+    }
+}
+
+TEST_CASE("Tasks park in recv until a value is sent", "[scheduler]") {
+    Isolate isolate;
+    const auto result = SchedulerTest::run(isolate,
+                                           "let c = chan(); let d = chan();"
+                                           "spawn(fn() { send(d, recv(c) + 1) });"
+                                           "send(c, 41);"
+                                           "recv(d)");
+    REQUIRE(result->inspect() == "42");
+}
+
+TEST_CASE("Thousands of parked tasks need no threads of their own", "[scheduler]") {
+    Isolate isolate;
+    const auto result = SchedulerTest::run(isolate,
+                                           "let gate = chan(); let done = chan();"
+                                           "each(range(2000), fn(i) { spawn(fn(g, d) { send(d, recv(g)) }, gate, done) });"
+                                           "each(range(2000), fn(i) { send(gate, i) });"
+                                           "sum(map(range(2000), fn(i) { recv(done) }))");
+    REQUIRE(result->inspect() == "1999000");
+}
+
+TEST_CASE("Pipelines of tasks fan out and in", "[scheduler]") {
+    Isolate isolate;
+    const auto result = SchedulerTest::run(isolate,
+                                           "let results = chan();"
+                                           "let stage = fn(inbox, outbox, n) {"
+                                           "  if (n > 0) { send(outbox, recv(inbox) * 2); stage(inbox, outbox, n - 1) }"
+                                           "};"
+                                           "let pipeline = fn(i) {"
+                                           "  let a = chan(); let b = chan();"
+                                           "  spawn(stage, a, b, 2); spawn(stage, b, results, 2);"
+                                           "  send(a, i); send(a, i + 1)"
+                                           "};"
+                                           "each(range(500), pipeline);"
+                                           "sum(map(range(1000), fn(i) { recv(results) }))");
+    // each pipeline yields 4i and 4(i + 1)
+    REQUIRE(result->inspect() == "1000000");
+    REQUIRE(isolate.heap.size() > 0);
+}
+
+TEST_CASE("Task errors and deadlocks are reported to the receiver", "[scheduler]") {
+    Isolate isolate;
+    REQUIRE(SchedulerTest::errorMessage(SchedulerTest::run(isolate, "recv(chan())")) ==
+        "deadlock: no task is left to send on the channel");
+    REQUIRE(SchedulerTest::errorMessage(SchedulerTest::run(isolate,
+            "let c = chan(); spawn(fn() { send(c, 1 + true) }); recv(c)")) ==
+        "spawned task failed: unsupported types for binary operation: INTEGER BOOLEAN");
+    REQUIRE(SchedulerTest::errorMessage(SchedulerTest::run(isolate, "spawn(fn() { puts(1) })")) ==
+        "argument to `spawn` must be a pure function: calls impure builtin `puts`");
+    REQUIRE(SchedulerTest::errorMessage(SchedulerTest::run(isolate, "spawn(fn(x) { x })")) ==
+        "wrong number of arguments: want=1, got=0");
+    REQUIRE(SchedulerTest::errorMessage(SchedulerTest::run(isolate, "send(1, 2)")) ==
+        "argument to `send` must be CHANNEL, got INTEGER");
+
+    // a task left waiting forever does not keep the run from finishing
+    REQUIRE(SchedulerTest::run(isolate, "let c = chan(); spawn(fn() { recv(c) }); 7")->inspect() == "7");
+}
@@ -0,0 +1,137 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/object/heap.h"
+#include "../src/server/json.h"
+#include "../src/server/script_host.h"
+#include "../src/vm/flight_recorder.h"
+#include "fmt/format.h"
+
+TEST_CASE("Json round-trips Monkey values", "[server]") {
+    Heap heap;
+    Heap::Scope scope(&heap);
+    std::string error;
+
+    const auto value = Json::parse(R"( {"a": [1, -2, true, null], "b": "x\"y\né😀", "c": {}} )", error);
+    REQUIRE(error.empty());
+    const auto dumped = Json::dump(*value);
+    // hash order is unspecified, so check the parts
+    REQUIRE(dumped.find(R"("a":[1,-2,true,null])") != std::string::npos);
+    REQUIRE(dumped.find(R"("b":"x\"y\né😀")") != std::string::npos);
+    REQUIRE(dumped.find(R"("c":{})") != std::string::npos);
+
+    REQUIRE(Json::parse("[1, 2", error) == nullptr);
+    REQUIRE(error == "invalid JSON at offset 5: expected ',' or ']'");
+    REQUIRE(Json::parse("1.5", error) == nullptr);
+    REQUIRE(error == "invalid JSON at offset 0: only integer numbers are supported");
+    REQUIRE(Json::parse("[] x", error) == nullptr);
+    REQUIRE(error == "invalid JSON at offset 3: unexpected trailing characters");
+
+    REQUIRE(Json::dump(*make<IntArray>(std::vector<int64_t>{1, 2})) == "[1,2]");
+    REQUIRE(Json::quote("\x01") == R"("\u0001")");
+}
+
+TEST_CASE("ScriptHost answers requests against resident scripts", "[server]") {
+    ScriptHost host;
+    host.load("score", "let base = 10; fn(a, b) { {\"total\": a * b + base, \"tags\": [\"x\"]} }");
+
+    const auto response = host.handle(R"({"id": 7, "script": "score", "args": [3, 4]})");
+    REQUIRE((response == R"({"id":7,"result":{"total":22,"tags":["x"]}})" ||
+             response == R"({"id":7,"result":{"tags":["x"],"total":22}})"));
+
+    REQUIRE(host.handle(R"({"id": "a", "load": "inc", "source": "fn(x) { x + 1 }"})") ==
+        R"({"id":"a","result":null})");
+    REQUIRE(host.handle(R"({"id": 1, "script": "inc", "args": [41]})") == R"({"id":1,"result":42})");
+
+    REQUIRE(host.handle(R"({"id": 2, "script": "nope"})") == R"({"id":2,"error":"unknown script `nope`"})");
+    REQUIRE(host.handle(R"({"id": 3, "script": "inc", "args": []})") ==
+        R"({"id":3,"error":"wrong number of arguments: want=1, got=0"})");
+    REQUIRE(host.handle(R"({"id": 4, "script": "inc", "args": ["s"]})") ==
+        R"({"id":4,"error":"unsupported types for binary operation: STRING INTEGER"})");
+    REQUIRE(host.handle("{") == R"({"id":null,"error":"invalid JSON at offset 1: expected a string key"})");
+    REQUIRE_THROWS_WITH(host.load("bad", "1 + 1"), "script `bad` must evaluate to a function");
+}
+
+TEST_CASE("ScriptHost runs the script last loaded under a name", "[server]") {
+    ScriptHost host;
+    for (auto step = 1; step <= 3; step++) {
+        host.load("add", fmt::format("fn(x) {{ x + {:d} }}", step));
+        REQUIRE(host.handle(R"({"id": 1, "script": "add", "args": [10]})") ==
+            fmt::format(R"({{"id":1,"result":{:d}}})", 10 + step));
+    }
+}
+
+TEST_CASE("ScriptHosts keep their warm VMs apart", "[server]") {
+    auto first = std::make_unique<ScriptHost>();
+    ScriptHost second;
+    first->load("f", "fn(x) { x + 1 }");
+    second.load("f", "fn(x) { x * 10 }");
+    for (auto i = 0; i < 3; i++) {
+        REQUIRE(first->handle(R"({"id": 1, "script": "f", "args": [4]})") == R"({"id":1,"result":5})");
+        REQUIRE(second.handle(R"({"id": 2, "script": "f", "args": [4]})") == R"({"id":2,"result":40})");
+    }
+    // the first host's VMs and scripts go with it
+    first.reset();
+    REQUIRE(second.handle(R"({"id": 3, "script": "f", "args": [5]})") == R"({"id":3,"result":50})");
+}
+
+TEST_CASE("ScriptHost writes the flight recorder of a failed request", "[server]") {
+    const auto directory = std::filesystem::temp_directory_path() / "monkey_host_flights";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    ScriptHost host;
+    host.writeFlightsTo(directory.string());
+    host.load("neg", "let neg = fn(x) { -x }; neg");
+    REQUIRE(host.handle(R"({"id": 1, "script": "neg", "args": [2]})") == R"({"id":1,"result":-2})");
+    REQUIRE(std::filesystem::is_empty(directory));
+
+    REQUIRE(host.handle(R"({"id": 2, "script": "neg", "args": [true]})") ==
+        R"({"id":2,"error":"unsupported type for negation: BOOLEAN"})");
+    const std::filesystem::directory_iterator files(directory);
+    const auto file = files->path();
+    REQUIRE(file.filename().string().rfind("neg.", 0) == 0);
+    std::ifstream in(file, std::ios::binary);
+    const auto log = FlightLog::read(in);
+    in.close();
+    std::filesystem::remove_all(directory);
+    REQUIRE(log.entries.size() == 4);
+    REQUIRE(log.entries[2].name == "neg");
+    REQUIRE(log.entries[3].kind == FlightRecorder::Kind::Error);
+    REQUIRE(log.entries[3].name == "unsupported type for negation: BOOLEAN");
+}
+
+TEST_CASE("ScriptHost handles requests from many threads", "[server]") {
+    ScriptHost host;
+    host.load("fib", "let fib = fn(n) { if (n < 2) { n } else { fib(n - 1) + fib(n - 2) } }; fib");
+
+    std::vector<std::thread> threads;
+    std::vector<int> failures(8);
+    for (auto t = 0; t < 8; t++) {
+        threads.emplace_back([&, t] {
+            for (auto i = 0; i < 50; i++) {
+                const auto n = (t + i) % 15;
+                const auto response = host.handle(
+                    "{\"id\": " + std::to_string(i) + ", \"script\": \"fib\", \"args\": [" + std::to_string(n) + "]}");
+                int64_t a = 0, b = 1;
+                for (auto k = 0; k < n; k++) {
+                    b = a + b;
+                    a = b - a;
+                }
+                if (response != "{\"id\":" + std::to_string(i) + ",\"result\":" + std::to_string(a) + "}") {
+                    failures[t]++;
+                }
+            }
+        });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    REQUIRE(failures == std::vector<int>(8, 0));
+}
@@ -0,0 +1,128 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <filesystem>
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/engine/engine.h"
+#include "../src/lexer/lexer.h"
+#include "../src/object/native.h"
+#include "../src/parser/parser.h"
+#include "../src/vm/flight_recorder.h"
+#include "../src/vm/snapshot.h"
+#include "../src/vm/vm.h"
+
+namespace SnapshotTest {
+    std::string path(const std::string &name) {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    int64_t triple(const int64_t x) {
+        return x * 3;
+    }
+}
+
+TEST_CASE("Engine restores globals and closures from a snapshot", "[snapshot]") {
+    const auto file = SnapshotTest::path("monkey_engine.snapshot");
+    {
+        monkey::Engine engine;
+        engine.bind("triple", bindNative<&SnapshotTest::triple>());
+        engine.run(engine.compile(
+            "let table = map(range(1000), fn(x) { x * x });"
+            "let squares = [1, 4, 9];"
+            "let index = {\"a\": 1, \"b\": [1, 2], 3: \"three\"};"
+            "let adder = fn(k) { fn(x) { triple(x) + k + table[3] } };"
+            "let addFive = adder(5);"
+            "let rec = {\"name\": \"r\", \"n\": 2};"));
+        engine.save(file);
+    }
+
+    monkey::Engine restored;
+    restored.restore(file);
+    restored.bind("triple", bindNative<&SnapshotTest::triple>());
+    const auto result = restored.run(restored.compile(
+        "addFive(1) + table[999] + index[\"b\"][1] + rec[\"n\"] + squares[2] + len(index[3]) + len(rec[\"name\"])"));
+    // 3 + 5 + 9, 998001, 2, 2, 9, 5, 1
+    REQUIRE(result->inspect() == "998037");
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("A VM restored from a snapshot does not rerun its program", "[snapshot]") {
+    const auto file = SnapshotTest::path("monkey_vm.snapshot");
+    auto parser = Parser(Lexer("let total = sum(range(10)); let scale = fn(x) { x * total }; scale"));
+    auto program = parser.parseProgram();
+    auto compiler = Compiler();
+    compiler.compile(program.get());
+    auto original = VM(compiler.byteCode());
+    original.run();
+    Snapshot::save(file, original);
+
+    const auto image = Snapshot::load(file);
+    REQUIRE(image.code->instructions.empty());
+    auto vm = VM(image.code, image.globals);
+    vm.run();
+    const auto scale = dynamic_cast<Closure *>((*image.globals)[1]);
+    REQUIRE(scale != nullptr);
+    REQUIRE(vm.invoke(scale, std::vector<Object *>{new Integer(2)})->inspect() == "90");
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Snapshots reject what cannot be saved", "[snapshot]") {
+    const auto file = SnapshotTest::path("monkey_bad.snapshot");
+    monkey::Engine engine;
+    engine.run(engine.compile("let c = chan();"));
+    REQUIRE_THROWS_WITH(engine.save(file), "cannot snapshot a value of type CHANNEL");
+
+    {
+        std::ofstream junk(file);
+        junk << "not a snapshot";
+    }
+    monkey::Engine other;
+    REQUIRE_THROWS_WITH(other.restore(file), file + " is not a snapshot");
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Snapshots with counts beyond their size are corrupt", "[snapshot]") {
+    const auto file = SnapshotTest::path("monkey_counts.snapshot");
+    const auto write = [&](const std::vector<uint32_t> &counts) {
+        std::ofstream out(file, std::ios::binary);
+        out << "MKSNAP04";
+        for (const auto count: counts) {
+            out.write(reinterpret_cast<const char *>(&count), sizeof(count));
+        }
+    };
+    monkey::Engine engine;
+
+    // a huge object count, then no objects but a huge constant count
+    write({0xFFFFFFFF});
+    REQUIRE_THROWS_WITH(engine.restore(file), "corrupt snapshot: truncated");
+    write({0, 0xFFFFFFFF});
+    REQUIRE_THROWS_WITH(engine.restore(file), "corrupt snapshot: truncated");
+    std::filesystem::remove(file);
+}
+
+TEST_CASE("Restored closures are named in flight recordings", "[snapshot]") {
+    const auto file = SnapshotTest::path("monkey_flight.snapshot");
+    const auto flight = SnapshotTest::path("monkey_engine.flight");
+    {
+        monkey::Engine engine;
+        engine.run(engine.compile("let k = 1; let neg = fn(x) { -x + k };"));
+        engine.save(file);
+    }
+    monkey::Engine restored;
+    restored.restore(file);
+    restored.writeFlightOnError(flight);
+    const std::vector<Object *> args{new String("s")};
+    REQUIRE_THROWS_WITH(restored.call(*restored.global("neg"), args), "unsupported type for negation: STRING");
+
+    std::ifstream in(flight, std::ios::binary);
+    const auto log = FlightLog::read(in);
+    in.close();
+    std::filesystem::remove(file);
+    std::filesystem::remove(flight);
+    REQUIRE(log.entries.size() == 2);
+    REQUIRE(log.entries[0].name == "neg");
+    REQUIRE(log.entries[1].name == "unsupported type for negation: STRING");
+}
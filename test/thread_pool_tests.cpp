@@ -0,0 +1,40 @@
+//
+// Created by mizuk on 2026/10/18.
+//
+
+#include <atomic>
+#include <stdexcept>
+#include <catch2/catch_test_macros.hpp>
+
+#include "../src/runtime/thread_pool.h"
+
+TEST_CASE("ThreadPool parallelFor runs every index once", "[runtime]") {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int> > hits(1000);
+    pool.parallelFor(hits.size(), [&](const size_t i) { hits[i]++; });
+    for (const auto &hit: hits) {
+        REQUIRE(hit.load() == 1);
+    }
+}
+
+TEST_CASE("ThreadPool parallelFor nests inside pool tasks", "[runtime]") {
+    // a single worker would deadlock here unless waiting callers help run queued tasks
+    ThreadPool pool(1);
+    std::atomic<int> total{0};
+    pool.parallelFor(8, [&](size_t) {
+        pool.parallelFor(8, [&](const size_t j) { total += static_cast<int>(j); });
+    });
+    REQUIRE(total.load() == 8 * 28);
+}
+
+TEST_CASE("ThreadPool parallelFor rethrows after all tasks finish", "[runtime]") {
+    ThreadPool pool(3);
+    std::atomic<int> finished{0};
+    REQUIRE_THROWS_WITH(pool.parallelFor(16, [&](const size_t i) {
+        if (i == 5) {
+            throw std::runtime_error("boom");
+        }
+        finished++;
+    }), "boom");
+    REQUIRE(finished.load() == 15);
+}
@@ -1,11 +1,19 @@
 #include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
 #include <variant>
+#include <sstream>
 #include <string>
+#include <tuple>
 #include <vector>
 #include <unordered_map>
 
 #include "common_suite.h"
 #include "../cmake-build-debug-mingw/_deps/fmt-src/include/fmt/printf.h"
+#include "../src/object/alloc_stats.h"
+#include "../src/vm/flight_recorder.h"
+#include "../src/vm/op_profile.h"
+#include "../src/vm/sampler.h"
 #include "../src/vm/vm.h"
 #include "../src/lexer/lexer.h"
 #include "../src/parser/parser.h"
@@ -94,6 +102,10 @@ namespace VmTest {
                            REQUIRE(err.empty());
                        },
                        [&](const std::vector<int> &exp) {
+                           if (auto ints = dynamic_cast<IntArray *>(actual)) {
+                               REQUIRE(ints->values == std::vector<int64_t>(exp.begin(), exp.end()));
+                               return;
+                           }
                            auto array = dynamic_cast<Array *>(actual);
                            REQUIRE(array != nullptr);
                            REQUIRE(array->elements.size() == exp.size());
@@ -106,11 +118,11 @@ namespace VmTest {
                        [&](const std::unordered_map<HashKey, int64_t> &exp) {
                            auto hash = dynamic_cast<Hash *>(actual);
                            REQUIRE(hash != nullptr);
-                           REQUIRE(hash->pairs.size() == exp.size());
+                           REQUIRE(hash->pairs().size() == exp.size());
 
                            for (const auto &[key, value]: exp) {
-                               auto it = hash->pairs.find(key);
-                               REQUIRE(it != hash->pairs.end());
+                               auto it = hash->pairs().find(key);
+                               REQUIRE(it != hash->pairs().end());
                                auto err = testIntegerObject(value, it->second.value);
                                REQUIRE(err.empty());
                            }
@@ -298,6 +310,109 @@ namespace VmTest {
         runVmTests(tests);
     }
 
+    TEST_CASE("TestRecordFieldAccess") {
+        std::vector<VMTestCase> tests = {
+            {R"({"title": 1, "author": 2}["title"])", {1}},
+            {R"({"title": 1, "author": 2}["author"])", {2}},
+            {R"({"title": 1}["isbn"])", {VM::Null}},
+            {R"({1: 1}["title"])", {VM::Null}},
+            {R"(let key = "title"; {"title": 5}[key])", {5}},
+            {R"({"a": 1, "b": 2}["b"] + {"a": 3, "b": 4}["b"])", {6}},
+            {R"(set({"a": 1, "b": 2}, "b", 5)["b"])", {5}},
+            {R"(set({"a": 1}, "c", 5)["c"])", {5}},
+            {R"(delete({"a": 1, "b": 2}, "a")["b"])", {2}},
+            {R"(delete({"a": 1, "b": 2}, "a")["a"])", {VM::Null}},
+            {R"([1]["a"])", {new Error("index operator not supported: ARRAY")}},
+            {
+                // one site sees two shapes, then the first again
+                R"(
+                let title = fn(book) { book["title"] };
+                title({"title": 1}) + title({"author": 0, "title": 2}) + title({"title": 3})
+                )",
+                {6}
+            },
+        };
+
+        for (const auto &tt: tests) {
+            auto program = parse(tt.input);
+            auto comp = Compiler();
+            comp.compile(program.get());
+
+            auto vm = VM(comp.byteCode());
+            if (const auto expectedError = std::get_if<Object *>(&tt.expected.value);
+                expectedError != nullptr && dynamic_cast<Error *>(*expectedError) != nullptr) {
+                REQUIRE_THROWS_WITH(vm.run(), dynamic_cast<Error *>(*expectedError)->message);
+                continue;
+            }
+            vm.run();
+            testExpectedObject(tt.expected, vm.lastPoppedStackElem());
+        }
+    }
+
+    TEST_CASE("TestRecordsShareShapes") {
+        auto program = parse(R"(let a = {"x": 1, "y": 2}; let b = {"y": 3, "x": 4}; [a, b])");
+        auto comp = Compiler();
+        comp.compile(program.get());
+        auto vm = VM(comp.byteCode());
+        vm.run();
+
+        auto records = dynamic_cast<Array *>(vm.lastPoppedStackElem());
+        REQUIRE(records != nullptr);
+        auto a = dynamic_cast<Hash *>(records->elements[0]);
+        auto b = dynamic_cast<Hash *>(records->elements[1]);
+        REQUIRE(a->shape != nullptr);
+        REQUIRE(a->shape == b->shape);
+        REQUIRE(a->pairs().size() == 2);
+        REQUIRE(testIntegerObject(4, b->pairs().get(String("x").hash_key())->value).empty());
+    }
+
+    TEST_CASE("TestTopLevelLines") {
+        auto program = parse("let a = 1;\n\nlet b = a + 1;");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        const auto vm = VM(compiler.byteCode());
+        REQUIRE(!vm.lines().empty());
+        REQUIRE(vm.lines().entries() == compiler.byteCode().lines.entries());
+        REQUIRE(vm.lines().lineAt(0) == 1);
+
+        // the REPL hands each line's table to its VM along with the instructions
+        const auto globals = std::make_shared<std::vector<Object *> >(__globals__size);
+        auto repl = VM(std::make_shared<const std::vector<Object *> >(compiler.constants), globals);
+        REQUIRE(repl.lines().empty());
+        auto main = compiler.takeInstructions();
+        REQUIRE(main.lines.entries() == vm.lines().entries());
+        repl.load(std::move(main));
+        REQUIRE(repl.lines().lineAt(0) == 1);
+        REQUIRE(repl.lines().entries().back().second == 3);
+        repl.run();
+        REQUIRE(testIntegerObject(2, (*globals)[1]).empty());
+    }
+
+    TEST_CASE("TestRecordsBuildPairsWhenAsked") {
+        auto program = parse(R"(let r = {"x": 1, "y": 2}; let k = "y"; let s = set(r, "x", 5); [r[k], r["z"], s["x"], s])");
+        auto comp = Compiler();
+        comp.compile(program.get());
+        auto vm = VM(comp.byteCode());
+        AllocStats stats;
+        {
+            AllocStats::Scope scope(&stats);
+            vm.run();
+        }
+        // field loads by string and overwriting a field go through the slots alone
+        REQUIRE(stats.byKind().count("HASH_PAIR") == 0);
+
+        auto results = dynamic_cast<Array *>(vm.lastPoppedStackElem());
+        REQUIRE(results != nullptr);
+        REQUIRE(testIntegerObject(2, results->elements[0]).empty());
+        REQUIRE(results->elements[1] == VM::Null);
+        REQUIRE(testIntegerObject(5, results->elements[2]).empty());
+        auto s = dynamic_cast<Hash *>(results->elements[3]);
+        REQUIRE(s->shape != nullptr);
+        REQUIRE(s->pairs().size() == 2);
+        REQUIRE(testIntegerObject(5, s->pairs().get(String("x").hash_key())->value).empty());
+        REQUIRE(testIntegerObject(2, s->pairs().get(String("y").hash_key())->value).empty());
+    }
+
     TEST_CASE("TestCallingFunctionsWithoutArguments") {
         std::vector<VMTestCase> tests = {
             {"let fivePlusTen = fn() { 5 + 10; }; fivePlusTen();", {15}},
@@ -497,11 +612,111 @@ namespace VmTest {
             {"rest([])", {VM::Null}},
             {"push([], 1)", {std::vector<int>{1}}},
             {"push(1, 1)", {new Error("argument to `push` must be ARRAY, got INTEGER")}},
+            {"set({}, 1, 2)[1]", {2}},
+            {"set({1: 1}, 1, 2)[1]", {2}},
+            {"let h = {1: 1}; let g = set(h, 2, 2); h[2]", {VM::Null}},
+            {"len(delete({1: 1}, 1))", {new Error("argument to `len` not supported, got HASH")}},
+            {"delete({1: 1, 2: 2}, 1)[2]", {2}},
+            {"delete({1: 1, 2: 2}, 1)[1]", {VM::Null}},
+            {"push([1, 2], 3)", {std::vector<int>{1, 2, 3}}},
+            {"len(push([1, 2], \"x\"))", {3}},
+            {"range(4)", {std::vector<int>{0, 1, 2, 3}}},
+            {"range(2, 5)", {std::vector<int>{2, 3, 4}}},
+            {"range(5, 2)", {std::vector<int>{}}},
+            {"range(\"a\")", {new Error("argument to `range` must be INTEGER, got STRING")}},
+            {"sum(range(101))", {5050}},
+            {"sum([1, 2 + 3, 4])", {10}},
+            {"sum([])", {0}},
+            {"sum([1, \"a\"])", {new Error("argument to `sum` must be ARRAY of INTEGER, got ARRAY")}},
+            {"min([5, 3, 9, -1, 7])", {-1}},
+            {"max([5, 3, 9, -1, 7])", {9}},
+            {"min([])", {VM::Null}},
+            {"dot([1, 2, 3], [4, 5, 6])", {32}},
+            {"dot([1, 2], [1])", {new Error("arguments to `dot` must have the same length, got 2 and 1")}},
+            {"add([1, 2, 3], [10, 20, 30])", {std::vector<int>{11, 22, 33}}},
+            {"mul(range(5), range(5))[4]", {16}},
+            {"set(1, 1, 1)", {new Error("argument to `set` must be HASH, got INTEGER")}},
+            {"delete({}, [])", {new Error("unusable as hash key: ARRAY")}},
         };
 
         runVmTests(tests);
     }
 
+    TEST_CASE("TestHigherOrderBuiltins") {
+        std::vector<VMTestCase> tests = {
+            {"map([1, 2, 3], fn(x) { x * 2 })", {std::vector<int>{2, 4, 6}}},
+            {"map([], fn(x) { x })", {std::vector<int>{}}},
+            {"map(range(4), fn(x) { x * x })", {std::vector<int>{0, 1, 4, 9}}},
+            {"filter(range(10), fn(x) { x > 6 })", {std::vector<int>{7, 8, 9}}},
+            {"reduce([1, 2, 3, 4], 0, fn(acc, x) { acc + x })", {10}},
+            {"reduce([], 42, fn(acc, x) { acc + x })", {42}},
+            {"find([1, 5, 9], fn(x) { x > 3 })", {5}},
+            {"find([1, 2], fn(x) { x > 3 })", {VM::Null}},
+            {"let total = fn(xs) { let n = len(xs); each(xs, fn(x) { x }); n }; total([1, 2, 3])", {3}},
+            // callbacks capture free variables and call other functions
+            {"let k = 10; let addK = fn(x) { x + k }; map([1, 2], fn(x) { addK(x) })", {std::vector<int>{11, 12}}},
+            // builtins as callbacks, and nested re-entrant calls
+            {"map([[1], [1, 2]], len)", {std::vector<int>{1, 2}}},
+            {"map([1, 2], fn(x) { sum(map(range(x + 1), fn(y) { y * 10 })) })", {std::vector<int>{10, 30}}},
+            {"let f = fn() { map([1, 2, 3], fn(x) { x + 1 }) }; let a = f(); a[2] + len(a)", {7}},
+            {"map([1, 2], fn(x) { first(x) })", {new Error("argument to `first` must be ARRAY, got INTEGER")}},
+            {"map(1, fn(x) { x })", {new Error("argument to `map` must be ARRAY, got INTEGER")}},
+            {"filter([1], 1)", {new Error("argument to `filter` must be FUNCTION, got INTEGER")}},
+        };
+
+        runVmTests(tests);
+    }
+
+    TEST_CASE("TestParallelMap") {
+        std::vector<VMTestCase> tests = {
+            {"pmap([1, 2, 3], fn(x) { x * 2 })", {std::vector<int>{2, 4, 6}}},
+            {"pmap([], fn(x) { x })", {std::vector<int>{}}},
+            {"sum(pmap(range(1000), fn(x) { x * x }))", {332833500}},
+            {
+                "let fib = fn(n) { if (n < 2) { n } else { fib(n - 1) + fib(n - 2) } };"
+                "pmap([10, 11, 12, 13, 14, 15, 16, 17], fib)",
+                {std::vector<int>{55, 89, 144, 233, 377, 610, 987, 1597}}
+            },
+            {"let k = 3; pmap(range(4), fn(x) { x + k })", {std::vector<int>{3, 4, 5, 6}}},
+            {"pmap(range(3), fn(x) { sum(pmap(range(x + 1), fn(y) { y })) })", {std::vector<int>{0, 1, 3}}},
+            {"pmap([1, [2]], fn(x) { len(x) })", {new Error("argument to `len` not supported, got INTEGER")}},
+            {
+                "pmap([1], fn(x) { puts(x) })",
+                {new Error("argument to `pmap` must be a pure function: calls impure builtin `puts`")}
+            },
+            {
+                "pmap([], fn(x) { puts(x) })",
+                {new Error("argument to `pmap` must be a pure function: calls impure builtin `puts`")}
+            },
+            {
+                "let log = fn(x) { puts(x); x }; pmap([1], fn(x) { log(x) })",
+                {new Error("argument to `pmap` must be a pure function: calls impure builtin `puts`")}
+            },
+            {
+                "let wrap = fn(f) { fn(x) { f(x) } }; pmap([1], wrap(puts))",
+                {new Error("argument to `pmap` must be a pure function: calls impure builtin `puts`")}
+            },
+        };
+
+        runVmTests(tests);
+    }
+
+    TEST_CASE("TestParallelMapPropagatesRuntimeErrors") {
+        auto program = parse("pmap(range(100), fn(x) { if (x == 57) { x + true } else { x } })");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        REQUIRE_THROWS_WITH(vm.run(), "unsupported types for binary operation: INTEGER BOOLEAN");
+    }
+
+    TEST_CASE("TestHigherOrderBuiltinsPropagateRuntimeErrors") {
+        auto program = parse("map([1, 2], fn(x) { x + true })");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        REQUIRE_THROWS_WITH(vm.run(), "unsupported types for binary operation: INTEGER BOOLEAN");
+    }
+
     TEST_CASE("TestClosures") {
         std::vector<VMTestCase> tests = {
             {
@@ -590,4 +805,284 @@ namespace VmTest {
 
         runVmTests(tests);
     }
+
+    TEST_CASE("TestInvokeClosureFromNative") {
+        auto program = parse(
+            "let base = 100;"
+            "let add = fn(a, b) { a + b + base };"
+            "let twice = fn(f, x) { f(f(x)) };"
+            "let bad = fn(x) { map([x], fn(y) { y + true }) };"
+            "[add, twice, bad]");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        vm.run();
+
+        const auto fns = dynamic_cast<Array *>(vm.lastPoppedStackElem());
+        REQUIRE(fns != nullptr);
+        const auto add = dynamic_cast<Closure *>(fns->elements[0]);
+        const auto twice = dynamic_cast<Closure *>(fns->elements[1]);
+        const auto bad = dynamic_cast<Closure *>(fns->elements[2]);
+
+        auto result = vm.invoke(add, std::vector<Object *>{new Integer(1), new Integer(2)});
+        REQUIRE(dynamic_cast<Integer *>(result)->value == 103);
+
+        // closures can take and call host-provided functions
+        const std::vector<Object *> restOfList{
+            getBuiltinByName("rest"), new Array({new Integer(1), new Integer(2), new Integer(3)})
+        };
+        auto mapped = vm.invoke(twice, restOfList);
+        REQUIRE(mapped->inspect() == "[3]");
+
+        // failures unwind cleanly: without restoring the stack, these would overflow it
+        for (auto i = 0; i < 3000; i++) {
+            REQUIRE_THROWS_WITH(vm.invoke(bad, std::vector<Object *>{new Integer(i)}),
+                                "unsupported types for binary operation: INTEGER BOOLEAN");
+            REQUIRE_THROWS_WITH(vm.invoke(add, std::vector<Object *>{new Integer(i)}),
+                                "wrong number of arguments: want=2, got=1");
+        }
+        result = vm.invoke(add, std::vector<Object *>{new Integer(5), new Integer(5)});
+        REQUIRE(dynamic_cast<Integer *>(result)->value == 110);
+    }
+
+    TEST_CASE("TestInvokeBatch") {
+        auto program = parse(
+            "let weight = 3;"
+            "let score = fn(a, b) { let s = a * weight; if (s > b) { s - b } else { 0 } };"
+            "let answer = fn() { 42 };"
+            "[score, answer]");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        vm.run();
+
+        const auto fns = dynamic_cast<Array *>(vm.lastPoppedStackElem());
+        const auto score = dynamic_cast<Closure *>(fns->elements[0]);
+        const auto answer = dynamic_cast<Closure *>(fns->elements[1]);
+
+        std::vector<Object *> rows, as, bs;
+        for (auto i = 0; i < 1000; i++) {
+            as.push_back(new Integer(i));
+            bs.push_back(new Integer(1000 - i));
+            rows.push_back(as.back());
+            rows.push_back(bs.back());
+        }
+        std::vector<Object *> byRow(1000), byColumn(1000);
+        vm.invokeRows(score, rows, byRow.data());
+        vm.invokeColumns(score, {as, bs}, byColumn.data());
+        for (auto i = 0; i < 1000; i++) {
+            const auto want = i * 3 > 1000 - i ? i * 3 - (1000 - i) : 0;
+            REQUIRE(dynamic_cast<Integer *>(byRow[i])->value == want);
+            REQUIRE(dynamic_cast<Integer *>(byColumn[i])->value == want);
+        }
+
+        std::vector<Object *> none;
+        vm.invokeRows(answer, {}, none.data());
+        std::vector<Object *> answers(3);
+        vm.invokeRows(answer, {}, answers.data(), answers.size());
+        vm.invokeColumns(answer, {}, byColumn.data(), 2);
+        for (const auto result: answers) {
+            REQUIRE(dynamic_cast<Integer *>(result)->value == 42);
+        }
+        REQUIRE(dynamic_cast<Integer *>(byColumn[1])->value == 42);
+
+        const std::vector<Object *> odd{new Integer(1)};
+        REQUIRE_THROWS_WITH(vm.invokeRows(score, odd, byRow.data()),
+                            "wrong number of arguments: want a multiple of 2, got=1");
+        REQUIRE_THROWS_WITH(vm.invokeColumns(score, {as}, byRow.data()), "wrong number of arguments: want=2, got=1");
+        REQUIRE_THROWS_WITH(vm.invokeColumns(score, {as, odd}, byRow.data()), "columns must all have the same length");
+        // a failing row leaves the VM usable
+        const std::vector<Object *> bad{new Integer(1), new Boolean(true)};
+        REQUIRE_THROWS_WITH(vm.invokeRows(score, bad, byRow.data()), "unknown operator: 10 (INTEGER BOOLEAN)");
+        const std::vector<Object *> args{new Integer(10), new Integer(1)};
+        REQUIRE(dynamic_cast<Integer *>(vm.invoke(score, args))->value == 29);
+    }
+
+    TEST_CASE("TestExecutionBudgets") {
+        const auto run = [](const std::string &input, const Budget &budget) {
+            auto program = parse(input);
+            auto compiler = Compiler();
+            compiler.compile(program.get());
+            auto vm = VM(compiler.byteCode());
+            vm.run(budget);
+            return vm.lastPoppedStackElem()->inspect();
+        };
+        const auto limitOf = [&](const std::string &input, const Budget &budget) {
+            try {
+                run(input, budget);
+            } catch (const BudgetExceeded &e) {
+                return e.limit;
+            }
+            FAIL("budget was not exceeded");
+            return BudgetExceeded::Limit::Instructions;
+        };
+        const std::string fib = "let fib = fn(x) { if (x < 2) { x } else { fib(x - 1) + fib(x - 2) } };";
+        const std::string grow = "let grow = fn(n, s) { if (n == 0) { len(s) } else { grow(n - 1, s + \"abcdefgh\") } };";
+
+        REQUIRE(run(fib + "fib(15)", Budget{100000}) == "610");
+        REQUIRE(limitOf(fib + "fib(25)", Budget{10000}) == BudgetExceeded::Limit::Instructions);
+        REQUIRE(limitOf(fib + "fib(40)", Budget{0, 0, std::chrono::milliseconds(20)}) == BudgetExceeded::Limit::Time);
+        REQUIRE(run(grow + "grow(100, \"\")", Budget{0, 1 << 20}) == "800");
+        REQUIRE(limitOf(grow + "grow(500, \"\")", Budget{0, 4096}) == BudgetExceeded::Limit::Heap);
+
+        // a VM that ran out of budget can run again
+        auto program = parse(fib + "fib(20)");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        REQUIRE_THROWS_WITH(vm.run(Budget{5000}), "instruction budget of 5000 exhausted");
+        REQUIRE_THROWS_WITH(vm.run(Budget{0, 64}), "heap quota exceeded");
+        vm.run(Budget{10000000});
+        REQUIRE(vm.lastPoppedStackElem()->inspect() == "6765");
+    }
+
+    TEST_CASE("TestProfileOps") {
+        auto program = parse("let f = fn(x) { x * 2 }; f(1) + f(2)");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        OpProfile profile;
+        vm.profileOps(&profile);
+        vm.run();
+        REQUIRE(vm.lastPoppedStackElem()->inspect() == "6");
+
+        REQUIRE(profile.count(OpCode::OpCall) == 2);
+        REQUIRE(profile.count(OpCode::OpMul) == 2);
+        REQUIRE(profile.count(OpCode::OpAdd) == 1);
+        REQUIRE(profile.count(OpCode::OpJump) == 0);
+        REQUIRE(profile.pairCount(OpCode::OpGetLocal, OpCode::OpConstant) == 2);
+        REQUIRE(profile.pairCount(OpCode::OpMul, OpCode::OpReturnValue) == 2);
+        // the sampled instructions are counted apart from the time they took, in `unit`
+        const auto json = profile.toJson();
+        const auto mul = fmt::format(R"("OpMul":{{"count":2,"samples":{:d},"elapsed":)",
+                                     profile.samples(OpCode::OpMul));
+        REQUIRE(json.find(mul) != std::string::npos);
+        REQUIRE(json.find(R"("sampled")") == std::string::npos);
+
+        // one instruction in samplePeriod is timed, so the samples add up to the instructions run over it
+        auto fib = parse("let fib = fn(x) { if (x < 2) { x } else { fib(x - 1) + fib(x - 2) } }; fib(12)");
+        auto fibCompiler = Compiler();
+        fibCompiler.compile(fib.get());
+        auto fibVm = VM(fibCompiler.byteCode());
+        OpProfile fibProfile;
+        fibVm.profileOps(&fibProfile);
+        fibVm.run();
+        uint64_t executed = 0, sampled = 0;
+        for (auto op = 0; op < OpProfile::numOps; op++) {
+            executed += fibProfile.count(static_cast<OpCode>(op));
+            sampled += fibProfile.samples(static_cast<OpCode>(op));
+        }
+        REQUIRE(sampled == executed / OpProfile::samplePeriod);
+        REQUIRE(fibProfile.samples(OpCode::OpCall) > 0);
+        const auto call = fmt::format(R"("OpCall":{{"count":{:d},"samples":{:d},"elapsed":)",
+                                      fibProfile.count(OpCode::OpCall), fibProfile.samples(OpCode::OpCall));
+        REQUIRE(fibProfile.toJson().find(call) != std::string::npos);
+    }
+
+    TEST_CASE("TestAllocStats") {
+        auto program = parse("let f = fn(x) { x * 2 }; let r = map([1, 2, 3], f); {\"a\": r}");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        AllocStats stats;
+        {
+            AllocStats::Scope scope(&stats);
+            vm.run();
+        }
+        REQUIRE(vm.lastPoppedStackElem()->inspect() == "{a: [2, 4, 6]}");
+
+        const auto pairs = stats.bySiteAndKind();
+        REQUIRE(pairs.at({"OpMul", INTEGER_OBJ}).objects == 3);
+        REQUIRE(pairs.at({"map", ARRAY_OBJ}).objects == 1);
+        REQUIRE(pairs.at({"OpRecord", HASH_OBJ}).objects == 1);
+        // the record builds its pairs only when printed, outside the scope
+        REQUIRE(pairs.count({"OpRecord", "HASH_PAIR"}) == 0);
+        REQUIRE(pairs.at({"OpMul", INTEGER_OBJ}).bytes == 3 * sizeof(Integer));
+        REQUIRE(stats.byKind().at(INTEGER_OBJ).objects >= 3);
+        REQUIRE(stats.total().objects > 5);
+
+        // nothing is counted once the scope has ended
+        const auto total = stats.total().objects;
+        vm.run();
+        REQUIRE(stats.total().objects == total);
+    }
+
+#ifndef MONKEY_NO_FLIGHT_RECORDER
+    TEST_CASE("TestFlightRecorder") {
+        auto program = parse("let ok = fn() { 1 }; let inner = fn(x) { len([x]); ok(); -true }; "
+                             "let outer = fn() { inner(1) }; outer()");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        const auto file = (std::filesystem::temp_directory_path() / "monkey_vm.flight").string();
+        vm.writeFlightOnError(file);
+        REQUIRE_THROWS_WITH(vm.run(), "unsupported type for negation: BOOLEAN");
+
+        std::ifstream in(file, std::ios::binary);
+        const auto log = FlightLog::read(in);
+        in.close();
+        std::filesystem::remove(file);
+        REQUIRE(log.lost == 0);
+        std::vector<std::tuple<std::string, uint32_t, std::string> > events;
+        for (const auto &entry: log.entries) {
+            events.emplace_back(FlightLog::kindName(entry.kind), entry.depth, entry.name);
+        }
+        REQUIRE(events == std::vector<std::tuple<std::string, uint32_t, std::string> >{
+                    {"enter", 2, "outer"}, {"enter", 3, "inner"}, {"builtin", 3, "len"}, {"enter", 4, "ok"},
+                    {"exit", 4, "ok"}, {"error", 3, "unsupported type for negation: BOOLEAN"},
+                });
+        for (size_t i = 1; i < log.entries.size(); i++) {
+            REQUIRE(log.entries[i].nanoseconds >= log.entries[i - 1].nanoseconds);
+        }
+
+        // the ring keeps the last events only, and the rewound VM records on
+        vm.writeFlightOnError("");
+        for (auto i = 0; i < 1000; i++) {
+            REQUIRE_THROWS(vm.run());
+        }
+        std::stringstream out;
+        vm.writeFlight(out);
+        const auto last = FlightLog::read(out);
+        REQUIRE(last.lost + last.entries.size() == 6 * 1001);
+        REQUIRE(last.entries.size() == 2048);
+        REQUIRE(FlightLog::kindName(last.entries.back().kind) == std::string("error"));
+
+        std::istringstream bad("MKSNAP03");
+        REQUIRE_THROWS_WITH(FlightLog::read(bad), "not a flight recording");
+    }
+#endif
+
+#ifndef _WIN32
+    TEST_CASE("TestSampler") {
+        auto program = parse("let fib = fn(x) { if (x < 2) { x } else { fib(x - 1) + fib(x - 2) } }; "
+                             "let run = fn() { fib(22) }; run()");
+        auto compiler = Compiler();
+        compiler.compile(program.get());
+        auto vm = VM(compiler.byteCode());
+        Sampler sampler(std::chrono::microseconds(200));
+        sampler.start(vm);
+        REQUIRE_THROWS_WITH(Sampler().start(vm), "another sampler is already running");
+        vm.run();
+        sampler.stop();
+        REQUIRE(vm.lastPoppedStackElem()->inspect() == "17711");
+
+        std::ostringstream out;
+        sampler.writeFolded(out);
+        REQUIRE(sampler.samples() > 0);
+        REQUIRE(out.str().find("main;run;fib;fib;fib") != std::string::npos);
+
+        // a sampler left running past its VM only turns its timer off, and another can start after it
+        {
+            auto failing = std::make_unique<Sampler>();
+            {
+                auto other = VM(compiler.byteCode());
+                failing->start(other);
+            }
+            failing.reset();
+        }
+        Sampler next;
+        next.start(vm);
+        next.stop();
+    }
+#endif
 }